@@ -0,0 +1,93 @@
+#include "Attendance.h"
+
+static byte present[ATTENDANCE_BYTES];  // signed in right now
+static byte session;
+static unsigned long sessionStart;
+
+static inline bool testBit(const byte *bits, RosterIndex index) {
+  return bits[index >> 3] & (1 << (index & 7));
+}
+
+static inline void setBit(byte *bits, RosterIndex index) {
+  bits[index >> 3] |= 1 << (index & 7);
+}
+
+#if ATTENDANCE_REENTRY_MINUTES
+#if (ATTENDANCE_REENTRY_MINUTES * 60000UL) % ATTENDANCE_REENTRY_STEPS
+#error "ATTENDANCE_REENTRY_STEPS must divide the re-entry window in milliseconds"
+#endif
+#define EPOCH_MS (ATTENDANCE_REENTRY_MINUTES * 60000UL / ATTENDANCE_REENTRY_STEPS)
+#define EPOCH_COUNT (ATTENDANCE_REENTRY_STEPS + 1)
+#if (EPOCH_COUNT + 1) * ATTENDANCE_BYTES > ATTENDANCE_RAM_BUDGET
+#error "The re-entry bitsets exceed ATTENDANCE_RAM_BUDGET, lower ATTENDANCE_REENTRY_STEPS"
+#endif
+
+static byte recent[EPOCH_COUNT][ATTENDANCE_BYTES];  // scanned in the current and the previous epochs
+static byte epoch;                                  // which of recent[] is the current epoch
+static unsigned long epochStart;
+
+/**
+ * Moves the re-entry window forward to now, forgetting the epochs that have left it.
+ */
+static void updateEpochs(unsigned long now) {
+  unsigned long elapsed = now - epochStart;
+  if (elapsed < EPOCH_MS) {
+    return;
+  }
+  unsigned long steps = elapsed / EPOCH_MS;
+  if (steps >= EPOCH_COUNT) {
+    memset(recent, 0, sizeof(recent));
+  }
+  else {
+    for (byte step = 0; step < steps; step++) {
+      epoch = (epoch + 1) % EPOCH_COUNT;
+      memset(recent[epoch], 0, ATTENDANCE_BYTES);
+    }
+  }
+  epochStart = now - elapsed % EPOCH_MS;
+}
+
+/**
+ * True if the student scanned in one of the epochs of the window.
+ */
+static bool scannedRecently(RosterIndex index) {
+  for (byte slot = 0; slot < EPOCH_COUNT; slot++) {
+    if (testBit(recent[slot], index)) {
+      return true;
+    }
+  }
+  return false;
+}
+#endif
+
+void attendanceBeginSession() {
+  memset(present, 0, sizeof(present));
+#if ATTENDANCE_REENTRY_MINUTES
+  memset(recent, 0, sizeof(recent));
+  epochStart = millis();
+#endif
+  sessionStart = millis();
+  session++;
+}
+
+AttendanceResult attendanceMark(RosterIndex index) {
+  unsigned long now = millis();
+  if (session == 0 || (SESSION_LENGTH_MINUTES && now - sessionStart >= SESSION_LENGTH_MINUTES * 60000UL)) {
+    attendanceBeginSession();
+  }
+#if ATTENDANCE_REENTRY_MINUTES
+  updateEpochs(now);
+  if (scannedRecently(index)) {
+    return ATTENDANCE_ALREADY;
+  }
+  setBit(recent[epoch], index);
+  present[index >> 3] ^= 1 << (index & 7);
+  return testBit(present, index) ? ATTENDANCE_IN : ATTENDANCE_OUT;
+#else
+  if (testBit(present, index)) {
+    return ATTENDANCE_ALREADY;
+  }
+  setBit(present, index);
+  return ATTENDANCE_IN;
+#endif
+}
@@ -0,0 +1,55 @@
+/**
+ * Who has signed in during the current session.
+ *
+ * One bit per roster index: 250 bytes of RAM for 2000 students. A session ends after
+ * SESSION_LENGTH_MINUTES or when attendanceBeginSession() is called, then everybody can sign in again.
+ *
+ * With ATTENDANCE_REENTRY_MINUTES set, a student who scans again is checked out (and in again on the
+ * next scan), but only once the re-entry window has passed. The window is kept in k + 1 more bitsets
+ * of rolling epochs of N / k minutes, N = ATTENDANCE_REENTRY_MINUTES and k = ATTENDANCE_REENTRY_STEPS:
+ * a scan is remembered for the rest of its epoch and k more, so the next one is accepted more than N
+ * and at most N + N / k minutes after it. This mode takes k + 2 bits per student: with the default
+ * k = 1, 750 bytes for 2000 students and a wait between N and 2 N minutes, with k = 4 the wait is
+ * at most 1.25 N minutes for 1500 bytes. The bitsets may take ATTENDANCE_RAM_BUDGET bytes.
+ */
+#ifndef ATTENDANCE_H
+#define ATTENDANCE_H
+
+#include <Arduino.h>
+#include "Roster.h"
+
+#ifndef SESSION_LENGTH_MINUTES
+#define SESSION_LENGTH_MINUTES 0      // 0 = one session until the next reset
+#endif
+
+#ifndef ATTENDANCE_REENTRY_MINUTES
+#define ATTENDANCE_REENTRY_MINUTES 0  // 0 = one scan per student and session
+#endif
+
+#ifndef ATTENDANCE_REENTRY_STEPS
+#define ATTENDANCE_REENTRY_STEPS 1    // epochs per re-entry window, must divide N * 60000 ms
+#endif
+
+#ifndef ATTENDANCE_RAM_BUDGET
+#define ATTENDANCE_RAM_BUDGET 1024    // bytes, half the RAM of an Uno
+#endif
+
+#define ATTENDANCE_BYTES ((ROSTER_COUNT + 7) / 8)
+
+enum AttendanceResult : byte {
+  ATTENDANCE_IN,       // first scan of the session, or back in after checking out
+  ATTENDANCE_OUT,      // checked out (only with ATTENDANCE_REENTRY_MINUTES)
+  ATTENDANCE_ALREADY   // already scanned, nothing to record
+};
+
+/**
+ * Starts a new session, nobody is signed in.
+ */
+void attendanceBeginSession();
+
+/**
+ * Records a scan of the student and tells what it means.
+ */
+AttendanceResult attendanceMark(RosterIndex index);
+
+#endif
@@ -0,0 +1,34 @@
+#include "RecordFrame.h"
+
+uint16_t recordFrameCrc(const byte *data, byte length) {
+  uint16_t crc = 0xFFFF;
+  while (length--) {
+    crc ^= (uint16_t)*data++ << 8;
+    for (byte bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+byte recordFrameEncode(byte *frame, RosterIndex index, RecordStatus status, unsigned long timestamp,
+                       const byte *uid, byte uidSize) {
+  byte n = 0;
+  frame[n++] = RECORD_FRAME_SOF;
+  frame[n++] = 9 + uidSize;
+  frame[n++] = lowByte(index);
+  frame[n++] = highByte(index);
+  frame[n++] = status;
+  frame[n++] = READER_ID;
+  for (byte i = 0; i < 4; i++) {
+    frame[n++] = timestamp >> (8 * i);
+  }
+  frame[n++] = uidSize;
+  memcpy(frame + n, uid, uidSize);
+  n += uidSize;
+  // The start byte is not covered, a receiver looking for it checks the rest
+  uint16_t crc = recordFrameCrc(frame + 1, n - 1);
+  frame[n++] = lowByte(crc);
+  frame[n++] = highByte(crc);
+  return n;
+}
@@ -0,0 +1,47 @@
+/**
+ * Compact binary attendance record, the alternative to a PLX-DAQ text row.
+ *
+ * Frame layout, multi byte values little endian:
+ *
+ *   0xA5              start of frame
+ *   length            number of payload bytes that follow, 9 + UID size
+ *   index (2)         roster index of the student
+ *   status            RECORD_IN or RECORD_OUT
+ *   reader            READER_ID of the sending reader
+ *   timestamp (4)     millis() when the card was scanned
+ *   uid size, uid     4, 7 or 10 bytes
+ *   crc (2)           CRC-16/CCITT-FALSE of length and payload
+ *
+ * A record takes 17 to 23 bytes instead of about 100 for the text row. tools/frame_decode.py turns the
+ * frames back into the columns of the sheet, using the same roster CSV as the sketch.
+ */
+#ifndef RECORD_FRAME_H
+#define RECORD_FRAME_H
+
+#include <Arduino.h>
+#include "Roster.h"
+
+#ifndef READER_ID
+#define READER_ID 1  // tells the readers apart when several send to the same PC
+#endif
+
+#define RECORD_FRAME_SOF 0xA5
+#define RECORD_FRAME_MAX 23  // frame with a 10 byte UID
+
+enum RecordStatus : byte {
+  RECORD_IN,
+  RECORD_OUT
+};
+
+/**
+ * Builds the frame of a record in frame (at least RECORD_FRAME_MAX bytes) and returns its length.
+ */
+byte recordFrameEncode(byte *frame, RosterIndex index, RecordStatus status, unsigned long timestamp,
+                       const byte *uid, byte uidSize);
+
+/**
+ * CRC-16/CCITT-FALSE: polynomial 0x1021, initial value 0xFFFF.
+ */
+uint16_t recordFrameCrc(const byte *data, byte length);
+
+#endif
@@ -0,0 +1,220 @@
+#include "RecordQueue.h"
+#include "Attendance.h"
+
+struct QueuedRecord {
+  RosterIndex index;
+  RecordStatus status;
+  unsigned long timestamp;
+};
+
+static QueuedRecord queue[RECORD_QUEUE_SIZE];
+static byte head;              // oldest record
+static byte count;
+static bool writing;           // the oldest record or the save command is partly written
+static unsigned int rowSent;   // bytes of it (in PLX-DAQ mode: of its current piece) already written
+static unsigned long lastAdd;  // millis() of the last queued record
+
+#if RECORD_FORMAT == RECORD_FORMAT_BINARY
+
+static byte frame[RECORD_FRAME_MAX];  // the oldest record, encoded when its first byte goes out
+static byte frameLength;
+
+/**
+ * Writes the next room bytes at most of a record. Returns true once all of it is written.
+ */
+static bool sendRecord(const QueuedRecord &record, int &room) {
+  if (rowSent == 0) {
+    byte uid[10];
+    byte uidSize = rosterUid(record.index, uid);
+    frameLength = recordFrameEncode(frame, record.index, record.status, record.timestamp, uid, uidSize);
+  }
+  unsigned int length = min((unsigned int)room, frameLength - rowSent);
+  Serial.write(frame + rowSent, length);
+  rowSent += length;
+  room -= length;
+  return rowSent == frameLength;
+}
+
+#else
+
+static const char saveCommand[] PROGMEM = "SAVEWORKBOOKAS,Names/WorkNames\r\n";
+static byte rowPiece;          // piece of the oldest record being written, see sendRecord()
+static unsigned int unsaved;   // rows sent since the last save
+static bool saving;            // writing the save command, it goes out between two rows
+static bool saveRequested;
+static char command[8];        // line received from the PC
+static byte commandLength;
+
+#define RECORD_PIECES (2 * ROSTER_FIELD_COUNT + 1)  // the fields and the texts around them
+
+/**
+ * Returns the text in front of field piece / 2 of a row, or after the last field: the row starts
+ * with "DATA,DATE,TIME,", commas separate the fields and the line end follows them.
+ */
+static PGM_P recordSeparator(const QueuedRecord &record, byte piece) {
+  if (piece == 0) {
+    return PSTR("DATA,DATE,TIME,");
+  }
+  if (piece < RECORD_PIECES - 1) {
+    return PSTR(",");
+  }
+#if ATTENDANCE_REENTRY_MINUTES
+  return record.status == RECORD_OUT ? PSTR(",OUT\r\n") : PSTR(",IN\r\n");
+#else
+  (void)record;
+  return PSTR("\r\n");
+#endif
+}
+
+static inline char textByte(PGM_P text) {
+  return pgm_read_byte(text);
+}
+
+static inline char textByte(RosterText text) {
+  return rosterTextByte(text);
+}
+
+/**
+ * Writes a text from flash, a PGM_P or a roster field, starting at byte rowSent, until room is used up.
+ * Returns true once all of it is written.
+ */
+template <class Text>
+static bool sendText(Text text, int &room) {
+  text += rowSent;
+  char c;
+  while (room > 0 && (c = textByte(text)) != 0) {
+    Serial.write(c);
+    text++;
+    rowSent++;
+    room--;
+  }
+  return textByte(text) == 0;
+}
+
+/**
+ * Writes the next room bytes at most of a record, continuing where the last call stopped: the even
+ * pieces are the separators, the odd ones the fields. Returns true once all of it is written.
+ */
+static bool sendRecord(const QueuedRecord &record, int &room) {
+  for (; rowPiece < RECORD_PIECES; rowPiece++) {
+    bool done = rowPiece & 1
+      ? sendText(rosterField(record.index, (RosterField)(rowPiece / 2)), room)
+      : sendText(recordSeparator(record, rowPiece), room);
+    if (!done) {
+      return false;
+    }
+    rowSent = 0;
+  }
+  rowPiece = 0;
+  return true;
+}
+
+/**
+ * True if the workbook has to be saved before the next row.
+ */
+static bool saveDue() {
+  if (unsaved == 0 && !saveRequested) {
+    return false;
+  }
+  // A requested or idle save waits until all queued rows are out
+  return unsaved >= SAVE_AFTER_RECORDS || (count == 0 && (saveRequested || millis() - lastAdd >= SAVE_IDLE_MS));
+}
+#endif
+
+/**
+ * Writes as much of the queue as fits into room bytes.
+ */
+static void sendQueued(int room) {
+  while (room > 0) {
+    if (!writing) {
+#if RECORD_FORMAT == RECORD_FORMAT_PLXDAQ
+      saving = saveDue();
+      if (!saving && count == 0) {
+        break;
+      }
+#else
+      if (count == 0) {
+        break;
+      }
+#endif
+      writing = true;
+    }
+#if RECORD_FORMAT == RECORD_FORMAT_PLXDAQ
+    if (saving) {
+      if (!sendText(saveCommand, room)) {
+        break;
+      }
+      rowSent = 0;
+      writing = false;
+      saving = false;
+      unsaved = 0;
+      saveRequested = false;
+      continue;
+    }
+#endif
+    if (!sendRecord(queue[head], room)) {
+      break;
+    }
+    rowSent = 0;
+    writing = false;
+    head = (head + 1) % RECORD_QUEUE_SIZE;
+    count--;
+#if RECORD_FORMAT == RECORD_FORMAT_PLXDAQ
+    unsaved++;
+#endif
+  }
+}
+
+#if RECORD_FORMAT == RECORD_FORMAT_PLXDAQ
+/**
+ * Reads command lines sent by the PC.
+ */
+static void readCommands() {
+  while (Serial.available() > 0) {
+    char c = Serial.read();
+    if (c != '\r' && c != '\n') {
+      if (commandLength < sizeof(command)) {
+        command[commandLength++] = c;
+      }
+      continue;
+    }
+    if (commandLength == 4 && memcmp(command, "SAVE", 4) == 0) {
+      saveRequested = true;
+    }
+    commandLength = 0;
+  }
+}
+#endif
+
+void recordQueueAdd(RosterIndex index, RecordStatus status, unsigned long timestamp) {
+  while (count == RECORD_QUEUE_SIZE) {
+    // Wait for the serial line rather than dropping a record
+    sendQueued(Serial.availableForWrite());
+  }
+  QueuedRecord &record = queue[(head + count) % RECORD_QUEUE_SIZE];
+  record.index = index;
+  record.status = status;
+  record.timestamp = timestamp;
+  count++;
+  lastAdd = millis();
+}
+
+void recordQueueUpdate() {
+#if RECORD_FORMAT == RECORD_FORMAT_PLXDAQ
+  readCommands();
+#endif
+  int room = Serial.availableForWrite();
+  if (room > 0) {
+    sendQueued(room);
+  }
+}
+
+void recordQueueSave() {
+#if RECORD_FORMAT == RECORD_FORMAT_PLXDAQ
+  saveRequested = true;
+#endif
+}
+
+byte recordQueuePending() {
+  return count;
+}
@@ -0,0 +1,69 @@
+/**
+ * Records waiting to be sent to the PC.
+ *
+ * acceptCard() only queues a record, recordQueueUpdate() sends them from loop() as fast as the
+ * serial transmit buffer drains, so a scan never waits for the serial line. A row is written in
+ * pieces that fit the free space of the buffer, each continuing where the last one stopped.
+ *
+ * In PLX-DAQ mode, saving the workbook is coalesced: SAVEWORKBOOKAS is sent once SAVE_AFTER_RECORDS
+ * rows are waiting to be saved, once nothing was scanned for SAVE_IDLE_MS, or when the PC sends a
+ * line "SAVE". A burst of students causes one save instead of one per student.
+ */
+#ifndef RECORD_QUEUE_H
+#define RECORD_QUEUE_H
+
+#include <Arduino.h>
+#include "Roster.h"
+#include "RecordFrame.h"
+
+// How records are sent to the PC
+#define RECORD_FORMAT_PLXDAQ 0  // text rows for the PLX-DAQ sheet
+#define RECORD_FORMAT_BINARY 1  // binary frames (RecordFrame.h), decoded by tools/frame_decode.py
+
+#ifndef RECORD_FORMAT
+#define RECORD_FORMAT RECORD_FORMAT_PLXDAQ
+#endif
+
+#ifndef SERIAL_BAUD
+#if RECORD_FORMAT == RECORD_FORMAT_BINARY
+#define SERIAL_BAUD 115200
+#else
+#define SERIAL_BAUD 9600        // must match the baud rate set in PLX-DAQ, up to 115200 works
+#endif
+#endif
+
+#ifndef RECORD_QUEUE_SIZE
+#define RECORD_QUEUE_SIZE 16    // records, 7 bytes of RAM each
+#endif
+
+#ifndef SAVE_AFTER_RECORDS
+#define SAVE_AFTER_RECORDS 30   // save at the latest after this many rows
+#endif
+
+#ifndef SAVE_IDLE_MS
+#define SAVE_IDLE_MS 10000      // save once no card was scanned for this long
+#endif
+
+/**
+ * Queues the record of a scan. When the queue is full the oldest record is sent first,
+ * waiting for the serial line, so no record is lost.
+ */
+void recordQueueAdd(RosterIndex index, RecordStatus status, unsigned long timestamp);
+
+/**
+ * Sends what fits into the serial transmit buffer and saves the workbook when it is due.
+ * Call it from loop().
+ */
+void recordQueueUpdate();
+
+/**
+ * Saves the workbook as soon as the queued rows are sent.
+ */
+void recordQueueSave();
+
+/**
+ * Number of records not completely sent yet.
+ */
+byte recordQueuePending();
+
+#endif
@@ -0,0 +1,119 @@
+#include "Roster.h"
+#include "roster_tables.h"
+
+/**
+ * Compares a UID with an entry of rosterUids, like memcmp().
+ */
+static int compareUid(const byte *uid, RosterText entry, byte size) {
+  for (byte i = 0; i < size; i++) {
+    byte stored = rosterReadByte(entry + i);
+    if (uid[i] != stored) {
+      return uid[i] < stored ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+RosterIndex rosterFind(const byte *uid, byte size) {
+  // Each UID length has its own sorted block in rosterUids
+  RosterIndex first;
+  RosterIndex count;
+  RosterText table = ROSTER_ADDRESS(rosterUids);
+  switch (size) {
+    case 4:
+      first = 0;
+      count = ROSTER_COUNT_4;
+      break;
+    case 7:
+      first = ROSTER_COUNT_4;
+      count = ROSTER_COUNT_7;
+      table += 4UL * ROSTER_COUNT_4;
+      break;
+    case 10:
+      first = ROSTER_COUNT_4 + ROSTER_COUNT_7;
+      count = ROSTER_COUNT_10;
+      table += 4UL * ROSTER_COUNT_4 + 7UL * ROSTER_COUNT_7;
+      break;
+    default:
+      return ROSTER_NOT_FOUND;
+  }
+
+  RosterIndex low = 0;
+  RosterIndex high = count;
+  while (low < high) {
+    RosterIndex mid = low + (high - low) / 2;
+    int diff = compareUid(uid, table + (unsigned long)mid * size, size);
+    if (diff == 0) {
+      return first + mid;
+    }
+    if (diff < 0) {
+      high = mid;
+    }
+    else {
+      low = mid + 1;
+    }
+  }
+  return ROSTER_NOT_FOUND;
+}
+
+byte rosterUid(RosterIndex index, byte *uid) {
+  unsigned long offset;
+  byte size;
+  if (index < ROSTER_COUNT_4) {
+    offset = 4UL * index;
+    size = 4;
+  }
+  else if (index < ROSTER_COUNT_4 + ROSTER_COUNT_7) {
+    offset = 4UL * ROSTER_COUNT_4 + 7UL * (index - ROSTER_COUNT_4);
+    size = 7;
+  }
+  else {
+    offset = 4UL * ROSTER_COUNT_4 + 7UL * ROSTER_COUNT_7 + 10UL * (index - ROSTER_COUNT_4 - ROSTER_COUNT_7);
+    size = 10;
+  }
+  RosterText entry = ROSTER_ADDRESS(rosterUids) + offset;
+  for (byte i = 0; i < size; i++) {
+    uid[i] = rosterReadByte(entry + i);
+  }
+  return size;
+}
+
+/**
+ * Returns the address of the text pool of a field. Each field has its own, so the 16 bit offsets
+ * reach further than with one pool for all.
+ */
+static RosterText fieldPool(RosterField field) {
+  switch (field) {
+    case ROSTER_NAME:
+      return ROSTER_ADDRESS(rosterTextName);
+    case ROSTER_USN:
+      return ROSTER_ADDRESS(rosterTextUsn);
+    case ROSTER_REG:
+      return ROSTER_ADDRESS(rosterTextReg);
+    case ROSTER_BRANCH:
+      return ROSTER_ADDRESS(rosterTextBranch);
+    case ROSTER_MAIL:
+      return ROSTER_ADDRESS(rosterTextMail);
+    case ROSTER_SECTION:
+      return ROSTER_ADDRESS(rosterTextSection);
+    default:
+      return ROSTER_ADDRESS(rosterTextContact);
+  }
+}
+
+RosterText rosterField(RosterIndex index, RosterField field) {
+  RosterText entry = ROSTER_ADDRESS(rosterFields) + ((unsigned long)field * ROSTER_COUNT + index) * ROSTER_OFFSET_SIZE;
+#if ROSTER_OFFSET_SIZE == 4
+  return fieldPool(field) + rosterReadDword(entry);
+#else
+  return fieldPool(field) + rosterReadWord(entry);
+#endif
+}
+
+void rosterPrint(Print &out, RosterIndex index, RosterField field) {
+  RosterText text = rosterField(index, field);
+  char c;
+  while ((c = rosterTextByte(text++)) != 0) {
+    out.write(c);
+  }
+}
@@ -0,0 +1,90 @@
+/**
+ * The students that can sign in, kept in flash.
+ *
+ * The tables are generated from a CSV file by tools/roster_gen.py. The UIDs are stored sorted by
+ * length and value, so a card is found with a binary search (about 11 compares for 2000 students)
+ * and no RAM is needed for the roster itself. A student is identified by its roster index,
+ * 0 .. ROSTER_COUNT-1, the position of its UID in that order.
+ *
+ * On boards with more than 64 KB of flash (ROSTER_FAR) the tables are placed behind the code and read
+ * with far addresses, so a roster of thousands of students fits and does not push the PROGMEM data of
+ * the sketch and its libraries out of the reach of near pointers.
+ */
+#ifndef ROSTER_H
+#define ROSTER_H
+
+#include <Arduino.h>
+#include "roster_data.h"
+
+typedef uint16_t RosterIndex;
+
+#ifndef ROSTER_FAR
+#define ROSTER_FAR (FLASHEND > 0xFFFF)
+#endif
+
+#if ROSTER_FAR
+typedef uint_farptr_t RosterText;  // flash address of a text, see rosterTextByte()
+#define ROSTER_ADDRESS(table) pgm_get_far_address(table)
+#define rosterReadByte(address) pgm_read_byte_far(address)
+#define rosterReadWord(address) pgm_read_word_far(address)
+#define rosterReadDword(address) pgm_read_dword_far(address)
+#ifdef __AVR__
+// .fini7 comes after the code and is never run, the sketch does not return from main()
+#define ROSTER_PROGMEM __attribute__((__used__, __section__(".fini7")))
+#endif
+#else
+typedef uintptr_t RosterText;
+#define ROSTER_ADDRESS(table) ((uintptr_t)(table))
+#define rosterReadByte(address) pgm_read_byte(address)
+#define rosterReadWord(address) pgm_read_word(address)
+#define rosterReadDword(address) pgm_read_dword(address)
+#endif
+
+#ifndef ROSTER_PROGMEM
+#define ROSTER_PROGMEM PROGMEM
+#endif
+
+#define ROSTER_NOT_FOUND 0xFFFF
+
+// Fields of a student record, in the column order of the CSV file
+enum RosterField : byte {
+  ROSTER_NAME,
+  ROSTER_USN,
+  ROSTER_REG,
+  ROSTER_BRANCH,
+  ROSTER_MAIL,
+  ROSTER_SECTION,
+  ROSTER_CONTACT,
+  ROSTER_FIELD_COUNT
+};
+
+/**
+ * Returns the roster index of the card with the given UID (4, 7 or 10 bytes),
+ * or ROSTER_NOT_FOUND if the card is not in the roster.
+ */
+RosterIndex rosterFind(const byte *uid, byte size);
+
+/**
+ * Copies the UID of a student to uid (10 bytes) and returns its size.
+ */
+byte rosterUid(RosterIndex index, byte *uid);
+
+/**
+ * Returns the flash address of a field of a student record, a NUL terminated text.
+ * Read it with rosterTextByte(), or print it with rosterPrint().
+ */
+RosterText rosterField(RosterIndex index, RosterField field);
+
+/**
+ * Returns the byte of a roster text at address, NUL at its end.
+ */
+static inline char rosterTextByte(RosterText address) {
+  return rosterReadByte(address);
+}
+
+/**
+ * Prints a field of a student record, streamed from flash without using the heap.
+ */
+void rosterPrint(Print &out, RosterIndex index, RosterField field);
+
+#endif
@@ -1,6 +1,9 @@
 #include <SPI.h>             // library allows to communicate with SPI devices
 #include <MFRC522.h>        // library for read/write a RFID card or tag (include this in library)
 #include <LiquidCrystal.h> // lcd library file
+#include "Roster.h"         // students allowed to sign in, generated by tools/roster_gen.py
+#include "Attendance.h"     // who has signed in, sessions and re-entry are configured there
+#include "RecordQueue.h"    // records waiting for the PC, record format and baud rate are configured there
 
 // Pin Definitions 
 #define LCD_PIN_RS 3
@@ -17,32 +20,246 @@ MFRC522 mfrc522(SS_PIN, RST_PIN); // Create MFRC522 instance.
 
 // Global variables and defines
 
+// How long each screen of the scan feedback stays on the LCD (ms).
+// The reader keeps polling while a screen is shown, a new card cuts the running sequence short.
+#define SCAN_MSG_MS      500   // " SCAN SUCCESSFUL"
+#define USER_MSG_MS      1000  // NAME / USN of the card owner
+#define RECORDED_MSG_MS  1000  // "YOUR ATTENDANCE IS RECORDED"
+#define ALREADY_MSG_MS   1500  // "CARD ALREADY DETECTED"
+#define UNKNOWN_MSG_MS   1500  // "CARD NOT REGISTERED"
+#define BEEP_MS          80    // buzzer beep length
+#define LED_MS           800   // how long the green/red LED stays on after a scan
+#define SPLASH_MSG_MS    1500  // each screen of the start up splash with FAST_BOOT
+#define IDLE_POLL_MS     50    // longest pause between two polls of the reader when nobody has come for a while
+
+// 1: the reader is ready right after reset, the splash screens run in the background.
+// 0: the original start up sequence, about 20 seconds before the first card is read.
+#ifndef FAST_BOOT
+#define FAST_BOOT 1
+#endif
+
 // object initialization
 LiquidCrystal lcd(LCD_PIN_RS,LCD_PIN_E,LCD_PIN_DB4,LCD_PIN_DB5,LCD_PIN_DB6,LCD_PIN_DB7);
 
-byte card_ID[4]; //card UID size 4byte
-byte Name1[4]={0xFA,0x89,0x6C,0x2E};//first UID card
-byte Name2[4]={0x6A,0x6E,0x51,0x83};//second UID card
-
-//number of cards you have 
-int NumbCard[2];//this array content the number of cards. in my case i have just two cards.
-int j=0;        
+byte card_ID[10]; //card UID, 4, 7 or 10 bytes
+byte card_size;   //number of valid bytes in card_ID
+RosterIndex j;     //roster index of the last card
 
 int const YellowLed=7;
 int const GreenLed=6;
 int const RedLed=5;
 int const Buzzer=4;
 
-String Name;//user name
-String Section;//user section
-String Branch;//user branch
-String USN;//user USN ID
-String reg;//user roll number
-String Mail;//user college enrolled mail
-long Contact;//user contact number
 int n ;//The number of card you want to detect (optional)  
 
+// Screens of the scan feedback sequence
+enum DisplayState : byte {
+  SHOW_READY,     // "PLEASE SCAN YOUR ID", waiting for a card
+  SHOW_SPLASH_WAIT,   // start up splash: "RFID PLEASE WAIT"
+  SHOW_SPLASH_INIT,   // "INITIALISATION PROCESS.."
+  SHOW_SPLASH_SHEET,  // "Plx-DAQ SHEET LABEL"
+  SHOW_SPLASH_CLEAR,  // "CLEARSHEET"
+  SHOW_SCAN_OK,   // card read, followed by SHOW_USER or SHOW_UNKNOWN
+  SHOW_USER,      // name and USN, followed by SHOW_RECORDED or SHOW_ALREADY
+  SHOW_RECORDED,  // record sent to excel, attendance recorded or checked out
+  SHOW_ALREADY,   // card was already detected
+  SHOW_UNKNOWN    // card is not in the list
+};
+
+// Result of the last accepted card
+enum ScanResult : byte {
+  SCAN_RECORDED,
+  SCAN_CHECKED_OUT,
+  SCAN_ALREADY,
+  SCAN_UNKNOWN
+};
+
+DisplayState displayState = SHOW_READY;
+ScanResult scanResult;
+unsigned long displayMillis;  //when the current screen was shown
+unsigned long displayTime;    //how long the current screen stays
+
+// An output (LED or buzzer) switched on for a while, switched off again from loop()
+struct TimedOutput {
+  int pin;
+  bool active;
+  unsigned long startMillis;
+  unsigned long onTime;
+};
+
+TimedOutput buzzerOut = {Buzzer, false, 0, 0};
+TimedOutput greenOut = {GreenLed, false, 0, 0};
+TimedOutput redOut = {RedLed, false, 0, 0};
+
+/**
+ * Switches the output on, updateOutput() switches it off after ms milliseconds.
+ */
+void pulseOutput(TimedOutput &out, unsigned long ms) {
+  digitalWrite(out.pin, HIGH);
+  out.active = true;
+  out.startMillis = millis();
+  out.onTime = ms;
+}
+
+void updateOutput(TimedOutput &out) {
+  if (out.active && (millis() - out.startMillis >= out.onTime)) {
+    out.active = false;
+    digitalWrite(out.pin, LOW);
+  }
+}
+
+/**
+ * Shows a two line screen and remembers when it has to be replaced.
+ */
+void showScreen(DisplayState state, const __FlashStringHelper *line1, const __FlashStringHelper *line2, unsigned long ms) {
+  lcd.clear();
+  lcd.print(line1);
+  lcd.setCursor(0, 1); 
+  lcd.print(line2);
+  displayState = state;
+  displayMillis = millis();
+  displayTime = ms;
+}
+
+void showReady() {
+  showScreen(SHOW_READY, F("PLEASE SCAN YOUR"), F("ID"), 0);
+}
+
+void showUser() {
+  lcd.clear();
+  lcd.print(F("NAME: "));
+  rosterPrint(lcd, j, ROSTER_NAME);
+  lcd.setCursor(0, 1); 
+  lcd.print(F("USN: "));
+  rosterPrint(lcd, j, ROSTER_USN);
+  displayState = SHOW_USER;
+  displayMillis = millis();
+  displayTime = USER_MSG_MS;
+  pulseOutput(greenOut, LED_MS);
+}
+
+/**
+ * Moves the feedback sequence to its next screen once the current one has been shown long enough.
+ */
+void updateDisplay() {
+  if (displayState == SHOW_READY || millis() - displayMillis < displayTime) {
+    return;
+  }
+  switch (displayState) {
+    case SHOW_SPLASH_WAIT:
+      showScreen(SHOW_SPLASH_INIT, F("INITIALISATION"), F("PROCESS.."), SPLASH_MSG_MS);
+      lcd.blink();
+      break;
+    case SHOW_SPLASH_INIT:
+      lcd.noBlink();
+      showScreen(SHOW_SPLASH_SHEET, F("Plx-DAQ SHEET"), F("LABEL"), SPLASH_MSG_MS);
+      break;
+    case SHOW_SPLASH_SHEET:
+      showScreen(SHOW_SPLASH_CLEAR, F("CLEARSHEET"), F(""), SPLASH_MSG_MS);
+      break;
+    case SHOW_SCAN_OK:
+      if (scanResult == SCAN_UNKNOWN) {
+        showScreen(SHOW_UNKNOWN, F("CARD NOT"), F("REGISTERED"), UNKNOWN_MSG_MS);
+        pulseOutput(redOut, LED_MS);
+      }
+      else {
+        showUser();
+      }
+      break;
+    case SHOW_USER:
+      if (scanResult == SCAN_ALREADY) {
+        showScreen(SHOW_ALREADY, F("CARD ALREADY"), F("DETECTED"), ALREADY_MSG_MS);
+        pulseOutput(redOut, LED_MS);
+      }
+      else if (scanResult == SCAN_CHECKED_OUT) {
+        showScreen(SHOW_RECORDED, F("YOU ARE"), F("CHECKED OUT"), RECORDED_MSG_MS);
+      }
+      else {
+        showScreen(SHOW_RECORDED, F("YOUR ATTENDANCE"), F("IS RECORDED"), RECORDED_MSG_MS);
+      }
+      break;
+    default:
+      showReady();
+      break;
+  }
+}
+
+/**
+ * Handles a card that has just been read into mfrc522.uid.
+ * The record is queued for the PC, sending it and the feedback run in the background from loop().
+ */
+void acceptCard() {
+  unsigned long now = millis();
+  if (displayState == SHOW_SPLASH_INIT) {
+    lcd.noBlink();  // the card cuts the splash short
+  }
+  card_size = mfrc522.uid.size;
+  memcpy(card_ID, mfrc522.uid.uidByte, card_size);
+
+  j = rosterFind(card_ID, card_size);
+  if (j == ROSTER_NOT_FOUND) {
+    scanResult = SCAN_UNKNOWN;
+  }
+  else {
+    switch (attendanceMark(j)) {//to check if the card already detect
+      case ATTENDANCE_ALREADY:
+        scanResult = SCAN_ALREADY;
+        break;
+      case ATTENDANCE_OUT:
+        scanResult = SCAN_CHECKED_OUT;
+        recordQueueAdd(j, RECORD_OUT, now);
+        break;
+      default:
+        scanResult = SCAN_RECORDED;
+        n++;//(optional)
+        recordQueueAdd(j, RECORD_IN, now);
+        break;
+    }
+  }
+
+  showScreen(SHOW_SCAN_OK, F(" SCAN"), F("SUCCESSFUL"), SCAN_MSG_MS);
+  pulseOutput(buzzerOut, BEEP_MS);
+}
+
+/**
+ * Sets up the columns of the PLX-DAQ sheet.
+ */
+void sendSheetHeader() {
+#if RECORD_FORMAT == RECORD_FORMAT_PLXDAQ
+  Serial.println(F("CLEARSHEET"));                 // clears starting at row 1
+#if ATTENDANCE_REENTRY_MINUTES
+  Serial.println(F("LABEL,Date,Time,Name,USN,reg,Branch,Mail,Section,contact,Status,"));
+#else
+  Serial.println(F("LABEL,Date,Time,Name,USN,reg,Branch,Mail,Section,contact,"));// make four columns (Date,Time,[Name:"user name"]line 48 & 52,[Number:"user number"]line 49 & 53)
+#endif
+  Serial.println(F("Scan PICC to see UID..."));
+  Serial.println(F(""));
+#endif
+}
+
 void setup() {
+#if FAST_BOOT
+  pinMode(RedLed,OUTPUT);
+  pinMode(GreenLed,OUTPUT);
+  pinMode(YellowLed,OUTPUT);
+  pinMode(Buzzer,OUTPUT);
+  lcd.begin(16, 2);
+
+  Serial.begin(SERIAL_BAUD); // Initialize serial communications with the PC
+  SPI.begin();  // Init SPI bus
+  mfrc522.PCD_SetRegisterCache(true); // keep the reader's settings in RAM, polls skip unchanged writes
+  mfrc522.PCD_SetSoftwareCRC(true); // CRC_A by table lookup instead of a round trip to the reader's coprocessor
+  mfrc522.PCD_SetRequestWindow(1000); // an empty field answers a poll after 1ms instead of 25ms
+  mfrc522.PICC_SetIdlePolling(IDLE_POLL_MS); // poll less when nobody has come for a while
+  mfrc522.PCD_Init(); // Init MFRC522 card
+  attendanceBeginSession();
+  sendSheetHeader();
+
+  // The reader is ready, the splash runs from updateDisplay() until the first card
+  digitalWrite(YellowLed, HIGH);
+  pulseOutput(buzzerOut, 200);
+  showScreen(SHOW_SPLASH_WAIT, F("RFID"), F("PLEASE WAIT"), SPLASH_MSG_MS);
+#else
    
   pinMode(RedLed,OUTPUT);
   pinMode(GreenLed,OUTPUT);
@@ -84,12 +301,16 @@ void setup() {
   lcd.noBlink();
   delay(100);
 
-  Serial.begin(9600); // Initialize serial communications with the PC
+  Serial.begin(SERIAL_BAUD); // Initialize serial communications with the PC
   SPI.begin();  // Init SPI bus
+  mfrc522.PCD_SetRegisterCache(true); // keep the reader's settings in RAM, polls skip unchanged writes
+  mfrc522.PCD_SetSoftwareCRC(true); // CRC_A by table lookup instead of a round trip to the reader's coprocessor
+  mfrc522.PCD_SetRequestWindow(1000); // an empty field answers a poll after 1ms instead of 25ms
+  mfrc522.PICC_SetIdlePolling(IDLE_POLL_MS); // poll less when nobody has come for a while
   mfrc522.PCD_Init(); // Init MFRC522 card
+  attendanceBeginSession();
   
-  Serial.println("CLEARSHEET");                 // clears starting at row 1
-  Serial.println("LABEL,Date,Time,Name,USN,reg,Branch,Mail,Section,contact,");// make four columns (Date,Time,[Name:"user name"]line 48 & 52,[Number:"user number"]line 49 & 53)
+  sendSheetHeader();
   delay(1000);
   
   lcd.print("Plx-DAQ SHEET");
@@ -107,177 +328,29 @@ void setup() {
   digitalWrite(YellowLed, HIGH);
   delay(500);   
   
-  lcd.clear();
-  delay(100);                  
-  lcd.print("PLEASE SCAN YOUR");
-  lcd.setCursor(0,1);      
-  lcd.print("ID");
+  showReady();
   delay(3000);        
-           
-  Serial.println("Scan PICC to see UID...");
-  Serial.println("");
-
+#endif
  }
     
 void loop() {
-  //look for new card
-   if ( ! mfrc522.PICC_IsNewCardPresent()) {
-  return;//got to start of loop if there is no card present
- }
- // Select one of the cards
- if ( ! mfrc522.PICC_ReadCardSerial()) {
-  return;//if read card serial(0) returns 1, the uid struct contians the ID of the read card.
- }
- lcd.clear();
- delay(100);        
- lcd.print(" SCAN");
- lcd.setCursor(0,1);                  
- lcd.print("SUCCESSFUL"); 
- delay(3000); 
-
- digitalWrite(Buzzer,HIGH);
- delay(80);  
- digitalWrite(Buzzer,LOW);
- delay(10); 
- digitalWrite(RedLed, HIGH);
- delay(2000);
- digitalWrite(RedLed, LOW);
- delay(100); 
-   
- for (byte i = 0; i < mfrc522.uid.size; i++) {
-     card_ID[i] = mfrc522.uid.uidByte[i]; 
-     if (card_ID[i] == Name1[i]) {
-         Name = "USER_NAME";  // Placeholder for user name       
-         Contact = 1234567890;  // Placeholder for user contact number   
-         Section = "USER_SECTION";  // Placeholder for user section 
-         Branch = "USER_BRANCH";  // Placeholder for user branch  
-         USN = "USER_USN";  // Placeholder for user USN ID    
-         reg = "USER_REG_ID";  // Placeholder for user registration ID  
-         Mail = "USER_EMAIL";  // Placeholder for user college enrolled email ID
-
-         j = 0;  // First number in the NumbCard array : NumbCard[j]
-         
-         lcd.clear();
-         delay(100);
-         digitalWrite(GreenLed, HIGH);
-         delay(100);       
-         lcd.print("NAME: USER_NAME");       
-         lcd.setCursor(0, 1);
-         delay(100);
-         lcd.print("USN: USER_USN");
-         delay(1000); 
-         digitalWrite(GreenLed, LOW);
-         delay(100);         
-         lcd.clear();
-         delay(100);          
-     }  
-}
+  // LEDs, buzzer, LCD and the serial line run in the background, nothing in loop() waits
+  recordQueueUpdate();
+  updateOutput(buzzerOut);
+  updateOutput(greenOut);
+  updateOutput(redOut);
+  updateDisplay();
 
-      else if (card_ID[i] == Name2[i]) {
-    Name = "USER_NAME2";  // Placeholder for user name
-    Contact = 1234567890;  // Placeholder for user contact number
-    Section = "USER_SECTION2";  // Placeholder for user section
-    Branch = "USER_BRANCH2";  // Placeholder for user branch  
-    USN = "USER_USN2";  // Placeholder for user USN ID 
-    reg = "USER_REG_ID2";  // Placeholder for user registration ID  
-    Mail = "USER_EMAIL2";  // Placeholder for user college enrolled email ID                  
-    j = 1;  // Second number in the NumbCard array : NumbCard[j]  
-
-    lcd.clear();
-    delay(100);
-    digitalWrite(GreenLed, HIGH);
-    delay(100);       
-    lcd.print("NAME: USER_NAME2");       
-    lcd.setCursor(0, 1);
-    delay(100);
-    lcd.print("USN: USER_USN2");
-    delay(1000); 
-    digitalWrite(GreenLed, LOW);
-    delay(100);         
-    lcd.clear();
-    delay(100);  
-}
+  //look for new card, the reader waits for an answer while loop() goes round.
+  //A card read is halted and not read again while it lies on the reader, the driver only checks now and then if it is still there
+  if (mfrc522.PICC_PollCardEvent() != MFRC522::EVENT_NEW_CARD) {
+    return;//got to start of loop if there is no new card (yet), or the last one was taken away
+  }
+  acceptCard();
 
-      else{
-          digitalWrite(GreenLed,LOW);
-          digitalWrite(RedLed,HIGH);
-          goto cont;//go directly to line 85
-     }        
-}
-      if(NumbCard[j] == 1){//to check if the card already detect
-      //if you want to use LCD
-      lcd.clear();
-      delay(100);      
-      lcd.print("CARD ALREADY");
-      lcd.setCursor(0, 1);
-      lcd.print("DETECTED");           
-      delay(3000); 
-      
-      digitalWrite(GreenLed, HIGH);
-      delay(100);      
-      digitalWrite(RedLed, HIGH);
-      delay(2000);
-      digitalWrite(RedLed, LOW);
-      delay(100);             
-      //Serial.println("Already Exist");
-      }
-      else{  
-      lcd.clear();
-      delay(100);      
-      lcd.blink();
-      delay(100);                   
-      lcd.print("SENDING DATE TO");
-      lcd.setCursor(0,1);      
-      lcd.print("EXCEL..");
-      delay(3000);     
-      lcd.noBlink();
-      delay(100); 
-      
-      digitalWrite(GreenLed, HIGH);
-      delay(100);
-                                      
-      NumbCard[j] = 1;//put 1 in if you want to detect you are card once: put 2 in if you want to detect you are card twice 
-      n++;//(optional)
-      Serial.print("DATA,DATE,TIME," + Name);//send the Name to excel
-      Serial.print(",");
-      Serial.print("" + USN);//send the USN to excel
-      Serial.print(",");                
-      Serial.print("" + reg);//send the register no to excel
-      Serial.print(",");                           
-      Serial.print("" + Branch);//send the branch to excel
-      Serial.print(",");
-      Serial.print("" + Mail);//send the mail to excel
-      Serial.print(",");   
-      Serial.print("" + Section);//send the section to excel
-      Serial.print(",");         
-      Serial.println(Contact); //send the contact to excel      
-      digitalWrite(GreenLed,HIGH);
-      digitalWrite(RedLed,LOW);
-      digitalWrite(Buzzer,HIGH);
-      delay(80);
-      digitalWrite(Buzzer,LOW);
-      Serial.println("SAVEWORKBOOKAS,Names/WorkNames");    
-      delay(1000); 
-         
-      digitalWrite(RedLed, HIGH);
-      delay(800);
-                  
-lcd.clear();
-delay(100);                  
-lcd.print("YOUR ATTENDANCE");
-lcd.setCursor(0,1);      
-lcd.print("IS RECORDED");
-delay(3000);            
-}
-cont:
-delay(1000);
-digitalWrite(RedLed,LOW);
-digitalWrite(GreenLed,LOW);   
-//if you want to close the Excel when all card had detected and save Excel file in Names Folder. in my case i have just 2 card (optional)
-//if(n==2){
-    
-  //  Serial.println("FORCEEXCELQUIT");
- //   }
-}
+  //if you want to close the Excel when all card had detected and save Excel file in Names Folder. in my case i have just 2 card (optional)
+  //if(n==2){
 
-          
+    //  Serial.println("FORCEEXCELQUIT");
+   //   }
+}
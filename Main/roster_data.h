@@ -0,0 +1,11 @@
+// Generated by tools/roster_gen.py from roster.csv, do not edit.
+// Run the tool again after changing the roster.
+#ifndef ROSTER_DATA_H
+#define ROSTER_DATA_H
+
+#define ROSTER_COUNT 2
+#define ROSTER_COUNT_4 2
+#define ROSTER_COUNT_7 0
+#define ROSTER_COUNT_10 0
+
+#endif
@@ -0,0 +1,80 @@
+// Generated by tools/roster_gen.py from roster.csv, do not edit.
+// Run the tool again after changing the roster.
+#ifndef ROSTER_TABLES_H
+#define ROSTER_TABLES_H
+
+// UIDs of all students, 4 byte UIDs first, then 7 and 10 byte UIDs, each group sorted
+const byte rosterUids[] ROSTER_PROGMEM = {
+  0x6A, 0x6E, 0x51, 0x83, // 0 USER_NAME2
+  0xFA, 0x89, 0x6C, 0x2E, // 1 USER_NAME
+};
+
+// Every distinct name of the roster once, NUL terminated
+const char rosterTextName[] ROSTER_PROGMEM =
+  "USER_NAME2" "\0" // 0
+  "USER_NAME" "\0" // 11
+;
+
+// Every distinct usn of the roster once, NUL terminated
+const char rosterTextUsn[] ROSTER_PROGMEM =
+  "USER_USN2" "\0" // 0
+  "USER_USN" "\0" // 10
+;
+
+// Every distinct reg of the roster once, NUL terminated
+const char rosterTextReg[] ROSTER_PROGMEM =
+  "USER_REG_ID2" "\0" // 0
+  "USER_REG_ID" "\0" // 13
+;
+
+// Every distinct branch of the roster once, NUL terminated
+const char rosterTextBranch[] ROSTER_PROGMEM =
+  "USER_BRANCH2" "\0" // 0
+  "USER_BRANCH" "\0" // 13
+;
+
+// Every distinct mail of the roster once, NUL terminated
+const char rosterTextMail[] ROSTER_PROGMEM =
+  "USER_EMAIL2" "\0" // 0
+  "USER_EMAIL" "\0" // 12
+;
+
+// Every distinct section of the roster once, NUL terminated
+const char rosterTextSection[] ROSTER_PROGMEM =
+  "USER_SECTION2" "\0" // 0
+  "USER_SECTION" "\0" // 14
+;
+
+// Every distinct contact of the roster once, NUL terminated
+const char rosterTextContact[] ROSTER_PROGMEM =
+  "1234567890" "\0" // 0
+;
+
+#define ROSTER_OFFSET_SIZE 2
+
+// Offset into the rosterText pool of the field for each field (name, usn, reg, branch, mail, section, contact) and student
+const uint16_t rosterFields[7][2] ROSTER_PROGMEM = {
+  { // name
+    0, 11,
+  },
+  { // usn
+    0, 10,
+  },
+  { // reg
+    0, 13,
+  },
+  { // branch
+    0, 13,
+  },
+  { // mail
+    0, 12,
+  },
+  { // section
+    0, 14,
+  },
+  { // contact
+    0, 0,
+  },
+};
+
+#endif
@@ -0,0 +1,73 @@
+/**
+ * Boot and idle benchmark of the sketch on the host model.
+ *
+ * Reports the virtual time from reset until loop() polls the reader for the first time and the
+ * average cost of a loop() pass without a card. All times are what an Uno would spend, see HostSim.h.
+ * The reader is the MFRC522 emulator with an empty field.
+ *
+ * usage: boot_bench [--loops N] [--max-boot-ms MS] [--max-idle-us US]
+ * With a limit given, the exit code is 1 when the measurement exceeds it.
+ */
+#include <Arduino.h>
+#include <HostSim.h>
+#include "MFRC522Emulator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char **argv) {
+	unsigned long loops = 200;
+	double maxBootMs = 0;
+	double maxIdleUs = 0;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "--loops") == 0) {
+			loops = strtoul(argv[i + 1], nullptr, 10);
+		} else if (strcmp(argv[i], "--max-boot-ms") == 0) {
+			maxBootMs = atof(argv[i + 1]);
+		} else if (strcmp(argv[i], "--max-idle-us") == 0) {
+			maxIdleUs = atof(argv[i + 1]);
+		} else {
+			fprintf(stderr, "unknown option %s\n", argv[i]);
+			return 2;
+		}
+	}
+
+	PiccField field;
+	MFRC522Emulator chip(field);
+	HostSim::reset();
+	chip.attach(10, 9);		// SS_PIN and RST_PIN of the sketch
+	setup();
+	double bootMs = HostSim::nanos() / 1e6;
+
+	HostSim::resetStats();
+	chip.resetStats();
+	uint64_t start = HostSim::nanos();
+	for (unsigned long i = 0; i < loops; i++) {
+		loop();
+	}
+	double idleUs = (HostSim::nanos() - start) / 1e3 / loops;
+	const HostSim::Stats &stats = HostSim::stats();
+
+	printf("boot_to_first_poll_ms %.3f\n", bootMs);
+	printf("idle_loop_us %.1f\n", idleUs);
+	printf("idle_spi_bytes_per_loop %.1f\n", (double)stats.spiBytes / loops);
+	printf("idle_spi_transactions_per_loop %.1f\n", (double)stats.spiTransactions / loops);
+	printf("idle_register_reads_per_loop %.1f\n", (double)chip.stats().reads() / loops);
+	printf("idle_register_writes_per_loop %.1f\n", (double)chip.stats().writes() / loops);
+	printf("idle_heap_allocations %lu\n", stats.heapAllocations);
+
+	int result = 0;
+	if (maxBootMs > 0 && bootMs > maxBootMs) {
+		fprintf(stderr, "FAIL: boot took %.3f ms, limit %.3f ms\n", bootMs, maxBootMs);
+		result = 1;
+	}
+	if (maxIdleUs > 0 && idleUs > maxIdleUs) {
+		fprintf(stderr, "FAIL: idle loop took %.1f us, limit %.1f us\n", idleUs, maxIdleUs);
+		result = 1;
+	}
+	if (stats.heapAllocations > 0) {
+		fprintf(stderr, "FAIL: %lu heap allocations in the idle loop\n", stats.heapAllocations);
+		result = 1;
+	}
+	return result;
+}
@@ -0,0 +1,820 @@
+/**
+ * MFRC522 driver benchmark against the register level emulator.
+ *
+ * Runs the unchanged library calls the sketch uses, PCD_Init(), PICC_IsNewCardPresent(),
+ * PICC_ReadCardSerial() (PICC_Select()) and MIFARE_Read(), on virtual cards with 4, 7 and 10 byte
+ * UIDs and on two cards at once, checks the results and reports per call the virtual time, the SPI
+ * bytes and the register reads and writes the chip saw. The write paths are tried on a MIFARE
+ * Classic (PCD_Authenticate(), MIFARE_Write()) and an Ultralight (MIFARE_Ultralight_Write()). A whole
+ * Classic 1K is read per block, per sector (MIFARE_ReadSector()) and as one MIFARE_ReadRange(), a whole
+ * Ultralight and NTAG216 per READ and with MIFARE_Ultralight_ReadPages().
+ * PCD_AuthenticateWithKeys() looks for a site key without and with the key cache (MFRC522KeyCache).
+ * Some of it runs a second time with the register cache (PCD_SetRegisterCache()) and the software CRC
+ * (PCD_SetSoftwareCRC()) enabled, and a third time with the CRC of the chip (PCD_SetHardwareCRC()).
+ * PICC_PollNewCardPresent() is timed per call, polling ComIrqReg and waiting for the IRQ pin.
+ * PICC_Inventory() reads 1 to 16 cards at once and reports the cards per second.
+ * PICC_PollCardEvent() polls an empty field and reads a card until it is taken away. Some of the scans,
+ * the inventory and the events run again with the 1ms request window (PCD_SetRequestWindow()), the
+ * events also with idle polling (PICC_SetIdlePolling()).
+ * Then the scans run on MFRC522Base<MFRC522MockTransport>, the same driver talking to the emulator
+ * without the SPI bus. Last MFRC522Extended exchanges APDUs with ISO/IEC 14443-4 cards, the long
+ * ones streaming through the FIFO (PCD_TransceiveStream()), at 106kbit/s and after PPS to the rates
+ * the cards offer (PICC_SetBitRateNegotiation()).
+ *
+ * usage: driver_bench
+ * The exit code is 1 if a call fails or returns wrong data.
+ */
+#include <Arduino.h>
+#include <HostSim.h>
+#include <SPI.h>
+#include <MFRC522.h>
+#include <MFRC522Extended.h>
+#include <MFRC522KeyCache.h>
+#include <EEPROM.h>
+#include "MFRC522Emulator.h"
+#include "MFRC522MockTransport.h"
+#include "PiccTypes.h"
+#include <stdio.h>
+#include <string.h>
+
+#define SS_PIN 10
+#define RST_PIN 9
+#define IRQ_PIN 2
+
+static PiccField field;
+static MFRC522Emulator chip(field);
+static MFRC522 mfrc522(SS_PIN, RST_PIN);
+static int failures = 0;
+static byte readLength = 18;		// MIFARE_Read() returns the CRC_A unless the chip removes it
+
+struct Measurement {
+	uint64_t start;
+	MFRC522Emulator::Stats before;
+
+	Measurement() : start(HostSim::nanos()), before(chip.stats()) {}
+
+	void report(const char *name) {
+		const MFRC522Emulator::Stats &after = chip.stats();
+		printf("%-40s %9.1f us %5lu spi_bytes %4lu reads %4lu writes\n", name,
+			(HostSim::nanos() - start) / 1e3, after.spiBytes - before.spiBytes,
+			after.reads() - before.reads(), after.writes() - before.writes());
+	}
+};
+
+static void check(bool ok, const char *what) {
+	if (!ok) {
+		fprintf(stderr, "FAIL: %s\n", what);
+		failures++;
+	}
+}
+
+static void fill(VirtualPicc &picc) {
+	std::vector<uint8_t> &memory = picc.memory();
+	for (size_t i = 0; i < memory.size(); i++) {
+		memory[i] = (uint8_t)(i * 7 + picc.uid()[0]);
+	}
+}
+
+/**
+ * Detects, selects and reads block 4 of the cards in the field. The card selected must be one of them.
+ * reader is the MFRC522 on the SPI bus or one on another transport.
+ */
+template <class Reader>
+static void scan(Reader &reader, const char *label, VirtualPicc **cards, size_t count) {
+	char name[64];
+	for (size_t i = 0; i < count; i++) {
+		field.add(cards[i]);
+	}
+
+	Measurement request;
+	bool present = reader.PICC_IsNewCardPresent();
+	snprintf(name, sizeof(name), "%s IsNewCardPresent", label);
+	request.report(name);
+	check(present, name);
+
+	Measurement select;
+	bool selected = reader.PICC_ReadCardSerial();
+	snprintf(name, sizeof(name), "%s ReadCardSerial", label);
+	select.report(name);
+	check(selected, name);
+
+	VirtualPicc *card = nullptr;
+	for (size_t i = 0; i < count; i++) {
+		if (cards[i]->state() == VirtualPicc::ACTIVE) {
+			card = cards[i];
+		}
+	}
+	check(card && reader.uid.size == card->uidSize() && memcmp(reader.uid.uidByte, card->uid(), card->uidSize()) == 0,
+		"UID read back");
+
+	byte buffer[18];
+	byte size = sizeof(buffer);
+	Measurement read;
+	MFRC522::StatusCode status = reader.MIFARE_Read(4, buffer, &size);
+	snprintf(name, sizeof(name), "%s MIFARE_Read", label);
+	read.report(name);
+	check(status == MFRC522::STATUS_OK && size == readLength, name);
+	check(card && memcmp(buffer, &card->memory()[64], 16) == 0, "block content");
+
+	Measurement halt;
+	reader.PICC_HaltA();
+	snprintf(name, sizeof(name), "%s HaltA", label);
+	halt.report(name);
+	check(card && card->state() == VirtualPicc::HALT, "card halted");
+
+	for (size_t i = 0; i < count; i++) {
+		field.remove(cards[i]);
+	}
+}
+
+static void scan(const char *label, VirtualPicc **cards, size_t count) {
+	scan(mfrc522, label, cards, count);
+}
+
+/**
+ * Selects the only card in the field.
+ */
+static bool activate(VirtualPicc &card) {
+	field.add(&card);
+	bool ok = mfrc522.PICC_IsNewCardPresent() && mfrc522.PICC_ReadCardSerial();
+	check(ok && card.state() == VirtualPicc::ACTIVE, "card selected");
+	return ok;
+}
+
+static void classicWrite() {
+	static const uint8_t uid[] = {0x3C, 0x5D, 0x7E, 0x9F};
+	MifareClassic card(uid, sizeof(uid));
+	if (!activate(card)) {
+		return;
+	}
+	MFRC522::MIFARE_Key key;
+	memset(key.keyByte, 0xFF, sizeof(key.keyByte));
+	Measurement auth;
+	MFRC522::StatusCode status = mfrc522.PCD_Authenticate(MFRC522::PICC_CMD_MF_AUTH_KEY_A, 7, &key, &mfrc522.uid);
+	auth.report("classic PCD_Authenticate");
+	check(status == MFRC522::STATUS_OK, "classic authentication");
+
+	byte data[16];
+	for (byte i = 0; i < 16; i++) {
+		data[i] = (byte)(0xA0 + i);
+	}
+	Measurement write;
+	status = mfrc522.MIFARE_Write(5, data, 16);
+	write.report("classic MIFARE_Write");
+	check(status == MFRC522::STATUS_OK && memcmp(&card.memory()[80], data, 16) == 0, "classic write");
+
+	byte buffer[18];
+	byte size = sizeof(buffer);
+	status = mfrc522.MIFARE_Read(7, buffer, &size);
+	check(status == MFRC522::STATUS_OK && buffer[0] == 0 && buffer[6] == 0xFF && buffer[7] == 0x07, "trailer read");
+	status = mfrc522.MIFARE_Read(8, buffer, &size);
+	check(status != MFRC522::STATUS_OK, "read outside the authenticated sector refused");
+	mfrc522.PCD_StopCrypto1();
+	field.remove(&card);
+}
+
+/**
+ * Reads the 47 data blocks of a MIFARE Classic 1K three ways: an authentication and a MIFARE_Read() per block,
+ * as the examples do, MIFARE_ReadSector() per sector and one MIFARE_ReadRange().
+ */
+static void classicRead() {
+	static const uint8_t uid[] = {0x3C, 0x5D, 0x7E, 0xA0};
+	MifareClassic card(uid, sizeof(uid));
+	std::vector<uint8_t> &memory = card.memory();
+	uint8_t expected[47 * 16];
+	size_t used = 0;
+	for (byte block = 1; block < 64; block++) {
+		if (block % 4 != 3) {
+			for (byte i = 0; i < 16; i++) {
+				memory[block * 16 + i] = (uint8_t)(block * 13 + i);
+			}
+			memcpy(expected + used, &memory[block * 16], 16);
+			used += 16;
+		}
+	}
+	if (!activate(card)) {
+		return;
+	}
+	MFRC522::MIFARE_Key key;
+	memset(key.keyByte, 0xFF, sizeof(key.keyByte));
+	uint8_t data[sizeof(expected)];
+	bool ok = true;
+
+	Measurement perBlock;
+	used = 0;
+	for (byte block = 1; block < 64 && ok; block++) {
+		if (block % 4 != 3) {
+			byte buffer[18];
+			byte size = sizeof(buffer);
+			ok = mfrc522.PCD_Authenticate(MFRC522::PICC_CMD_MF_AUTH_KEY_A, block, &key, &mfrc522.uid) == MFRC522::STATUS_OK
+				&& mfrc522.MIFARE_Read(block, buffer, &size) == MFRC522::STATUS_OK;
+			memcpy(data + used, buffer, 16);
+			used += 16;
+		}
+	}
+	perBlock.report("classic 1k per block");
+	check(ok && memcmp(data, expected, sizeof(expected)) == 0, "classic 1k read per block");
+
+	Measurement perSector;
+	memset(data, 0, sizeof(data));
+	// Sector 0 without the manufacturer block
+	byte first[48];
+	ok = mfrc522.MIFARE_ReadSector(0, &key, first) == MFRC522::STATUS_OK;
+	memcpy(data, first + 16, 32);
+	for (byte sector = 1; sector < 16 && ok; sector++) {
+		ok = mfrc522.MIFARE_ReadSector(sector, &key, data + 32 + (sector - 1) * 48) == MFRC522::STATUS_OK;
+	}
+	perSector.report("classic 1k MIFARE_ReadSector");
+	check(ok && memcmp(data, expected, sizeof(expected)) == 0, "classic 1k read per sector");
+	check(memcmp(first, uid, 4) == 0, "manufacturer block");
+
+	Measurement range;
+	memset(data, 0, sizeof(data));
+	MFRC522::StatusCode status = mfrc522.MIFARE_ReadRange(1, 47, &key, data);
+	range.report("classic 1k MIFARE_ReadRange");
+	check(status == MFRC522::STATUS_OK && memcmp(data, expected, sizeof(expected)) == 0, "classic 1k read as one range");
+	check(card.authentications() == 47 + 16 + 16, "one authentication per sector");
+
+	byte sector[64];
+	status = mfrc522.MIFARE_ReadSector(1, &key, sector, true);
+	check(status == MFRC522::STATUS_OK && sector[48] == 0 && sector[54] == 0xFF && sector[55] == 0x07, "sector with its trailer");
+	status = mfrc522.MIFARE_ReadRange(60, 4, &key, data);
+	check(status != MFRC522::STATUS_OK, "range past the last block refused");
+	mfrc522.PCD_StopCrypto1();
+	field.remove(&card);
+}
+
+/**
+ * PCD_AuthenticateWithKeys() on a MIFARE Classic locked with the last of five site keys: without a hint every
+ * wrong key costs a timeout and a new SELECT, with the MFRC522KeyCache filled, or loaded from EEPROM after a
+ * restart, the right key is tried first.
+ */
+static void classicKeys() {
+	static const uint8_t uid[] = {0x3C, 0x5D, 0x7E, 0xA1};
+	static const byte siteKeys[5][6] = {
+		{0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+		{0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5},
+		{0xD3, 0xF7, 0xD3, 0xF7, 0xD3, 0xF7},
+		{0x4B, 0x79, 0x1B, 0xEA, 0x7B, 0xCC},
+		{0x51, 0x7A, 0xC0, 0x3E, 0x2D, 0x19}
+	};
+	MFRC522::MIFARE_Key keys[5];
+	for (byte i = 0; i < 5; i++) {
+		memcpy(keys[i].keyByte, siteKeys[i], 6);
+	}
+	MifareClassic card(uid, sizeof(uid));
+	memcpy(&card.memory()[MifareClassic::trailerOf(1) * 16], siteKeys[4], 6);
+	MFRC522KeyCache cache;
+	mfrc522.PCD_SetKeyCache(&cache);
+
+	const char *labels[] = {"classic keys no hint", "classic keys cached", "classic keys from eeprom"};
+	for (byte pass = 0; pass < 3; pass++) {
+		if (pass == 2) {
+			// Power cycle: the hints come back from the EEPROM
+			cache.save(EEPROM, 0);
+			MFRC522KeyCache restarted;
+			check(restarted.load(EEPROM, 0) && restarted.count() == 1, "key cache loaded");
+			cache = restarted;
+		}
+		if (!activate(card)) {
+			break;
+		}
+		unsigned long timeouts = chip.stats().timerExpiries;
+		byte keyIndex = 0xFF;
+		Measurement auth;
+		MFRC522::StatusCode status = mfrc522.PCD_AuthenticateWithKeys(MFRC522::PICC_CMD_MF_AUTH_KEY_A, 5, keys, 5,
+			&mfrc522.uid, &keyIndex);
+		auth.report(labels[pass]);
+		check(status == MFRC522::STATUS_OK && keyIndex == 4, "site key found");
+		check(chip.stats().timerExpiries - timeouts == (pass == 0 ? 4u : 0u), "wrong keys tried only without a hint");
+		mfrc522.PICC_HaltA();
+		mfrc522.PCD_StopCrypto1();
+		field.remove(&card);
+	}
+	unsigned long writes = EEPROM.writes();
+	cache.save(EEPROM, 0);
+	check(EEPROM.writes() == writes, "unchanged key cache not written again");
+
+	// Two cards in turn: their order changes, what is stored does not
+	MFRC522::Uid first = {};
+	MFRC522::Uid second = {};
+	first.size = second.size = 4;
+	memcpy(first.uidByte, uid, 4);
+	memcpy(second.uidByte, uid, 4);
+	second.uidByte[3] ^= 0xFF;
+	cache.remember(&second, 1, 2);
+	cache.save(EEPROM, 0);
+	writes = EEPROM.writes();
+	for (byte turn = 0; turn < 10; turn++) {
+		cache.find(turn & 1 ? &first : &second, 1);
+		cache.save(EEPROM, 0);
+	}
+	check(EEPROM.writes() == writes && cache.find(&second, 1) == 2, "key cache order not written");
+
+	// A UID too short for an entry is neither looked up nor stored
+	MFRC522::Uid shortUid = {};
+	shortUid.size = 2;
+	byte count = cache.count();
+	cache.remember(&shortUid, 1, 0);
+	check(cache.find(&shortUid, 1) == MFRC522KeyCache::NO_HINT && cache.count() == count, "short UID not cached");
+	mfrc522.PCD_SetKeyCache(nullptr);
+
+	// The longest list, the site key last
+	static MFRC522::MIFARE_Key manyKeys[255];
+	memcpy(manyKeys[254].keyByte, siteKeys[4], 6);
+	if (activate(card)) {
+		byte keyIndex = 0;
+		MFRC522::StatusCode status = mfrc522.PCD_AuthenticateWithKeys(MFRC522::PICC_CMD_MF_AUTH_KEY_A, 5, manyKeys, 255,
+			&mfrc522.uid, &keyIndex);
+		check(status == MFRC522::STATUS_OK && keyIndex == 254, "site key last of 255");
+		mfrc522.PICC_HaltA();
+		mfrc522.PCD_StopCrypto1();
+		field.remove(&card);
+	}
+}
+
+static void ultralightWrite(MifareUltralight::Type type, const char *label) {
+	static const uint8_t uid[] = {0x04, 0x51, 0x62, 0x73, 0x84, 0x95, 0xA6};
+	MifareUltralight card(uid, type);
+	if (!activate(card)) {
+		return;
+	}
+	byte page[4] = {0xDE, 0xAD, 0xBE, 0xEF};
+	char name[64];
+	Measurement write;
+	MFRC522::StatusCode status = mfrc522.MIFARE_Ultralight_Write(4, page, 4);
+	snprintf(name, sizeof(name), "%s Ultralight_Write", label);
+	write.report(name);
+	check(status == MFRC522::STATUS_OK && memcmp(&card.memory()[16], page, 4) == 0, name);
+
+	byte buffer[18];
+	byte size = sizeof(buffer);
+	status = mfrc522.MIFARE_Read(0, buffer, &size);
+	check(status == MFRC522::STATUS_OK && memcmp(buffer, uid, 3) == 0 && memcmp(buffer + 4, uid + 3, 4) == 0,
+		"UID pages");
+	status = mfrc522.MIFARE_Read((byte)card.pages(), buffer, &size);
+	check(status != MFRC522::STATUS_OK, "read past the last page refused");
+	field.remove(&card);
+}
+
+/**
+ * A READ with the CRC_A calculated here through PCD_TransceiveData(), after a MIFARE_Read() that had the chip add it.
+ * The raw frame must go out and come back without TxCRCEn and RxCRCEn.
+ */
+static void rawFrame() {
+	static const uint8_t uid[] = {0x04, 0x51, 0x62, 0x73, 0x84, 0x95, 0xA8};
+	MifareUltralight card(uid, MifareUltralight::ULTRALIGHT);
+	if (!activate(card)) {
+		return;
+	}
+	byte buffer[18];
+	byte size = sizeof(buffer);
+	MFRC522::StatusCode status = mfrc522.MIFARE_Read(0, buffer, &size);
+	check(status == MFRC522::STATUS_OK && size == 16, "hardware crc READ");
+	byte command[4] = {MFRC522::PICC_CMD_MF_READ, 0};
+	MFRC522::CalculateCRC_A(command, 2, &command[2]);
+	size = sizeof(buffer);
+	status = mfrc522.PCD_TransceiveData(command, sizeof(command), buffer, &size, nullptr, 0, true);
+	check(status == MFRC522::STATUS_OK && size == 18 && memcmp(buffer, uid, 3) == 0, "raw READ with its own CRC_A");
+	check((chip.peek(MFRC522::TxModeReg >> 1) & 0x80) == 0 && (chip.peek(MFRC522::RxModeReg >> 1) & 0x80) == 0,
+		"raw READ without the CRC of the chip");
+	field.remove(&card);
+}
+
+/**
+ * Reads all pages of the card with MIFARE_Read() four at a time, as the examples do, and with
+ * MIFARE_Ultralight_ReadPages(), FAST_READ on the NTAG216 and READ on the Ultralight.
+ */
+static void ultralightRead(MifareUltralight::Type type, const char *label) {
+	static const uint8_t uid[] = {0x04, 0x51, 0x62, 0x73, 0x84, 0x95, 0xA7};
+	MifareUltralight card(uid, type);
+	fill(card);
+	if (!activate(card)) {
+		return;
+	}
+	byte lastPage = (byte)(card.pages() - 1);
+	uint8_t data[231 * 4];
+	char name[64];
+	bool ok = true;
+
+	Measurement perRead;
+	for (uint16_t page = 0; page <= lastPage && ok; page += 4) {
+		byte buffer[18];
+		byte size = sizeof(buffer);
+		ok = mfrc522.MIFARE_Read((byte)page, buffer, &size) == MFRC522::STATUS_OK;
+		memcpy(data + page * 4, buffer, page + 4u <= lastPage + 1u ? 16 : (lastPage + 1 - page) * 4);
+	}
+	snprintf(name, sizeof(name), "%s MIFARE_Read loop", label);
+	perRead.report(name);
+	check(ok && memcmp(data, card.memory().data(), card.memory().size()) == 0, name);
+
+	unsigned long frames = chip.stats().framesSent;
+	memset(data, 0, sizeof(data));
+	Measurement pages;
+	MFRC522::StatusCode status = mfrc522.MIFARE_Ultralight_ReadPages(0, lastPage, data);
+	snprintf(name, sizeof(name), "%s Ultralight_ReadPages", label);
+	pages.report(name);
+	check(status == MFRC522::STATUS_OK && memcmp(data, card.memory().data(), card.memory().size()) == 0, name);
+	if (type == MifareUltralight::NTAG216) {
+		check(chip.stats().framesSent - frames == 1 + 4, "ntag216 read with FAST_READ");
+	}
+
+	status = mfrc522.MIFARE_Ultralight_ReadPages(5, 6, data);
+	check(status == MFRC522::STATUS_OK && memcmp(data, &card.memory()[20], 8) == 0, "two pages");
+	status = mfrc522.MIFARE_Ultralight_ReadPages(0, (byte)card.pages(), data);
+	check(status != MFRC522::STATUS_OK, "pages past the last refused");
+	field.remove(&card);
+}
+
+/**
+ * An ISO/IEC 14443-4 card that answers an APDU with its data and 9000.
+ */
+class EchoCard : public IsoDepPicc {
+public:
+	EchoCard(const uint8_t *uid, uint8_t uidSize, const uint8_t *ats = nullptr, uint8_t atsLength = 0)
+		: IsoDepPicc(uid, uidSize, ats, atsLength) {}
+
+protected:
+	void apdu(const uint8_t *command, size_t length, std::vector<uint8_t> &response) override {
+		response.assign(command, command + length);
+		response.push_back(0x90);
+		response.push_back(0x00);
+	}
+};
+
+/**
+ * An EchoCard that agrees to any rate TA(1) offers but only understands 106kbit/s.
+ */
+class SlowCard : public EchoCard {
+public:
+	SlowCard(const uint8_t *uid, uint8_t uidSize, const uint8_t *ats, uint8_t atsLength)
+		: EchoCard(uid, uidSize, ats, atsLength) {}
+
+protected:
+	bool command(const Iso14443::Frame &request, Iso14443::Frame &reply) override {
+		return request.rate == Iso14443::RATE_106 && EchoCard::command(request, reply);
+	}
+};
+
+/**
+ * Activates card with MFRC522Extended, checks the bit rates the MFRC522 ended up with, PCD to PICC and back, and sends
+ * APDUs through TCL_Transceive() of 16 bytes and of 200. The long ones stream through the FIFO (PCD_TransceiveStream())
+ * in both directions.
+ */
+static void isoDep(MFRC522Extended &extended, const char *label, EchoCard &card, byte txRate, byte rxRate) {
+	char name[64];
+	field.add(&card);
+	bool ok = extended.PICC_IsNewCardPresent() && extended.PICC_ReadCardSerial();
+	snprintf(name, sizeof(name), "%s activated", label);
+	check(ok && card.layer4(), name);
+	check(card.fsd() == MFRC522_TCL_FSD, "FSD announced with RATS");
+	snprintf(name, sizeof(name), "%s bit rates", label);
+	check(((chip.peek(MFRC522::TxModeReg >> 1) >> 4) & 0x03) == txRate
+		&& ((chip.peek(MFRC522::RxModeReg >> 1) >> 4) & 0x03) == rxRate, name);
+	check(extended.tag.ats.size == card.ats()[0] && extended.tag.ats.receiveBitRate == txRate
+		&& extended.tag.ats.sendBitRate == rxRate, "ATS and bit rates kept in tag");
+
+	static const byte lengths[] = {16, 200};
+	unsigned long apdus = card.apdus();
+	for (byte length : lengths) {
+		byte command[200];
+		for (byte i = 0; i < length; i++) {
+			command[i] = (byte)(i * 3 + 1);
+		}
+		byte response[MFRC522_TCL_FSD];
+		byte responseSize = sizeof(response) - 4;
+		snprintf(name, sizeof(name), "%s %u byte apdu", label, length);
+		Measurement exchange;
+		MFRC522::StatusCode status = extended.TCL_Transceive(&extended.tag, command, length, response, &responseSize);
+		exchange.report(name);
+		check(status == MFRC522::STATUS_OK && responseSize == length + 2 && memcmp(response, command, length) == 0
+			&& response[length] == 0x90 && response[length + 1] == 0x00, name);
+	}
+	check(card.apdus() - apdus == 2, "both APDUs answered");
+	check(chip.peek(MFRC522::WaterLevelReg >> 1) == 0x08, "water level back at its reset value");
+	extended.TCL_Deselect(&extended.tag);
+	field.remove(&card);
+}
+
+static void isoDep() {
+	static const uint8_t uid[] = {0x08, 0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0, 0x11};
+	// TL, T0 (TA, TB, TC, FSC 256), TA, TB, TC. TA 77: 212 to 848kbit/s both ways, B1: 212 or 424 to the PCD,
+	// 212 to the PICC, the same D only. 71: up to 848 to the PCD, 212 to the PICC.
+	static const uint8_t anyRate[] = {0x05, 0x78, 0x77, 0x70, 0x02};
+	static const uint8_t sameD[] = {0x05, 0x78, 0xB1, 0x70, 0x02};
+	static const uint8_t fastBack[] = {0x05, 0x78, 0x71, 0x70, 0x02};
+	static const uint8_t noCid[] = {0x05, 0x78, 0x77, 0x70, 0x00};		// TC 00: no CID, no NAD
+	static const uint8_t smallFrames[] = {0x05, 0x75, 0x80, 0x70, 0x02};	// FSC 64: the long APDU is chained
+	MFRC522Extended extended(SS_PIN, RST_PIN);
+	extended.PCD_Init();
+	EchoCard plain(uid, sizeof(uid));
+	isoDep(extended, "isodep", plain, 0, 0);
+	EchoCard small(uid, sizeof(uid), smallFrames, sizeof(smallFrames));
+	isoDep(extended, "isodep FSC 64", small, 0, 0);
+
+	// PPS to the fastest rates the card offers
+	extended.PICC_SetBitRateNegotiation(true);
+	EchoCard fast(uid, sizeof(uid), anyRate, sizeof(anyRate));
+	isoDep(extended, "isodep 848k", fast, 3, 3);
+	EchoCard same(uid, sizeof(uid), sameD, sizeof(sameD));
+	isoDep(extended, "isodep same D", same, 1, 1);
+	EchoCard asymmetric(uid, sizeof(uid), fastBack, sizeof(fastBack));
+	isoDep(extended, "isodep 212k/848k", asymmetric, 1, 3);
+	check(chip.peek(MFRC522::ModWidthReg >> 1) == 0x15, "modulation width of the rate sent at");
+	EchoCard withoutCid(uid, sizeof(uid), noCid, sizeof(noCid));
+	isoDep(extended, "isodep no CID", withoutCid, 3, 3);
+	SlowCard slow(uid, sizeof(uid), anyRate, sizeof(anyRate));
+	isoDep(extended, "isodep fallback", slow, 0, 0);
+	extended.PICC_SetBitRateNegotiation(true, MFRC522Extended::BITRATE_424KBITS);
+	isoDep(extended, "isodep 424k", fast, 2, 2);
+	extended.PICC_SetBitRateNegotiation(false);
+}
+
+static void irqPinFalling() {
+	mfrc522.PCD_TransceiveInterrupt();
+}
+
+/**
+ * PICC_Inventory() with count cards in the field, which must all be found and halted.
+ * The UIDs share their first bytes, so the anticollision has to go past the first byte.
+ */
+static void inventory(const char *label, byte count) {
+	std::vector<VirtualPicc *> cards;
+	for (byte i = 0; i < count; i++) {
+		if (i % 3 == 2) {
+			const uint8_t uid[] = {0x04, 0x5A, (uint8_t)(i * 37), 0x10, 0x20, i, 0x80};
+			cards.push_back(new VirtualPicc(uid, sizeof(uid), 0x00, 64));
+		} else {
+			const uint8_t uid[] = {0x5A, (uint8_t)(i * 37), (uint8_t)(i ^ 0x33), 0x2E};
+			cards.push_back(new VirtualPicc(uid, sizeof(uid), 0x08, 64));
+		}
+		field.add(cards.back());
+	}
+
+	char name[64];
+	snprintf(name, sizeof(name), "%s %u cards", label, count);
+	MFRC522::Uid uids[16];
+	Measurement sweep;
+	byte found = mfrc522.PICC_Inventory(uids, sizeof(uids) / sizeof(uids[0]));
+	sweep.report(name);
+	printf("%-40s %9.1f cards_per_second\n", name, found / ((HostSim::nanos() - sweep.start) / 1e9));
+	check(found == count, name);
+	for (VirtualPicc *card : cards) {
+		bool listed = false;
+		for (byte i = 0; i < found; i++) {
+			listed |= uids[i].size == card->uidSize() && memcmp(uids[i].uidByte, card->uid(), card->uidSize()) == 0;
+		}
+		check(listed && card->state() == VirtualPicc::HALT, "card found and halted by the inventory");
+		field.remove(card);
+		delete card;
+	}
+}
+
+/**
+ * Calls PICC_PollNewCardPresent() until it has an answer, reports the longest call and the number of calls.
+ */
+static MFRC522::StatusCode pollNewCard(const char *label, VirtualPicc *card) {
+	if (card) {
+		field.add(card);
+	}
+	Measurement total;
+	uint64_t longest = 0;
+	unsigned long calls = 0;
+	MFRC522::StatusCode status;
+	do {
+		uint64_t start = HostSim::nanos();
+		status = mfrc522.PICC_PollNewCardPresent();
+		uint64_t took = HostSim::nanos() - start;
+		longest = took > longest ? took : longest;
+		calls++;
+		delayMicroseconds(100);		// The rest of loop()
+	} while (status == MFRC522::STATUS_PENDING && calls < 10000);
+	total.report(label);
+	char name[64];
+	snprintf(name, sizeof(name), "%s longest call", label);
+	printf("%-40s %9.1f us %5lu calls\n", name, longest / 1e3, calls);
+	check(longest < 1000000, "no call of PICC_PollNewCardPresent() waits for the PICC");
+	if (card) {
+		check(status == MFRC522::STATUS_OK && mfrc522.PICC_ReadCardSerial()
+			&& memcmp(mfrc522.uid.uidByte, card->uid(), card->uidSize()) == 0, "card found asynchronously");
+		mfrc522.PICC_HaltA();
+		field.remove(card);
+	} else {
+		check(status == MFRC522::STATUS_TIMEOUT, "no card in an empty field, asynchronously");
+	}
+	return status;
+}
+
+/**
+ * PICC_PollCardEvent() for ten seconds of an empty field, then until a card put on the reader is read and
+ * until it is reported removed. Reports the REQAs per second while idle and how long the events took.
+ */
+static void pollEvents(const char *label, VirtualPicc *card, uint16_t maxPauseMillis) {
+	char name[64];
+	mfrc522.PICC_SetIdlePolling(maxPauseMillis);
+	unsigned long framesSent = chip.stats().framesSent;
+	Measurement idle;
+	bool quiet = true;
+	while (HostSim::nanos() - idle.start < 10000000000ULL) {
+		quiet &= mfrc522.PICC_PollCardEvent() == MFRC522::EVENT_NONE;
+		delayMicroseconds(100);		// The rest of loop()
+	}
+	snprintf(name, sizeof(name), "%s idle 10s", label);
+	idle.report(name);
+	printf("%-40s %9.1f requests_per_second\n", name, (chip.stats().framesSent - framesSent) / 10.0);
+	check(quiet, "no event in an empty field");
+
+	field.add(card);
+	uint64_t arrived = HostSim::nanos();
+	MFRC522::PICC_Event event = MFRC522::EVENT_NONE;
+	while (event == MFRC522::EVENT_NONE && HostSim::nanos() - arrived < 5000000000ULL) {
+		event = mfrc522.PICC_PollCardEvent();
+		delayMicroseconds(100);
+	}
+	snprintf(name, sizeof(name), "%s card read after", label);
+	printf("%-40s %9.1f ms\n", name, (HostSim::nanos() - arrived) / 1e6);
+	check(event == MFRC522::EVENT_NEW_CARD && memcmp(mfrc522.uid.uidByte, card->uid(), card->uidSize()) == 0
+		&& card->state() == VirtualPicc::HALT, "card read and halted by PICC_PollCardEvent()");
+
+	// Held on the reader for a second, then taken away
+	uint64_t held = HostSim::nanos();
+	while (event != MFRC522::EVENT_NONE || HostSim::nanos() - held < 1000000000ULL) {
+		event = mfrc522.PICC_PollCardEvent();
+		check(event == MFRC522::EVENT_NONE, "card on the reader read once");
+		delayMicroseconds(100);
+	}
+	field.remove(card);
+	uint64_t removed = HostSim::nanos();
+	while (event == MFRC522::EVENT_NONE && HostSim::nanos() - removed < 5000000000ULL) {
+		event = mfrc522.PICC_PollCardEvent();
+		delayMicroseconds(100);
+	}
+	snprintf(name, sizeof(name), "%s removal seen after", label);
+	printf("%-40s %9.1f ms\n", name, (HostSim::nanos() - removed) / 1e6);
+	check(event == MFRC522::EVENT_CARD_REMOVED && memcmp(mfrc522.uid.uidByte, card->uid(), card->uidSize()) == 0,
+		"removal reported by PICC_PollCardEvent()");
+	mfrc522.PICC_SetIdlePolling(0);
+}
+
+int main() {
+	HostSim::reset();
+	chip.attach(SS_PIN, RST_PIN, IRQ_PIN);
+	SPI.begin();
+
+	Measurement init;
+	mfrc522.PCD_Init();
+	init.report("PCD_Init");
+	check(mfrc522.PCD_ReadRegister(MFRC522::VersionReg) == 0x92, "version register");
+	check(field.powered(), "antenna on");
+
+	Measurement idle;
+	bool present = mfrc522.PICC_IsNewCardPresent();
+	idle.report("empty IsNewCardPresent");
+	check(!present, "no card in an empty field");
+
+	static const uint8_t uid4[] = {0xFA, 0x89, 0x6C, 0x2E};
+	static const uint8_t uid7[] = {0x04, 0x3A, 0x91, 0x52, 0xB6, 0x4D, 0x80};
+	static const uint8_t uid10[] = {0x04, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99};
+	static const uint8_t uid4b[] = {0x6A, 0x6E, 0x51, 0x83};
+	VirtualPicc single(uid4, sizeof(uid4), 0x08, 1024);
+	VirtualPicc doubleSize(uid7, sizeof(uid7), 0x00, 1024);
+	VirtualPicc tripleSize(uid10, sizeof(uid10), 0x20, 256);
+	VirtualPicc other(uid4b, sizeof(uid4b), 0x08, 1024);
+	VirtualPicc *cards[] = {&single, &doubleSize, &tripleSize, &other};
+	for (VirtualPicc *card : cards) {
+		fill(*card);
+	}
+
+	scan("uid4", &cards[0], 1);
+	scan("uid7", &cards[1], 1);
+	scan("uid10", &cards[2], 1);
+	VirtualPicc *pair[] = {&single, &other};
+	scan("two cards", pair, 2);
+	check(chip.stats().collisions > 0, "collision seen with two cards");
+
+	classicWrite();
+	classicRead();
+	classicKeys();
+	ultralightWrite(MifareUltralight::ULTRALIGHT, "ultralight");
+	ultralightWrite(MifareUltralight::NTAG216, "ntag216");
+	ultralightRead(MifareUltralight::ULTRALIGHT, "ultralight");
+	ultralightRead(MifareUltralight::NTAG216, "ntag216");
+
+	// The software CRC_A against the coprocessor, ISO/IEC 14443-3 annex B: 00 00 gives A0 1E
+	byte crcData[] = {0x00, 0x00, 0x93, 0x70, 0xFA, 0x89, 0x6C, 0x2E, 0x31};
+	byte chipCrc[2];
+	byte softwareCrc[2];
+	MFRC522::CalculateCRC_A(crcData, 2, softwareCrc);
+	check(softwareCrc[0] == 0xA0 && softwareCrc[1] == 0x1E, "CRC_A of 00 00");
+	for (byte length = 0; length <= sizeof(crcData); length++) {
+		MFRC522::CalculateCRC_A(crcData, length, softwareCrc);
+		check(mfrc522.PCD_CalculateCRC(crcData, length, chipCrc) == MFRC522::STATUS_OK
+			&& memcmp(chipCrc, softwareCrc, 2) == 0, "software CRC_A equals the coprocessor's");
+	}
+
+	// Again with the shadow copies of the configuration registers and the software CRC
+	mfrc522.PCD_SetRegisterCache(true);
+	mfrc522.PCD_SetSoftwareCRC(true);
+	mfrc522.PICC_IsNewCardPresent();		// Fills the cache
+	Measurement cachedIdle;
+	present = mfrc522.PICC_IsNewCardPresent();
+	cachedIdle.report("cached empty IsNewCardPresent");
+	check(!present, "no card in an empty field, cached");
+	scan("cached uid4", &cards[0], 1);
+	scan("cached uid7", &cards[1], 1);
+	scan("cached two cards", pair, 2);
+	classicWrite();
+	mfrc522.PCD_SetAntennaGain(MFRC522::RxGain_max);
+	check(mfrc522.PCD_GetAntennaGain() == MFRC522::RxGain_max && (chip.peek(MFRC522::RFCfgReg >> 1) & 0x70) == MFRC522::RxGain_max,
+		"antenna gain through the cache");
+
+	// Again with TxCRCEn and RxCRCEn instead of the CRC_A calculated here
+	mfrc522.PCD_SetHardwareCRC(true);
+	readLength = 16;
+	scan("hardware crc uid4", &cards[0], 1);
+	scan("hardware crc uid7", &cards[1], 1);
+	scan("hardware crc uid10", &cards[2], 1);
+	scan("hardware crc two cards", pair, 2);
+	classicWrite();
+	ultralightWrite(MifareUltralight::ULTRALIGHT, "hardware crc ultralight");
+	ultralightWrite(MifareUltralight::NTAG216, "hardware crc ntag216");
+	rawFrame();
+	mfrc522.PCD_SetHardwareCRC(false);
+	check((chip.peek(MFRC522::TxModeReg >> 1) & 0x80) == 0 && (chip.peek(MFRC522::RxModeReg >> 1) & 0x80) == 0,
+		"CRC of the chip off again");
+
+	// Asynchronous REQA, polling ComIrqReg and then waiting for the IRQ pin
+	pollNewCard("async empty poll", nullptr);
+	pollNewCard("async uid4 poll", &single);
+	pinMode(IRQ_PIN, INPUT_PULLUP);
+	attachInterrupt(digitalPinToInterrupt(IRQ_PIN), irqPinFalling, FALLING);
+	mfrc522.PCD_SetTransceiveInterrupt(true);
+	pollNewCard("async irq empty poll", nullptr);
+	pollNewCard("async irq uid4 poll", &single);
+	mfrc522.PCD_SetTransceiveInterrupt(false);
+	detachInterrupt(digitalPinToInterrupt(IRQ_PIN));
+
+	// Every card in the field in one sweep
+	for (byte count = 1; count <= 16; count++) {
+		inventory("inventory", count);
+	}
+	pollEvents("events", &single, 0);
+
+	// REQA, WUPA and HLTA wait 1ms instead of the 25ms timer
+	mfrc522.PCD_SetRequestWindow(1000);
+	Measurement windowIdle;
+	present = mfrc522.PICC_IsNewCardPresent();
+	windowIdle.report("windowed empty IsNewCardPresent");
+	check(!present, "no card in an empty field, request window");
+	readLength = 18;
+	scan("windowed uid4", &cards[0], 1);
+	scan("windowed uid7", &cards[1], 1);
+	scan("windowed two cards", pair, 2);
+	classicWrite();
+	pollNewCard("windowed async empty poll", nullptr);
+	pollNewCard("windowed async uid4 poll", &single);
+	inventory("windowed inventory", 4);
+	inventory("windowed inventory", 16);
+	pollEvents("windowed events", &single, 0);
+	pollEvents("idle polling events", &single, 100);
+
+	// The longest pause: the doubling stops at 65535ms instead of wrapping to 0
+	mfrc522.PICC_SetIdlePolling(65535);
+	uint64_t idleStart = HostSim::nanos();
+	unsigned long framesBefore = 0;
+	while (HostSim::nanos() - idleStart < 400000000000ULL) {
+		if (framesBefore == 0 && HostSim::nanos() - idleStart >= 200000000000ULL) {
+			framesBefore = chip.stats().framesSent;
+		}
+		mfrc522.PICC_PollCardEvent();
+		delay(1);
+	}
+	check(chip.stats().framesSent - framesBefore <= 4, "idle pause held at 65535ms");
+	mfrc522.PICC_SetIdlePolling(0);
+	mfrc522.PCD_SetRequestWindow(0);
+	check(chip.peek(MFRC522::TReloadRegH >> 1) == 0x03 && chip.peek(MFRC522::TReloadRegL >> 1) == 0xE8, "25ms timer back");
+
+	// The protocol code on the in-memory transport: the same register accesses, no bus time
+	MFRC522Base<MFRC522MockTransport> mock(MFRC522MockTransport(chip), RST_PIN);
+	Measurement mockInit;
+	mock.PCD_Init();
+	mockInit.report("mock PCD_Init");
+	check(mock.PCD_ReadRegister(MFRC522::VersionReg) == 0x92, "version register, mock transport");
+	readLength = 18;
+	scan(mock, "mock uid4", &cards[0], 1);
+	scan(mock, "mock uid7", &cards[1], 1);
+	scan(mock, "mock uid10", &cards[2], 1);
+	scan(mock, "mock two cards", pair, 2);
+
+	// ISO/IEC 14443-4 frames larger than the FIFO, last as it initializes the chip again
+	isoDep();
+
+	const MFRC522Emulator::Stats &stats = chip.stats();
+	printf("total_spi_bytes %lu\n", stats.spiBytes);
+	printf("total_register_reads %lu\n", stats.reads());
+	printf("total_register_writes %lu\n", stats.writes());
+	printf("frames_sent %lu\n", stats.framesSent);
+	printf("frames_received %lu\n", stats.framesReceived);
+	printf("timer_expiries %lu\n", stats.timerExpiries);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,240 @@
+/**
+ * Load test: a crowd of students scanning their cards, measured in scans per minute.
+ *
+ * The students of a roster CSV (tools/roster_sample.py writes one) get a virtual card each, of a
+ * type fitting the UID (createPicc()). They arrive as a Poisson process and hold the card on the
+ * reader for a while, several cards may lie on it at once. The sketch, built with the same roster,
+ * runs loop() until everybody has been and the records are sent. A student is counted when the
+ * row with the name appears on the serial line.
+ *
+ * With --driver the sketch is left out: a bare loop of PICC_IsNewCardPresent(),
+ * PICC_ReadCardSerial() and PICC_HaltA() reads the cards, to measure the driver alone.
+ *
+ * usage: load_bench --roster students.csv [--per-minute 40] [--dwell-ms 1500] [--single-file]
+ *                   [--seed 1] [--driver] [--min-scans-per-minute N] [--max-missed N]
+ * With a limit given, the exit code is 1 when the run does not meet it.
+ */
+#include <Arduino.h>
+#include <HostSim.h>
+#include <MFRC522.h>
+#include "MFRC522Emulator.h"
+#include "PiccTypes.h"
+#include "CardTimeline.h"
+#include "RecordQueue.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+
+extern MFRC522 mfrc522;		// The sketch's reader
+
+struct Student {
+	uint8_t uid[10];
+	uint8_t uidSize;
+	std::string name;
+	VirtualPicc *card;
+	uint64_t scanned;		// When the student was counted, 0 if not
+};
+
+static bool parseUid(const std::string &text, Student &student) {
+	student.uidSize = 0;
+	std::string digits;
+	for (char c : text) {
+		if (c != ':' && c != '-' && c != ' ') {
+			digits += c;
+		}
+	}
+	if (digits.size() % 2 || digits.size() / 2 > sizeof(student.uid)) {
+		return false;
+	}
+	for (size_t i = 0; i < digits.size(); i += 2) {
+		student.uid[student.uidSize++] = (uint8_t)strtoul(digits.substr(i, 2).c_str(), nullptr, 16);
+	}
+	return student.uidSize == 4 || student.uidSize == 7 || student.uidSize == 10;
+}
+
+/**
+ * Reads uid and name, the first two columns of the roster.
+ */
+static bool readRoster(const char *path, std::vector<Student> &students) {
+	FILE *f = fopen(path, "r");
+	if (!f) {
+		return false;
+	}
+	char line[512];
+	bool header = true;
+	while (fgets(line, sizeof(line), f)) {
+		if (header) {
+			header = false;
+			continue;
+		}
+		char *comma = strchr(line, ',');
+		if (!comma) {
+			continue;
+		}
+		char *end = strchr(comma + 1, ',');
+		Student student = Student();
+		if (!parseUid(std::string(line, comma), student)) {
+			fclose(f);
+			return false;
+		}
+		student.name.assign(comma + 1, end ? end : comma + 1 + strlen(comma + 1));
+		students.push_back(student);
+	}
+	fclose(f);
+	return !students.empty();
+}
+
+int main(int argc, char **argv) {
+	const char *rosterPath = nullptr;
+	double perMinute = 40;
+	double dwellMs = 1500;
+	bool singleFile = false;
+	unsigned long seed = 1;
+	bool driver = false;
+	double minPerMinute = 0;
+	long maxMissed = -1;
+	for (int i = 1; i < argc; i++) {
+		bool hasValue = i + 1 < argc;
+		if (strcmp(argv[i], "--single-file") == 0) {
+			singleFile = true;
+		} else if (strcmp(argv[i], "--driver") == 0) {
+			driver = true;
+		} else if (strcmp(argv[i], "--roster") == 0 && hasValue) {
+			rosterPath = argv[++i];
+		} else if (strcmp(argv[i], "--per-minute") == 0 && hasValue) {
+			perMinute = atof(argv[++i]);
+		} else if (strcmp(argv[i], "--dwell-ms") == 0 && hasValue) {
+			dwellMs = atof(argv[++i]);
+		} else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+			seed = strtoul(argv[++i], nullptr, 10);
+		} else if (strcmp(argv[i], "--min-scans-per-minute") == 0 && hasValue) {
+			minPerMinute = atof(argv[++i]);
+		} else if (strcmp(argv[i], "--max-missed") == 0 && hasValue) {
+			maxMissed = atol(argv[++i]);
+		} else {
+			fprintf(stderr, "unknown option %s\n", argv[i]);
+			return 2;
+		}
+	}
+	std::vector<Student> students;
+	if (!rosterPath || !readRoster(rosterPath, students)) {
+		fprintf(stderr, "need a roster CSV with valid UIDs, --roster\n");
+		return 2;
+	}
+
+	PiccField field;
+	MFRC522Emulator chip(field);
+	HostSim::reset();
+	chip.attach(10, 9);		// SS_PIN and RST_PIN of the sketch
+	CardTimeline timeline(field);
+
+	std::vector<VirtualPicc *> cards;
+	std::map<std::string, Student *> byName;
+	std::map<std::string, Student *> byUid;
+	for (size_t i = 0; i < students.size(); i++) {
+		Student &student = students[i];
+		student.card = createPicc(student.uid, student.uidSize, (unsigned)i);
+		cards.push_back(student.card);
+		byName[student.name] = &student;
+		byUid[std::string((const char *)student.uid, student.uidSize)] = &student;
+	}
+
+	if (driver) {
+		SPI.begin();
+		mfrc522.PCD_Init();
+	} else {
+		setup();
+	}
+	uint64_t start = HostSim::nanos();
+	uint64_t last = timeline.poissonArrivals(cards, start, perMinute, (uint64_t)(dwellMs * 1e6), singleFile, seed);
+	// Time to send the rows still queued when the last student has gone
+	uint64_t deadline = last + 60000000000ULL;
+
+	unsigned long counted = 0;
+	unsigned long duplicates = 0;
+	uint64_t lastScan = start;
+	size_t parsed = 0;
+	HostSim::resetStats();
+	chip.resetStats();
+	while (HostSim::nanos() < deadline) {
+		Student *scanned = nullptr;
+		if (driver) {
+			if (mfrc522.PICC_IsNewCardPresent() && mfrc522.PICC_ReadCardSerial()) {
+				std::map<std::string, Student *>::iterator it =
+					byUid.find(std::string((const char *)mfrc522.uid.uidByte, mfrc522.uid.size));
+				scanned = it == byUid.end() ? nullptr : it->second;
+				mfrc522.PICC_HaltA();
+			}
+		} else {
+			loop();
+			// New PLX-DAQ rows: DATA,DATE,TIME,<name>,...
+			const std::string &output = Serial.output();
+			size_t newline;
+			while ((newline = output.find('\n', parsed)) != std::string::npos) {
+				std::string row = output.substr(parsed, newline - parsed);
+				parsed = newline + 1;
+				if (row.compare(0, 15, "DATA,DATE,TIME,") == 0) {
+					std::string name = row.substr(15, row.find(',', 15) - 15);
+					std::map<std::string, Student *>::iterator it = byName.find(name);
+					scanned = it == byName.end() ? nullptr : it->second;
+				}
+			}
+		}
+		uint64_t now = HostSim::nanos();
+		if (scanned) {
+			if (scanned->scanned) {
+				duplicates++;
+			} else {
+				scanned->scanned = now;
+				counted++;
+				lastScan = now;
+			}
+		}
+		if (timeline.done() && (driver || (recordQueuePending() == 0 && Serial.busyUntil() <= now))) {
+			break;
+		}
+	}
+
+	double latencyMs = 0;
+	double maxLatencyMs = 0;
+	for (Student &student : students) {
+		if (student.scanned) {
+			double latency = (student.scanned - timeline.entered(student.card)) / 1e6;
+			latencyMs += latency;
+			maxLatencyMs = latency > maxLatencyMs ? latency : maxLatencyMs;
+		}
+	}
+	unsigned long missed = students.size() - counted;
+	double minutes = (lastScan - start) / 60e9;
+	double scansPerMinute = minutes > 0 ? counted / minutes : 0;
+
+	printf("mode %s\n", driver ? "driver" : "sketch");
+	printf("students %lu\n", (unsigned long)students.size());
+	printf("arrivals_per_minute %.1f\n", perMinute);
+	printf("scanned %lu\n", counted);
+	printf("missed %lu\n", missed);
+	printf("duplicates %lu\n", duplicates);
+	printf("scans_per_minute %.1f\n", scansPerMinute);
+	printf("mean_latency_ms %.1f\n", counted ? latencyMs / counted : 0.0);
+	printf("max_latency_ms %.1f\n", maxLatencyMs);
+	printf("collisions %lu\n", chip.stats().collisions);
+	printf("spi_bytes_per_scan %.0f\n", counted ? (double)chip.stats().spiBytes / counted : 0.0);
+
+	for (VirtualPicc *card : cards) {
+		delete card;
+	}
+
+	int result = 0;
+	if (minPerMinute > 0 && scansPerMinute < minPerMinute) {
+		fprintf(stderr, "FAIL: %.1f scans per minute, limit %.1f\n", scansPerMinute, minPerMinute);
+		result = 1;
+	}
+	if (maxMissed >= 0 && (long)missed > maxMissed) {
+		fprintf(stderr, "FAIL: %lu students missed, limit %ld\n", missed, maxMissed);
+		result = 1;
+	}
+	return result;
+}
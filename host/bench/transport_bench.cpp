@@ -0,0 +1,119 @@
+/**
+ * The MFRC522 driver on the I2C and UART transports against the register level emulator.
+ *
+ * Builds MFRC522Base<MFRC522I2CTransport> on the host Wire library and MFRC522Base<MFRC522UartTransport>
+ * on a serial port at 9600 Bd, the rate after reset. On each it runs PCD_Init() and reads the version,
+ * writes and reads back a register and the FIFO (48 bytes, more than one I2C transfer takes), then reads
+ * a card: PICC_IsNewCardPresent(), PICC_ReadCardSerial() and MIFARE_Read(). Reports per step the virtual
+ * time and the register reads and writes the chip saw.
+ *
+ * usage: transport_bench
+ * The exit code is 1 if a call fails or returns wrong data.
+ */
+#include <Arduino.h>
+#include <HostSim.h>
+#include <Wire.h>
+#include <MFRC522I2CTransport.h>
+#include <MFRC522UartTransport.h>
+#include "MFRC522Emulator.h"
+#include "MFRC522HostBuses.h"
+#include <stdio.h>
+#include <string.h>
+
+#define SS_PIN 10		// Not connected, the emulator only needs a pin to attach to
+#define RST_PIN 9
+#define I2C_ADDRESS 0x28
+
+static PiccField field;
+static MFRC522Emulator chip(field);
+static int failures = 0;
+
+struct Measurement {
+	uint64_t start;
+	MFRC522Emulator::Stats before;
+
+	Measurement() : start(HostSim::nanos()), before(chip.stats()) {}
+
+	void report(const char *name) {
+		const MFRC522Emulator::Stats &after = chip.stats();
+		printf("%-32s %9.1f us %4lu reads %4lu writes\n", name, (HostSim::nanos() - start) / 1e3,
+			after.reads() - before.reads(), after.writes() - before.writes());
+	}
+};
+
+static void check(bool ok, const char *what) {
+	if (!ok) {
+		fprintf(stderr, "FAIL: %s\n", what);
+		failures++;
+	}
+}
+
+template <class Reader>
+static void run(Reader &reader, const char *label) {
+	char name[64];
+	HostSim::reset();
+	chip.attach(SS_PIN, RST_PIN);
+
+	Measurement init;
+	reader.PCD_Init();
+	snprintf(name, sizeof(name), "%s PCD_Init", label);
+	init.report(name);
+	check(reader.PCD_ReadRegister(MFRC522::VersionReg) == 0x92, name);
+
+	// One register, then the FIFO: all bytes of an access go to the same register
+	Measurement roundTrip;
+	reader.PCD_WriteRegister(MFRC522::TReloadRegL, 0x5A);
+	byte reload = reader.PCD_ReadRegister(MFRC522::TReloadRegL);
+	byte sent[48];
+	byte received[48];
+	for (byte index = 0; index < sizeof(sent); index++) {
+		sent[index] = (byte)(index * 37 + 1);
+	}
+	reader.PCD_WriteRegister(MFRC522::FIFOLevelReg, 0x80);
+	reader.PCD_WriteRegister(MFRC522::FIFODataReg, sizeof(sent), sent);
+	byte level = reader.PCD_ReadRegister(MFRC522::FIFOLevelReg);
+	reader.PCD_ReadRegister(MFRC522::FIFODataReg, sizeof(received), received);
+	snprintf(name, sizeof(name), "%s register round trip", label);
+	roundTrip.report(name);
+	check(reload == 0x5A && chip.peek(MFRC522::TReloadRegL >> 1) == 0x5A, name);
+	snprintf(name, sizeof(name), "%s FIFO round trip", label);
+	check(level == sizeof(sent) && memcmp(sent, received, sizeof(sent)) == 0 && chip.fifoLevel() == 0, name);
+	reader.PCD_WriteRegister(MFRC522::TReloadRegL, 0xE8);		// The 25ms of PCD_Init()
+
+	const byte uid[4] = {0x11, 0x22, 0x33, 0x44};
+	VirtualPicc card(uid, sizeof(uid), 0x08, 1024);
+	std::vector<uint8_t> &memory = card.memory();
+	for (size_t index = 0; index < memory.size(); index++) {
+		memory[index] = (uint8_t)(index * 7);
+	}
+	field.add(&card);
+	Measurement scan;
+	bool read = reader.PICC_IsNewCardPresent() && reader.PICC_ReadCardSerial();
+	byte buffer[18];
+	byte size = sizeof(buffer);
+	MFRC522::StatusCode status = reader.MIFARE_Read(4, buffer, &size);
+	snprintf(name, sizeof(name), "%s card read", label);
+	scan.report(name);
+	check(read && reader.uid.size == 4 && memcmp(reader.uid.uidByte, uid, 4) == 0, name);
+	check(status == MFRC522::STATUS_OK && memcmp(buffer, &memory[64], 16) == 0, "block content");
+	reader.PICC_HaltA();
+	field.remove(&card);
+	chip.detach();
+}
+
+int main() {
+	MFRC522I2CDevice i2cDevice(chip);
+	Wire.attachDevice(I2C_ADDRESS, &i2cDevice);
+	MFRC522_I2C i2c(MFRC522I2CTransport(I2C_ADDRESS), RST_PIN);
+	Wire.begin();
+	unsigned long transfers = Wire.transfers();
+	run(i2c, "i2c");
+	printf("i2c_transfers %lu\n", Wire.transfers() - transfers);
+	Wire.attachDevice(I2C_ADDRESS, nullptr);
+
+	MFRC522UartDevice serial(chip, 9600);
+	MFRC522_UART uart(MFRC522UartTransport(serial), RST_PIN);
+	run(uart, "uart");
+
+	return failures ? 1 : 0;
+}
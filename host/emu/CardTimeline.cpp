@@ -0,0 +1,64 @@
+/**
+ * Scripted card movements, see CardTimeline.h.
+ */
+#include "CardTimeline.h"
+#include <math.h>
+#include <random>
+
+CardTimeline::CardTimeline(PiccField &field) : _field(field) {
+	HostSim::addClockListener(this);
+}
+
+CardTimeline::~CardTimeline() {
+	HostSim::removeClockListener(this);
+}
+
+void CardTimeline::enter(uint64_t at, VirtualPicc *picc) {
+	_events.insert(std::make_pair(at, Event{picc, true}));
+}
+
+void CardTimeline::leave(uint64_t at, VirtualPicc *picc) {
+	_events.insert(std::make_pair(at, Event{picc, false}));
+}
+
+uint64_t CardTimeline::poissonArrivals(const std::vector<VirtualPicc *> &cards, uint64_t start, double perMinute,
+		uint64_t dwell, bool singleFile, uint32_t seed) {
+	// Exponential gaps from the raw generator, so a seed gives the same timeline everywhere
+	std::mt19937 generator(seed);
+	double meanGap = 60e9 / perMinute;
+	uint64_t arrival = start;
+	uint64_t readerFree = start;	// The card before has been taken away, for singleFile
+	uint64_t last = start;
+	for (VirtualPicc *picc : cards) {
+		double uniform = (generator() + 0.5) / 4294967296.0;
+		arrival += (uint64_t)(-log(uniform) * meanGap);
+		uint64_t at = singleFile && readerFree > arrival ? readerFree : arrival;
+		enter(at, picc);
+		leave(at + dwell, picc);
+		readerFree = at + dwell;
+		last = readerFree > last ? readerFree : last;
+	}
+	return last;
+}
+
+uint64_t CardTimeline::entered(const VirtualPicc *picc) const {
+	std::map<const VirtualPicc *, uint64_t>::const_iterator it = _entered.find(picc);
+	return it == _entered.end() ? UINT64_MAX : it->second;
+}
+
+uint64_t CardTimeline::nextEvent() {
+	return _events.empty() ? UINT64_MAX : _events.begin()->first;
+}
+
+void CardTimeline::clockAdvanced(uint64_t now) {
+	while (!_events.empty() && _events.begin()->first <= now) {
+		Event event = _events.begin()->second;
+		if (event.enter) {
+			_field.add(event.picc);
+			_entered[event.picc] = _events.begin()->first;
+		} else {
+			_field.remove(event.picc);
+		}
+		_events.erase(_events.begin());
+	}
+}
@@ -0,0 +1,52 @@
+/**
+ * Cards entering and leaving the reader's field at set points of the virtual clock.
+ *
+ * A load test scripts when each card is put on the reader and taken away again, for example
+ * students arriving at random (poissonArrivals()), and lets the sketch run.
+ */
+#ifndef CardTimeline_h
+#define CardTimeline_h
+
+#include <HostSim.h>
+#include <map>
+#include "VirtualPicc.h"
+
+class CardTimeline : public HostSim::ClockListener {
+public:
+	explicit CardTimeline(PiccField &field);
+	~CardTimeline();
+
+	void enter(uint64_t at, VirtualPicc *picc);
+	void leave(uint64_t at, VirtualPicc *picc);
+
+	/**
+	 * One card per student, arrivals a Poisson process of perMinute, each card held on the reader
+	 * for dwell ns. With singleFile a student waits until the card before has been taken away,
+	 * otherwise cards may lie on the reader together. Returns the time the last card leaves.
+	 */
+	uint64_t poissonArrivals(const std::vector<VirtualPicc *> &cards, uint64_t start, double perMinute,
+		uint64_t dwell, bool singleFile, uint32_t seed);
+
+	/**
+	 * When the card entered the field the last time, UINT64_MAX if it never did.
+	 */
+	uint64_t entered(const VirtualPicc *picc) const;
+
+	bool done() const { return _events.empty(); }
+
+	// HostSim::ClockListener
+	uint64_t nextEvent() override;
+	void clockAdvanced(uint64_t now) override;
+
+private:
+	struct Event {
+		VirtualPicc *picc;
+		bool enter;
+	};
+
+	PiccField &_field;
+	std::multimap<uint64_t, Event> _events;
+	std::map<const VirtualPicc *, uint64_t> _entered;
+};
+
+#endif
@@ -0,0 +1,99 @@
+/**
+ * ISO/IEC 14443 type A frames as they travel between the emulated MFRC522 and the virtual PICCs.
+ *
+ * A frame is a bit string, sent least significant bit of each byte first. Parity bits are not
+ * stored, they only count for the time a frame spends on air.
+ */
+#ifndef Iso14443_h
+#define Iso14443_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+namespace Iso14443 {
+
+// Carrier frequency and bit rates
+const uint64_t CARRIER_HZ = 13560000;
+enum BitRate { RATE_106 = 0, RATE_212 = 1, RATE_424 = 2, RATE_848 = 3 };
+
+/**
+ * Nanoseconds of count carrier periods.
+ */
+inline uint64_t carrierNs(uint64_t count) {
+	return count * 1000000000ULL / CARRIER_HZ;
+}
+
+/**
+ * Nanoseconds to send bits at the given rate, 128 carrier periods per bit at 106kbit/s.
+ */
+inline uint64_t bitsNs(uint64_t bits, uint8_t rate) {
+	return carrierNs(bits * (128u >> rate));
+}
+
+/**
+ * Frame delay time PICC to PCD: the card answers (n * 128 + 84) / fc after the end of the request,
+ * n = 9 for the commands up to SELECT and the minimum of all others.
+ */
+const uint64_t FDT_NS = (9 * 128 + 84) * 1000000000ULL / CARRIER_HZ;
+
+/**
+ * CRC_A of ISO/IEC 14443-3, preset 0x6363, low byte first on air.
+ */
+inline uint16_t crcA(const uint8_t *data, size_t length, uint16_t crc = 0x6363) {
+	for (size_t i = 0; i < length; i++) {
+		uint8_t b = data[i] ^ (uint8_t)crc;
+		b ^= b << 4;
+		crc = (crc >> 8) ^ ((uint16_t)b << 8) ^ ((uint16_t)b << 3) ^ (b >> 4);
+	}
+	return crc;
+}
+
+struct Frame {
+	std::vector<uint8_t> data;	// Partial last byte in the low bits
+	size_t bits = 0;
+	uint8_t rate = RATE_106;
+	bool encrypted = false;		// Sent with Crypto1 on (MIFARE Classic after authentication)
+
+	size_t bytes() const { return (bits + 7) / 8; }
+	bool complete() const { return bits % 8 == 0; }
+
+	uint8_t bitAt(size_t index) const { return (data[index / 8] >> (index % 8)) & 1; }
+
+	void appendBits(uint8_t value, uint8_t count) {
+		for (uint8_t i = 0; i < count; i++, bits++) {
+			if (bits % 8 == 0) {
+				data.push_back(0);
+			}
+			data.back() |= ((value >> i) & 1) << (bits % 8);
+		}
+	}
+
+	void append(uint8_t value) { appendBits(value, 8); }
+
+	void append(const uint8_t *values, size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			append(values[i]);
+		}
+	}
+
+	void appendCrc() {
+		uint16_t crc = crcA(data.data(), data.size());
+		append(crc & 0xFF);
+		append(crc >> 8);
+	}
+
+	/**
+	 * True for whole bytes ending in a valid CRC_A.
+	 */
+	bool crcValid() const { return complete() && bits >= 24 && crcA(data.data(), data.size()) == 0; }
+
+	/**
+	 * Time on air, 9 bits per complete byte.
+	 */
+	uint64_t airNs() const { return bitsNs(bits + bits / 8, rate); }
+};
+
+} // namespace Iso14443
+
+#endif
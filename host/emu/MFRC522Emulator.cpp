@@ -0,0 +1,797 @@
+/**
+ * Register level model of the MFRC522, see MFRC522Emulator.h. Section numbers refer to the
+ * MFRC522 datasheet, revision 3.9.
+ */
+#include "MFRC522Emulator.h"
+#include <string.h>
+
+using Iso14443::Frame;
+
+namespace {
+
+const uint64_t NEVER = UINT64_MAX;
+
+// Registers (9.2), by address
+enum Register {
+	CommandReg = 0x01, ComIEnReg = 0x02, DivIEnReg = 0x03, ComIrqReg = 0x04, DivIrqReg = 0x05,
+	ErrorReg = 0x06, Status1Reg = 0x07, Status2Reg = 0x08, FIFODataReg = 0x09, FIFOLevelReg = 0x0A,
+	WaterLevelReg = 0x0B, ControlReg = 0x0C, BitFramingReg = 0x0D, CollReg = 0x0E,
+	ModeReg = 0x11, TxModeReg = 0x12, RxModeReg = 0x13, TxControlReg = 0x14, TxASKReg = 0x15,
+	TxSelReg = 0x16, RxSelReg = 0x17, RxThresholdReg = 0x18, DemodReg = 0x19, MfTxReg = 0x1C,
+	MfRxReg = 0x1D, SerialSpeedReg = 0x1F, CRCResultRegH = 0x21, CRCResultRegL = 0x22,
+	ModWidthReg = 0x24, RFCfgReg = 0x26, GsNReg = 0x27, CWGsPReg = 0x28, ModGsPReg = 0x29,
+	TModeReg = 0x2A, TPrescalerReg = 0x2B, TReloadRegH = 0x2C, TReloadRegL = 0x2D,
+	TCounterValueRegH = 0x2E, TCounterValueRegL = 0x2F, TestPinEnReg = 0x33, AutoTestReg = 0x36,
+	VersionReg = 0x37
+};
+
+// Commands (10.3)
+enum Command {
+	CMD_IDLE = 0x0, CMD_MEM = 0x1, CMD_GENERATE_RANDOM_ID = 0x2, CMD_CALC_CRC = 0x3,
+	CMD_TRANSMIT = 0x4, CMD_NO_CMD_CHANGE = 0x7, CMD_RECEIVE = 0x8, CMD_TRANSCEIVE = 0xC,
+	CMD_MF_AUTHENT = 0xE, CMD_SOFT_RESET = 0xF
+};
+
+// ComIrqReg and DivIrqReg bits
+const uint8_t TIMER_IRQ = 0x01, ERR_IRQ = 0x02, LO_ALERT_IRQ = 0x04, HI_ALERT_IRQ = 0x08;
+const uint8_t IDLE_IRQ = 0x10, RX_IRQ = 0x20, TX_IRQ = 0x40, CRC_IRQ = 0x04;
+
+// ErrorReg bits
+const uint8_t PROTOCOL_ERR = 0x01, CRC_ERR = 0x04, COLL_ERR = 0x08, BUFFER_OVFL = 0x10;
+const uint8_t RX_ERRORS = 0x0F;		// Cleared when the receiver starts
+
+// Oscillator start up after NRSTPD or a soft reset, 8.8.2
+const uint64_t STARTUP_NS = 37740;
+// The CRC coprocessor takes in one byte per 8 carrier periods
+const uint64_t CRC_BYTE_NS = Iso14443::carrierNs(8);
+
+const uint8_t resetValues[64] = {
+	0x00, 0x20, 0x80, 0x00, 0x14, 0x00, 0x00, 0x21, 0x00, 0x00, 0x00, 0x08, 0x10, 0x00, 0xA0, 0x00,
+	0x00, 0x3F, 0x00, 0x00, 0x80, 0x00, 0x10, 0x84, 0x84, 0x4D, 0x00, 0x00, 0x62, 0x00, 0x00, 0xEB,
+	0x00, 0xFF, 0xFF, 0x00, 0x26, 0x00, 0x48, 0x88, 0x20, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x40, 0x92, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+uint64_t earliest(uint64_t a, uint64_t b) {
+	return a < b ? a : b;
+}
+
+} // namespace
+
+unsigned long MFRC522Emulator::Stats::reads() const {
+	unsigned long total = 0;
+	for (unsigned long count : registerReads) {
+		total += count;
+	}
+	return total;
+}
+
+unsigned long MFRC522Emulator::Stats::writes() const {
+	unsigned long total = 0;
+	for (unsigned long count : registerWrites) {
+		total += count;
+	}
+	return total;
+}
+
+MFRC522Emulator::MFRC522Emulator(PiccField &field)
+	: _field(field), _stats(), _csPin(NO_PIN), _resetPin(NO_PIN), _irqPin(NO_PIN), _powered(true),
+	  _powerDown(false), _startup(false), _wakeAt(NEVER), _spi(SPI_ADDRESS), _spiReg(0) {
+	memset(_mem, 0, sizeof(_mem));
+	resetRegisters();
+}
+
+MFRC522Emulator::~MFRC522Emulator() {
+	detach();
+}
+
+void MFRC522Emulator::attach(uint8_t chipSelectPin, uint8_t resetPin, uint8_t irqPin) {
+	detach();
+	_csPin = chipSelectPin;
+	_resetPin = resetPin;
+	_irqPin = irqPin;
+	HostSim::attachSpiDevice(chipSelectPin, this);
+	HostSim::addClockListener(this);
+	if (resetPin != NO_PIN) {
+		HostSim::attachPinListener(resetPin, this);
+	}
+	_powered = resetPin == NO_PIN || HostSim::pinLevel(resetPin) == HIGH;
+	_powerDown = false;
+	_startup = false;
+	_wakeAt = NEVER;
+	resetRegisters();
+	updateIrqPin();
+}
+
+void MFRC522Emulator::detach() {
+	if (_csPin == NO_PIN) {
+		return;
+	}
+	HostSim::detachSpiDevice(_csPin);
+	HostSim::removeClockListener(this);
+	if (_resetPin != NO_PIN) {
+		HostSim::attachPinListener(_resetPin, nullptr);
+	}
+	_field.setPowered(false);
+	_csPin = NO_PIN;
+}
+
+void MFRC522Emulator::resetStats() {
+	_stats = Stats();
+}
+
+void MFRC522Emulator::resetRegisters() {
+	memcpy(_regs, resetValues, sizeof(_regs));
+	_fifoHead = 0;
+	_fifoLevel = 0;
+	_modem = MODEM_IDLE;
+	_txNext = NEVER;
+	_rxIndex = 0;
+	_rxBytes.clear();
+	_rxTimes.clear();
+	_rxStart = NEVER;
+	_rxEnd = NEVER;
+	_rxStarted = false;
+	_timerRunning = false;
+	_timerExpiry = NEVER;
+	_timerStopped = 0;
+	_crc = 0xFFFF;
+	_crcDone = NEVER;
+	_authDone = NEVER;
+	updateField();
+}
+
+bool MFRC522Emulator::ready() const {
+	return _powered && !_startup;
+}
+
+// ---------------------------------------------------------------------------------------------------
+// SPI (8.1.2)
+// ---------------------------------------------------------------------------------------------------
+
+void MFRC522Emulator::select(bool selected) {
+	_spi = SPI_ADDRESS;
+	if (selected) {
+		_stats.selects++;
+	}
+}
+
+uint8_t MFRC522Emulator::transfer(uint8_t mosi) {
+	_stats.spiBytes++;
+	if (!ready()) {
+		return 0x00;
+	}
+	uint8_t miso = 0x00;
+	switch (_spi) {
+		case SPI_ADDRESS:
+			_spiReg = (mosi >> 1) & 0x3F;
+			_spi = (mosi & 0x80) ? SPI_READ : SPI_WRITE;
+			break;
+		case SPI_READ:
+			// MISO carries the register addressed by the previous byte, MOSI addresses the next
+			miso = readRegister(_spiReg);
+			_spiReg = (mosi >> 1) & 0x3F;
+			break;
+		case SPI_WRITE:
+			writeRegister(_spiReg, mosi);
+			break;
+	}
+	return miso;
+}
+
+uint8_t MFRC522Emulator::peek(uint8_t reg) const {
+	reg &= 0x3F;
+	switch (reg) {
+		case FIFODataReg:
+			return _fifoLevel ? _fifo[_fifoHead] : 0x00;
+		case FIFOLevelReg:
+			return _fifoLevel;
+		default:
+			return _regs[reg];
+	}
+}
+
+uint8_t MFRC522Emulator::readRegister(uint8_t reg) {
+	_stats.registerReads[reg]++;
+	uint64_t now = HostSim::nanos();
+	switch (reg) {
+		case FIFODataReg:
+			return fifoPop();
+		case FIFOLevelReg:
+			return _fifoLevel;
+		case Status1Reg:
+			return status1();
+		case Status2Reg:
+			return (_regs[Status2Reg] & 0xF8) | _modem;
+		case TCounterValueRegH:
+			return timerValue(now) >> 8;
+		case TCounterValueRegL:
+			return timerValue(now) & 0xFF;
+		default:
+			return _regs[reg];
+	}
+}
+
+void MFRC522Emulator::writeRegister(uint8_t reg, uint8_t value) {
+	_stats.registerWrites[reg]++;
+	switch (reg) {
+		case CommandReg: {
+			uint8_t command = value & 0x0F;
+			if (command == CMD_NO_CMD_CHANGE) {
+				command = _regs[CommandReg] & 0x0F;
+			}
+			if (value & 0x10) {
+				// Soft power down: the analog part and the oscillator stop, so does the field
+				stopActivity();
+				stopTimer();
+				_powerDown = true;
+				_regs[CommandReg] = (value & 0x30) | command;
+				updateField();
+				return;
+			}
+			if (_powerDown) {
+				// PowerDown stays set until the oscillator runs again
+				_powerDown = false;
+				_wakeAt = HostSim::nanos() + STARTUP_NS;
+				_regs[CommandReg] = (value & 0x20) | 0x10 | (_regs[CommandReg] & 0x0F);
+				return;
+			}
+			_regs[CommandReg] = (value & 0x20) | (_regs[CommandReg] & 0x0F);
+			if ((value & 0x0F) != CMD_NO_CMD_CHANGE) {
+				startCommand(command);
+			}
+			return;
+		}
+		case ComIrqReg:
+			// Set1: 1 sets the marked bits, 0 clears them
+			if (value & 0x80) {
+				_regs[ComIrqReg] |= value & 0x7F;
+			} else {
+				_regs[ComIrqReg] &= ~value & 0x7F;
+			}
+			updateIrqPin();
+			return;
+		case DivIrqReg:
+			if (value & 0x80) {
+				_regs[DivIrqReg] |= value & 0x14;
+			} else {
+				_regs[DivIrqReg] &= ~value & 0x14;
+			}
+			updateIrqPin();
+			return;
+		case ComIEnReg:
+		case DivIEnReg:
+			_regs[reg] = value;
+			updateIrqPin();
+			return;
+		case ErrorReg:
+		case Status1Reg:
+		case CRCResultRegH:
+		case CRCResultRegL:
+		case TCounterValueRegH:
+		case TCounterValueRegL:
+		case VersionReg:
+			return;		// Read only
+		case Status2Reg:
+			// MFCrypto1On can only be cleared
+			_regs[Status2Reg] = (value & 0xC0) | (_regs[Status2Reg] & value & 0x08);
+			return;
+		case FIFODataReg:
+			fifoPush(value);
+			if ((_regs[CommandReg] & 0x0F) == CMD_CALC_CRC) {
+				// CalcCRC goes on with every byte written, 10.3.1.4
+				uint64_t now = HostSim::nanos();
+				_crcDone = (_crcDone == NEVER || _crcDone < now ? now : _crcDone) + CRC_BYTE_NS;
+			}
+			return;
+		case FIFOLevelReg:
+			if (value & 0x80) {
+				fifoFlush();
+			}
+			return;
+		case ControlReg:
+			if (value & 0x80) {
+				stopTimer();
+			}
+			if (value & 0x40) {
+				startTimer(HostSim::nanos());
+			}
+			return;
+		case BitFramingReg:
+			_regs[BitFramingReg] = value;
+			// StartSend acts when written, it is no state the chip keeps acting on
+			if ((value & 0x80) && (_regs[CommandReg] & 0x0F) == CMD_TRANSCEIVE && _modem == MODEM_WAIT_START) {
+				startTransmit();
+			}
+			return;
+		case CollReg:
+			_regs[CollReg] = (_regs[CollReg] & 0x7F) | (value & 0x80);
+			return;
+		case TxControlReg:
+			_regs[TxControlReg] = value;
+			updateField();
+			return;
+		default:
+			_regs[reg] = value;
+			return;
+	}
+}
+
+// ---------------------------------------------------------------------------------------------------
+// FIFO, interrupts, field
+// ---------------------------------------------------------------------------------------------------
+
+void MFRC522Emulator::fifoPush(uint8_t value) {
+	if (_fifoLevel == FIFO_SIZE) {
+		_regs[ErrorReg] |= BUFFER_OVFL;
+		setComIrq(ERR_IRQ);
+		return;
+	}
+	_fifo[(_fifoHead + _fifoLevel) % FIFO_SIZE] = value;
+	_fifoLevel++;
+	fifoChanged();
+}
+
+uint8_t MFRC522Emulator::fifoPop() {
+	if (_fifoLevel == 0) {
+		return 0x00;
+	}
+	uint8_t value = _fifo[_fifoHead];
+	_fifoHead = (_fifoHead + 1) % FIFO_SIZE;
+	_fifoLevel--;
+	fifoChanged();
+	return value;
+}
+
+void MFRC522Emulator::fifoFlush() {
+	_fifoHead = 0;
+	_fifoLevel = 0;
+	_regs[ErrorReg] &= ~BUFFER_OVFL;
+	fifoChanged();
+}
+
+void MFRC522Emulator::fifoChanged() {
+	// HiAlertIRq and LoAlertIRq store the moment the level crosses the water level (9.3.1.5)
+	uint8_t waterLevel = _regs[WaterLevelReg] & 0x3F;
+	uint8_t alerts = 0;
+	if (FIFO_SIZE - _fifoLevel <= waterLevel) {
+		alerts |= HI_ALERT_IRQ;
+	}
+	if (_fifoLevel <= waterLevel) {
+		alerts |= LO_ALERT_IRQ;
+	}
+	uint8_t previous = _regs[Status1Reg] & 0x03;	// LoAlert and HiAlert, as last seen
+	uint8_t current = (alerts & LO_ALERT_IRQ ? 0x01 : 0) | (alerts & HI_ALERT_IRQ ? 0x02 : 0);
+	_regs[Status1Reg] = (_regs[Status1Reg] & ~0x03) | current;
+	uint8_t raised = current & ~previous;
+	if (raised) {
+		setComIrq((raised & 0x01 ? LO_ALERT_IRQ : 0) | (raised & 0x02 ? HI_ALERT_IRQ : 0));
+	}
+}
+
+uint8_t MFRC522Emulator::status1() {
+	uint64_t now = HostSim::nanos();
+	uint8_t value = _regs[Status1Reg] & 0x03;
+	if (_timerRunning && now >= _timerStart) {
+		value |= 0x08;	// TRunning
+	}
+	if ((_regs[ComIrqReg] & _regs[ComIEnReg] & 0x7F) || (_regs[DivIrqReg] & _regs[DivIEnReg] & 0x14)) {
+		value |= 0x10;	// IRq
+	}
+	if (_crcDone == NEVER) {
+		value |= 0x20;	// CRCReady
+		uint16_t result = (uint16_t)(_regs[CRCResultRegH] << 8 | _regs[CRCResultRegL]);
+		if (result == 0) {
+			value |= 0x40;	// CRCOk
+		}
+	}
+	return value;
+}
+
+void MFRC522Emulator::setComIrq(uint8_t bits) {
+	_regs[ComIrqReg] |= bits;
+	updateIrqPin();
+}
+
+void MFRC522Emulator::setDivIrq(uint8_t bits) {
+	_regs[DivIrqReg] |= bits;
+	updateIrqPin();
+}
+
+void MFRC522Emulator::updateIrqPin() {
+	if (_irqPin == NO_PIN) {
+		return;
+	}
+	bool active = (_regs[ComIrqReg] & _regs[ComIEnReg] & 0x7F) || (_regs[DivIrqReg] & _regs[DivIEnReg] & 0x14);
+	bool inverted = _regs[ComIEnReg] & 0x80;	// IRqInv, set after reset
+	HostSim::driveInput(_irqPin, active != inverted ? HIGH : LOW);
+}
+
+void MFRC522Emulator::updateField() {
+	_field.setPowered(ready() && !_powerDown && _wakeAt == NEVER && (_regs[TxControlReg] & 0x03));
+}
+
+// ---------------------------------------------------------------------------------------------------
+// Commands (10.3)
+// ---------------------------------------------------------------------------------------------------
+
+void MFRC522Emulator::startCommand(uint8_t command) {
+	stopActivity();
+	_stats.commands[command]++;
+	_regs[CommandReg] = (_regs[CommandReg] & 0xF0) | command;
+	switch (command) {
+		case CMD_MEM:
+			if (_fifoLevel) {
+				for (uint8_t i = 0; i < sizeof(_mem); i++) {
+					_mem[i] = fifoPop();
+				}
+			} else {
+				for (uint8_t i = 0; i < sizeof(_mem); i++) {
+					fifoPush(_mem[i]);
+				}
+			}
+			finishCommand();
+			break;
+		case CMD_GENERATE_RANDOM_ID:
+			for (uint8_t i = 0; i < 10; i++) {
+				_mem[i] = (uint8_t)random(256);
+			}
+			finishCommand();
+			break;
+		case CMD_CALC_CRC: {
+			static const uint16_t presets[4] = {0x0000, 0x6363, 0xA671, 0xFFFF};
+			_crc = presets[_regs[ModeReg] & 0x03];
+			_crcDone = HostSim::nanos() + CRC_BYTE_NS * (_fifoLevel + 1);
+			break;
+		}
+		case CMD_TRANSMIT:
+			startTransmit();
+			break;
+		case CMD_RECEIVE:
+			_regs[ErrorReg] &= ~RX_ERRORS;
+			_modem = MODEM_RX_WAIT;		// Nothing arrives unless a card talks on its own
+			break;
+		case CMD_TRANSCEIVE:
+			_modem = MODEM_WAIT_START;
+			break;
+		case CMD_MF_AUTHENT:
+			startAuthent();
+			break;
+		case CMD_SOFT_RESET:
+			softReset();
+			break;
+		default:
+			break;
+	}
+}
+
+void MFRC522Emulator::stopActivity() {
+	_txNext = NEVER;
+	_rxBytes.clear();
+	_rxTimes.clear();
+	_rxStart = NEVER;
+	_rxEnd = NEVER;
+	_crcDone = NEVER;
+	_authDone = NEVER;
+	_modem = MODEM_IDLE;
+}
+
+void MFRC522Emulator::finishCommand() {
+	// A command that terminates by itself sets IdleIRq, cancelling by writing Idle does not
+	stopActivity();
+	_regs[CommandReg] &= 0xF0;
+	setComIrq(IDLE_IRQ);
+}
+
+void MFRC522Emulator::softReset() {
+	// All registers back to their reset values, PowerDown reads 1 until the oscillator runs
+	_field.setPowered(false);
+	resetRegisters();
+	_regs[CommandReg] |= 0x10;
+	_wakeAt = HostSim::nanos() + STARTUP_NS;
+}
+
+void MFRC522Emulator::pinChanged(uint8_t pin, uint8_t level) {
+	if (pin != _resetPin) {
+		return;
+	}
+	if (level == LOW) {
+		// Hard power down, the chip loses all state
+		_powered = false;
+		stopActivity();
+		_wakeAt = NEVER;
+		updateField();
+		return;
+	}
+	// Rising edge: hard reset
+	_powered = true;
+	_powerDown = false;
+	_startup = true;
+	resetRegisters();
+	_wakeAt = HostSim::nanos() + STARTUP_NS;
+}
+
+// ---------------------------------------------------------------------------------------------------
+// Transmission and reception
+// ---------------------------------------------------------------------------------------------------
+
+void MFRC522Emulator::startTransmit() {
+	_regs[ErrorReg] &= ~RX_ERRORS;
+	_tx = Frame();
+	_tx.rate = (_regs[TxModeReg] >> 4) & 0x03;
+	_tx.encrypted = _regs[Status2Reg] & 0x08;
+	_txLast = false;
+	_modem = MODEM_TX;
+	_txNext = HostSim::nanos() + Iso14443::bitsNs(1, _tx.rate);	// Start of frame
+}
+
+void MFRC522Emulator::transmitNext() {
+	if (_txLast || _fifoLevel == 0) {
+		finishTransmit();
+		return;
+	}
+	// Bytes leave the FIFO one by one, the frame ends when it runs empty
+	uint8_t value = fifoPop();
+	_txLast = _fifoLevel == 0;
+	uint8_t lastBits = _regs[BitFramingReg] & 0x07;
+	uint8_t bits = (_txLast && lastBits) ? lastBits : 8;
+	_tx.appendBits(value, bits);
+	uint64_t duration = Iso14443::bitsNs(bits == 8 ? 9 : bits, _tx.rate);
+	if (_txLast) {
+		if ((_regs[TxModeReg] & 0x80) && _tx.complete()) {
+			static const uint16_t presets[4] = {0x0000, 0x6363, 0xA671, 0xFFFF};
+			uint16_t crc = Iso14443::crcA(_tx.data.data(), _tx.data.size(), presets[_regs[ModeReg] & 0x03]);
+			_tx.append(crc & 0xFF);
+			_tx.append(crc >> 8);
+			duration += Iso14443::bitsNs(18, _tx.rate);
+		}
+		duration += Iso14443::bitsNs(1, _tx.rate);	// End of frame
+	}
+	_txNext = HostSim::nanos() + duration;
+}
+
+void MFRC522Emulator::finishTransmit() {
+	uint64_t now = HostSim::nanos();
+	_txNext = NEVER;
+	_stats.framesSent++;
+	setComIrq(TX_IRQ);
+	if (_regs[TModeReg] & 0x80) {
+		startTimer(now);	// TAuto
+	}
+	uint8_t command = _regs[CommandReg] & 0x0F;
+	if (command == CMD_TRANSMIT) {
+		finishCommand();
+		return;
+	}
+	_modem = MODEM_RX_WAIT;
+	// The cards recognise a modulation pause of a quarter to a half of the bit, ModWidthReg + 1 carrier periods
+	unsigned int pause = _regs[ModWidthReg] + 1u;
+	unsigned int bitPeriod = 128u >> _tx.rate;
+	bool readable = pause >= bitPeriod / 4 && pause < bitPeriod / 2;
+	PiccField::Reply reply;
+	if (!(_regs[CommandReg] & 0x20) && readable && _field.exchange(_tx, reply)) {	// RcvOff clear
+		scheduleReceive(reply, now + reply.delay);
+	}
+}
+
+void MFRC522Emulator::scheduleReceive(const PiccField::Reply &reply, uint64_t start) {
+	const Frame &frame = reply.frame;
+	if (frame.rate != ((_regs[RxModeReg] >> 4) & 0x03)) {
+		return;		// The receiver cannot make sense of it
+	}
+	size_t bits = frame.bits;
+	_rxErrors = 0;
+	if (_regs[RxModeReg] & 0x80) {
+		// RxCRCEn: the CRC is checked and does not go into the FIFO
+		if (frame.crcValid()) {
+			bits -= 16;
+		} else {
+			_rxErrors |= CRC_ERR;
+		}
+	}
+	Frame data;
+	for (size_t i = 0; i < bits; i++) {
+		data.appendBits(frame.bitAt(i), 1);
+	}
+	_rxColl = 0x20;		// CollPosNotValid
+	uint8_t align = (_regs[BitFramingReg] >> 4) & 0x07;
+	if (reply.collision >= 0 && (size_t)reply.collision < bits) {
+		_rxErrors |= COLL_ERR;
+		_stats.collisions++;
+		if (!(_regs[CollReg] & 0x80)) {
+			// ValuesAfterColl clear: the bits received after a collision read 0
+			for (size_t i = reply.collision; i < bits; i++) {
+				data.data[i / 8] &= ~(1 << (i % 8));
+			}
+		}
+		// Counted from the first bit in the FIFO, so the RxAlign offset is included, 0 means 32
+		unsigned int position = align + reply.collision + 1;
+		if (position <= 32) {
+			_rxColl = position & 0x1F;
+		}
+	}
+	// Bits from position align of the first FIFO byte on, each FIFO byte is complete when its
+	// last bit arrived
+	size_t positions = align + bits;
+	_rxBytes.assign((positions + 7) / 8, 0);
+	_rxTimes.assign(_rxBytes.size(), 0);
+	for (size_t i = 0; i < bits; i++) {
+		size_t position = align + i;
+		_rxBytes[position / 8] |= data.bitAt(i) << (position % 8);
+	}
+	uint64_t sof = Iso14443::bitsNs(1, frame.rate);
+	for (size_t k = 0; k < _rxBytes.size(); k++) {
+		size_t end = ((k + 1) * 8 < positions ? (k + 1) * 8 : positions) - align;
+		_rxTimes[k] = start + sof + Iso14443::bitsNs(end + end / 8, frame.rate);
+	}
+	_rxIndex = 0;
+	_rxLastBits = positions % 8;
+	_rxStart = start;
+	_rxStarted = false;
+	_rxEnd = start + sof + frame.airNs() + Iso14443::bitsNs(1, frame.rate);
+}
+
+void MFRC522Emulator::receiveNext() {
+	if (!_rxStarted) {
+		// The first bit stops a timer started by TAuto
+		_rxStarted = true;
+		_modem = MODEM_RX;
+		if (_regs[TModeReg] & 0x80) {
+			stopTimer();
+		}
+		return;
+	}
+	if (_rxIndex < _rxBytes.size()) {
+		fifoPush(_rxBytes[_rxIndex++]);
+		return;
+	}
+	// End of frame
+	_rxStart = NEVER;
+	_rxEnd = NEVER;
+	_rxBytes.clear();
+	_rxTimes.clear();
+	_stats.framesReceived++;
+	_regs[ControlReg] = (_regs[ControlReg] & ~0x07) | _rxLastBits;
+	_regs[CollReg] = (_regs[CollReg] & 0x80) | _rxColl;
+	_regs[ErrorReg] |= _rxErrors;
+	setComIrq(RX_IRQ | (_rxErrors ? ERR_IRQ : 0));
+	if ((_regs[CommandReg] & 0x0F) == CMD_RECEIVE) {
+		finishCommand();
+	} else {
+		_modem = MODEM_WAIT_START;	// Transceive waits for the next StartSend
+	}
+}
+
+// ---------------------------------------------------------------------------------------------------
+// Timer (8.5)
+// ---------------------------------------------------------------------------------------------------
+
+uint64_t MFRC522Emulator::timerTickCarrier() const {
+	uint16_t prescaler = (uint16_t)((_regs[TModeReg] & 0x0F) << 8 | _regs[TPrescalerReg]);
+	return 2 * (uint64_t)prescaler + 1;
+}
+
+void MFRC522Emulator::startTimer(uint64_t at) {
+	_timerReload = (uint16_t)(_regs[TReloadRegH] << 8 | _regs[TReloadRegL]);
+	_timerRunning = true;
+	_timerStart = at;
+	_timerExpiry = at + Iso14443::carrierNs(_timerReload * timerTickCarrier());
+}
+
+void MFRC522Emulator::stopTimer() {
+	if (_timerRunning) {
+		_timerStopped = timerValue(HostSim::nanos());
+	}
+	_timerRunning = false;
+	_timerExpiry = NEVER;
+}
+
+uint16_t MFRC522Emulator::timerValue(uint64_t now) const {
+	if (!_timerRunning) {
+		return _timerStopped;
+	}
+	if (now <= _timerStart) {
+		return _timerReload;
+	}
+	uint64_t ticks = (now - _timerStart) * Iso14443::CARRIER_HZ / 1000000000ULL / timerTickCarrier();
+	return ticks >= _timerReload ? 0 : (uint16_t)(_timerReload - ticks);
+}
+
+// ---------------------------------------------------------------------------------------------------
+// CRC coprocessor and MFAuthent
+// ---------------------------------------------------------------------------------------------------
+
+void MFRC522Emulator::crcStep() {
+	// The coprocessor has taken in everything written to the FIFO
+	_crcDone = NEVER;
+	while (_fifoLevel) {
+		uint8_t value = fifoPop();
+		_crc = Iso14443::crcA(&value, 1, _crc);
+	}
+	_regs[CRCResultRegL] = _crc & 0xFF;
+	_regs[CRCResultRegH] = _crc >> 8;
+	setDivIrq(CRC_IRQ);
+}
+
+void MFRC522Emulator::startAuthent() {
+	uint8_t buffer[12];
+	uint8_t count = 0;
+	while (_fifoLevel && count < sizeof(buffer)) {
+		buffer[count++] = fifoPop();
+	}
+	uint64_t now = HostSim::nanos();
+	// Auth (4 bytes), nonce Nt (4), Nr and Ar (8), At (4), each answer after the frame delay time
+	uint64_t request = Iso14443::bitsNs(4 * 9 + 2, 0);
+	uint64_t answer = Iso14443::FDT_NS + Iso14443::bitsNs(4 * 9 + 2, 0);
+	uint64_t second = Iso14443::bitsNs(8 * 9 + 2, 0);
+	_authOk = count == sizeof(buffer) && _field.authenticate(buffer[0], buffer[1], buffer + 2, buffer + 8);
+	if (_authOk) {
+		_authDone = now + request + answer + Iso14443::FDT_NS + second + answer;
+		return;
+	}
+	if ((_regs[TModeReg] & 0x80) == 0) {
+		return;
+	}
+	// No answer: TAuto starts the timer after the first frame, or after Nr and Ar if only the key was wrong
+	bool nonce = count == sizeof(buffer) && _field.powered() && !_field.cards().empty();
+	startTimer(now + request + (nonce ? answer + Iso14443::FDT_NS + second : 0));
+}
+
+void MFRC522Emulator::finishAuthent() {
+	_regs[Status2Reg] |= 0x08;		// MFCrypto1On
+	finishCommand();
+}
+
+// ---------------------------------------------------------------------------------------------------
+// Clock
+// ---------------------------------------------------------------------------------------------------
+
+uint64_t MFRC522Emulator::receiveTime() const {
+	if (!_rxStarted) {
+		return _rxStart;
+	}
+	return _rxIndex < _rxTimes.size() ? _rxTimes[_rxIndex] : _rxEnd;
+}
+
+uint64_t MFRC522Emulator::nextEvent() {
+	uint64_t next = earliest(_wakeAt, _txNext);
+	next = earliest(next, _timerExpiry);
+	next = earliest(next, _crcDone);
+	next = earliest(next, _authDone);
+	if (_rxStart != NEVER) {
+		next = earliest(next, receiveTime());
+	}
+	return next;
+}
+
+void MFRC522Emulator::clockAdvanced(uint64_t now) {
+	uint64_t next = nextEvent();
+	if (next > now) {
+		return;
+	}
+	if (_wakeAt == next) {
+		_wakeAt = NEVER;
+		_startup = false;
+		_regs[CommandReg] &= ~0x10;
+		updateField();
+	} else if (_txNext == next) {
+		transmitNext();
+	} else if (_rxStart != NEVER && receiveTime() == next) {
+		receiveNext();
+	} else if (_crcDone == next) {
+		crcStep();
+	} else if (_authDone == next) {
+		_authDone = NEVER;
+		finishAuthent();
+	} else {
+		_stats.timerExpiries++;
+		setComIrq(TIMER_IRQ);
+		if (_regs[TModeReg] & 0x10) {
+			startTimer(_timerExpiry);	// TAutoRestart
+		} else {
+			_timerStopped = 0;
+			_timerRunning = false;
+			_timerExpiry = NEVER;
+		}
+	}
+}
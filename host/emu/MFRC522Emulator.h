@@ -0,0 +1,161 @@
+/**
+ * Register level model of the NXP MFRC522 on the host SPI bus.
+ *
+ * The emulator answers the SPI byte sequences of the MFRC522 library (datasheet 8.1.2: address
+ * byte, bit 7 set for reading, then data), so the driver runs unchanged against it. Modelled are
+ * the 64 byte FIFO with water level alerts, ComIrqReg and DivIrqReg with their Set bits and the IRQ
+ * pin, ErrorReg, CollReg, the CRC coprocessor (CalcCRC and TxCRCEn/RxCRCEn), the timer (TModeReg,
+ * TPrescalerReg, TReloadReg, TAuto), BitFramingReg (TxLastBits, RxAlign, StartSend) and the
+ * commands Idle, Mem, CalcCRC, Transmit, Receive, Transceive, MFAuthent and SoftReset, soft power
+ * down and the NRSTPD pin.
+ *
+ * Frames go over the air in real time: each byte leaves the FIFO when its turn comes, the answer
+ * of the cards in the PiccField arrives after the frame delay time and fills the FIFO bit by bit,
+ * so polling loops and timeouts see what they would on hardware. TxModeReg and RxModeReg set the
+ * bit rates, a frame sent with a ModWidthReg unfit for its rate reaches no card. Crypto1 is not
+ * modelled, the card checks the key in MFAuthent and the frames stay in clear.
+ *
+ * Every SPI byte, register read and write and started command is counted in stats(). select() and
+ * transfer() are final, so MFRC522MockTransport calls them without going through the vtable.
+ */
+#ifndef MFRC522Emulator_h
+#define MFRC522Emulator_h
+
+#include <Arduino.h>
+#include <HostSim.h>
+#include <SPI.h>
+#include "VirtualPicc.h"
+
+class MFRC522Emulator : public SPIDevice, public HostSim::ClockListener, public HostSim::PinListener {
+public:
+	static const uint8_t NO_PIN = 0xFF;
+	static const uint8_t FIFO_SIZE = 64;
+
+	struct Stats {
+		unsigned long spiBytes;
+		unsigned long selects;
+		unsigned long registerReads[64];	// By register address, 0x00 to 0x3F
+		unsigned long registerWrites[64];
+		unsigned long commands[16];			// Commands started, by command code
+		unsigned long framesSent;
+		unsigned long framesReceived;
+		unsigned long collisions;
+		unsigned long timerExpiries;
+
+		unsigned long reads() const;
+		unsigned long writes() const;
+	};
+
+	explicit MFRC522Emulator(PiccField &field);
+	~MFRC522Emulator();
+
+	/**
+	 * Connects the chip: SPI chip select, NRSTPD (the library's reset pin) and the IRQ output.
+	 * Without a reset pin the chip is powered from the start. Call after HostSim::reset().
+	 */
+	void attach(uint8_t chipSelectPin, uint8_t resetPin = NO_PIN, uint8_t irqPin = NO_PIN);
+	void detach();
+
+	PiccField &field() { return _field; }
+	const Stats &stats() const { return _stats; }
+	void resetStats();
+
+	/**
+	 * Register content without the side effects of an SPI read.
+	 */
+	uint8_t peek(uint8_t reg) const;
+	uint8_t fifoLevel() const { return _fifoLevel; }
+
+	// SPIDevice
+	void select(bool selected) final;
+	uint8_t transfer(uint8_t mosi) final;
+
+	// HostSim::ClockListener
+	uint64_t nextEvent() override;
+	void clockAdvanced(uint64_t now) override;
+
+	// HostSim::PinListener
+	void pinChanged(uint8_t pin, uint8_t level) override;
+
+private:
+	enum SpiState { SPI_ADDRESS, SPI_READ, SPI_WRITE };
+	enum Modem { MODEM_IDLE = 0, MODEM_WAIT_START = 1, MODEM_TX = 3, MODEM_RX_WAIT = 4, MODEM_RX = 6 };
+
+	uint8_t readRegister(uint8_t reg);
+	void writeRegister(uint8_t reg, uint8_t value);
+	void resetRegisters();
+	bool ready() const;
+
+	void fifoPush(uint8_t value);
+	uint8_t fifoPop();
+	void fifoFlush();
+	void fifoChanged();
+
+	void setComIrq(uint8_t bits);
+	void setDivIrq(uint8_t bits);
+	void updateIrqPin();
+	void updateField();
+	uint8_t status1();
+
+	void startCommand(uint8_t command);
+	void stopActivity();
+	void finishCommand();
+	void softReset();
+
+	void startTransmit();
+	void transmitNext();
+	void finishTransmit();
+	void scheduleReceive(const PiccField::Reply &reply, uint64_t start);
+	void receiveNext();
+	uint64_t receiveTime() const;
+
+	void startTimer(uint64_t at);
+	void stopTimer();
+	uint16_t timerValue(uint64_t now) const;
+	uint64_t timerTickCarrier() const;
+
+	void crcStep();
+	void startAuthent();
+	void finishAuthent();
+
+	PiccField &_field;
+	Stats _stats;
+	uint8_t _csPin, _resetPin, _irqPin;
+
+	uint8_t _regs[64];
+	uint8_t _fifo[FIFO_SIZE];
+	uint8_t _fifoHead, _fifoLevel;
+	uint8_t _mem[25];			// Internal buffer of the Mem command
+
+	bool _powered;				// NRSTPD high
+	bool _powerDown;			// Soft power down (CommandReg PowerDown)
+	bool _startup;				// Oscillator starting after NRSTPD went high, SPI not working yet
+	uint64_t _wakeAt;			// End of a reset or wake up, UINT64_MAX if none pending
+
+	SpiState _spi;
+	uint8_t _spiReg;
+
+	Modem _modem;
+	Iso14443::Frame _tx;		// Frame being sent
+	uint64_t _txNext;			// Next byte or end of the frame
+	bool _txLast;
+
+	std::vector<uint8_t> _rxBytes;	// FIFO bytes of the answer and when they are complete
+	std::vector<uint64_t> _rxTimes;
+	size_t _rxIndex;
+	uint64_t _rxStart, _rxEnd;
+	bool _rxStarted;
+	uint8_t _rxLastBits, _rxErrors, _rxColl;
+
+	bool _timerRunning;
+	uint64_t _timerStart, _timerExpiry;
+	uint16_t _timerReload, _timerStopped;
+
+	uint16_t _crc;
+	uint64_t _crcDone;
+
+	uint64_t _authDone;
+	bool _authOk;
+};
+
+#endif
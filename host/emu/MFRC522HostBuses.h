@@ -0,0 +1,125 @@
+/**
+ * The MFRC522 emulator on the I2C bus and on a serial port, for the library's MFRC522I2CTransport and
+ * MFRC522UartTransport.
+ *
+ * Both turn the register accesses of their bus (datasheet 8.1.3 and 8.1.4) into the SPI byte sequences
+ * of the emulator, so they show in its stats() like those of the SPI bus. MFRC522I2CDevice attaches to
+ * the host Wire library, which charges the bus time. MFRC522UartDevice is the Stream the transport
+ * writes to: each byte takes its 10 bit periods at the configured rate to reach the chip, and the answer
+ * as long to come back.
+ */
+#ifndef MFRC522HostBuses_h
+#define MFRC522HostBuses_h
+
+#include <Arduino.h>
+#include <HostSim.h>
+#include <Wire.h>
+#include <deque>
+#include "MFRC522Emulator.h"
+
+class MFRC522I2CDevice : public TwoWireDevice {
+public:
+	explicit MFRC522I2CDevice(MFRC522Emulator &chip) : _chip(&chip), _reg(0) {}
+
+	// The first byte of a write addresses the register, the others all go to it
+	void i2cWrite(const uint8_t *data, size_t length) override {
+		if (length == 0) {
+			return;
+		}
+		_reg = data[0] & 0x3F;
+		if (length > 1) {
+			_chip->select(true);
+			_chip->transfer(_reg << 1);
+			for (size_t index = 1; index < length; index++) {
+				_chip->transfer(data[index]);
+			}
+			_chip->select(false);
+		}
+	}
+
+	uint8_t i2cRead() override {
+		_chip->select(true);
+		_chip->transfer(0x80 | (_reg << 1));
+		uint8_t value = _chip->transfer(0);
+		_chip->select(false);
+		return value;
+	}
+
+private:
+	MFRC522Emulator *_chip;
+	uint8_t _reg;		// Addressed by the last write
+};
+
+class MFRC522UartDevice : public Stream {
+public:
+	MFRC522UartDevice(MFRC522Emulator &chip, unsigned long baud = 9600)
+		: _chip(&chip), _byteNs(10000000000ULL / baud), _writeReg(NO_REGISTER) {}
+
+	size_t write(uint8_t c) override {
+		HostSim::advance(_byteNs);		// On the wire to the chip
+		if (_writeReg != NO_REGISTER) {
+			_chip->select(true);
+			_chip->transfer(_writeReg << 1);
+			_chip->transfer(c);
+			_chip->select(false);
+			answer(_writeReg);			// The address byte acknowledges the write
+			_writeReg = NO_REGISTER;
+		} else if (c & 0x80) {
+			_chip->select(true);
+			_chip->transfer(0x80 | ((c & 0x3F) << 1));
+			answer(_chip->transfer(0));
+			_chip->select(false);
+		} else {
+			_writeReg = c & 0x3F;		// The value follows
+		}
+		return 1;
+	}
+	using Print::write;
+
+	int available() override {
+		int count = 0;
+		for (const Byte &entry : _answers) {
+			if (entry.at > HostSim::nanos()) {
+				break;
+			}
+			count++;
+		}
+		return count;
+	}
+
+	int read() override {
+		if (available() == 0) {
+			return -1;
+		}
+		uint8_t value = _answers.front().value;
+		_answers.pop_front();
+		return value;
+	}
+
+	int peek() override {
+		return available() ? _answers.front().value : -1;
+	}
+
+private:
+	static const uint8_t NO_REGISTER = 0xFF;
+
+	struct Byte {
+		uint8_t value;
+		uint64_t at;		// Received completely
+	};
+
+	void answer(uint8_t value) {
+		uint64_t start = _answers.empty() ? HostSim::nanos() : _answers.back().at;
+		if (start < HostSim::nanos()) {
+			start = HostSim::nanos();
+		}
+		_answers.push_back(Byte{value, start + _byteNs});
+	}
+
+	MFRC522Emulator *_chip;
+	uint64_t _byteNs;			// 10 bit periods
+	uint8_t _writeReg;			// Register of a write whose value has not come yet
+	std::deque<Byte> _answers;
+};
+
+#endif
@@ -0,0 +1,61 @@
+/**
+ * A transport of the MFRC522 library straight into the emulator, without the host SPI bus.
+ *
+ * MFRC522Base<MFRC522MockTransport> runs the protocol code of the library against an
+ * MFRC522Emulator in memory: the register accesses are the byte sequences of the SPI transport,
+ * handed to the emulator's select() and transfer() directly. They show in the emulator's stats()
+ * but cost no virtual time and leave the chip select pin and the HostSim SPI statistics alone.
+ */
+#ifndef MFRC522MockTransport_h
+#define MFRC522MockTransport_h
+
+#include <MFRC522Impl.h>
+#include "MFRC522Emulator.h"
+
+class MFRC522MockTransport {
+public:
+	explicit MFRC522MockTransport(MFRC522Emulator &chip) : _chip(&chip) {}
+
+	void begin() {}
+	void beginTransaction() {}
+	void endTransaction() {}
+
+	void writeRegister(byte reg, byte value) {
+		_chip->select(true);
+		_chip->transfer(reg);
+		_chip->transfer(value);
+		_chip->select(false);
+	}
+
+	void writeRegister(byte reg, byte count, const byte *values) {
+		_chip->select(true);
+		_chip->transfer(reg);
+		for (byte index = 0; index < count; index++) {
+			_chip->transfer(values[index]);
+		}
+		_chip->select(false);
+	}
+
+	byte readRegister(byte reg) {
+		_chip->select(true);
+		_chip->transfer(0x80 | reg);
+		byte value = _chip->transfer(0);
+		_chip->select(false);
+		return value;
+	}
+
+	void readRegister(byte reg, byte count, byte *values) {
+		_chip->select(true);
+		_chip->transfer(0x80 | reg);
+		for (byte index = 0; index + 1 < count; index++) {
+			values[index] = _chip->transfer(0x80 | reg);
+		}
+		values[count - 1] = _chip->transfer(0);
+		_chip->select(false);
+	}
+
+private:
+	MFRC522Emulator *_chip;
+};
+
+#endif
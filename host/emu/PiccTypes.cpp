@@ -0,0 +1,344 @@
+/**
+ * Virtual card types, see PiccTypes.h.
+ */
+#include "PiccTypes.h"
+#include <string.h>
+
+using Iso14443::Frame;
+
+// ---------------------------------------------------------------------------------------------------
+// MIFARE Classic
+// ---------------------------------------------------------------------------------------------------
+
+MifareClassic::MifareClassic(const uint8_t *uid, uint8_t uidSize, bool fourK)
+	: VirtualPicc(uid, uidSize, fourK ? 0x18 : 0x08, fourK ? 4096 : 1024,
+		(uidSize == 4 ? 0x00 : 0x40) | (fourK ? 0x02 : 0x04)),
+	  _sector(-1), _writeBlock(-1), _authentications(0) {
+	std::vector<uint8_t> &data = memory();
+	// Manufacturer block: UID (with BCC for 4 bytes), SAK, ATQA
+	memcpy(&data[0], uid, uidSize);
+	uint8_t offset = uidSize;
+	if (uidSize == 4) {
+		data[4] = uid[0] ^ uid[1] ^ uid[2] ^ uid[3];
+		offset = 5;
+	}
+	data[offset] = sak();
+	data[offset + 1] = fourK ? 0x02 : 0x04;
+	data[offset + 2] = uidSize == 4 ? 0x00 : 0x40;
+	// Sector trailers: key A, access bits FF 07 80, 69, key B
+	static const uint8_t trailer[16] = {
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x07, 0x80, 0x69, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+	};
+	for (uint8_t sector = 0; trailerOf(sector) < blocks(); sector++) {
+		memcpy(&data[trailerOf(sector) * 16], trailer, 16);
+	}
+}
+
+bool MifareClassic::authenticate(uint8_t command, uint8_t block, const uint8_t *key, const uint8_t *uid) {
+	_sector = -1;
+	if (block >= blocks() || (command != CMD_AUTH_KEY_A && command != CMD_AUTH_KEY_B)
+			|| memcmp(uid, this->uid() + uidSize() - 4, 4) != 0) {
+		reject();
+		return false;
+	}
+	const uint8_t *trailer = &memory()[trailerOf(sectorOf(block)) * 16];
+	if (memcmp(key, command == CMD_AUTH_KEY_A ? trailer : trailer + 10, 6) != 0) {
+		reject();
+		return false;
+	}
+	_sector = sectorOf(block);
+	_authenticated = true;
+	_authentications++;
+	return true;
+}
+
+void MifareClassic::activated() {
+	_sector = -1;
+	_writeBlock = -1;
+}
+
+bool MifareClassic::command(const Frame &request, Frame &reply) {
+	if (_writeBlock >= 0 && request.bits == 128) {
+		// Second step of WRITE: the data
+		memcpy(&memory()[_writeBlock * 16], request.data.data(), 16);
+		_writeBlock = -1;
+		reply.appendBits(ACK, 4);
+		return true;
+	}
+	_writeBlock = -1;
+	if (request.bits != 16 || (request.data[0] != CMD_READ && request.data[0] != CMD_WRITE)) {
+		return false;
+	}
+	uint8_t block = request.data[1];
+	if (!_authenticated || block >= blocks() || sectorOf(block) != _sector || (request.data[0] == CMD_WRITE && block == 0)) {
+		reply.appendBits(NAK_NOT_ALLOWED, 4);
+		reject();
+		return true;
+	}
+	if (request.data[0] == CMD_WRITE) {
+		_writeBlock = block;
+		reply.appendBits(ACK, 4);
+		return true;
+	}
+	uint8_t data[16];
+	memcpy(data, &memory()[block * 16], 16);
+	if (block == trailerOf(_sector)) {
+		memset(data, 0, 6);		// Key A is never readable
+	}
+	reply.append(data, 16);
+	reply.appendCrc();
+	return true;
+}
+
+// ---------------------------------------------------------------------------------------------------
+// MIFARE Ultralight and NTAG216
+// ---------------------------------------------------------------------------------------------------
+
+MifareUltralight::MifareUltralight(const uint8_t *uid, Type type)
+	: VirtualPicc(uid, 7, 0x00, type == NTAG216 ? 231 * 4 : 16 * 4), _type(type), _compatPage(-1) {
+	std::vector<uint8_t> &data = memory();
+	// Pages 0 to 2: UID with both check bytes, page 3: OTP or capability container
+	memcpy(&data[0], uid, 3);
+	data[3] = CASCADE_TAG ^ uid[0] ^ uid[1] ^ uid[2];
+	memcpy(&data[4], uid + 3, 4);
+	data[8] = uid[3] ^ uid[4] ^ uid[5] ^ uid[6];
+	data[9] = 0x48;
+	if (type == NTAG216) {
+		static const uint8_t cc[4] = {0xE1, 0x10, 0x6D, 0x00};
+		memcpy(&data[12], cc, 4);
+	}
+}
+
+bool MifareUltralight::nak(Frame &reply) {
+	reply.appendBits(NAK, 4);
+	reject();
+	return true;
+}
+
+bool MifareUltralight::command(const Frame &request, Frame &reply) {
+	std::vector<uint8_t> &data = memory();
+	if (_compatPage >= 0 && request.bits == 128) {
+		// Second step of COMPATIBILITY WRITE, only the first 4 bytes are written
+		memcpy(&data[_compatPage * 4], request.data.data(), 4);
+		_compatPage = -1;
+		reply.appendBits(ACK, 4);
+		return true;
+	}
+	_compatPage = -1;
+	uint8_t cmd = request.data[0];
+	if (cmd == CMD_READ && request.bits == 16) {
+		// 4 pages, rolling over to page 0 at the end
+		uint8_t page = request.data[1];
+		if (page >= pages()) {
+			return nak(reply);
+		}
+		for (uint8_t i = 0; i < 16; i++) {
+			reply.append(data[((page * 4) + i) % data.size()]);
+		}
+		reply.appendCrc();
+		return true;
+	}
+	if (cmd == CMD_WRITE && request.bits == 48) {
+		uint8_t page = request.data[1];
+		if (page < 2 || page >= pages()) {
+			return nak(reply);
+		}
+		if (page == 2) {
+			// Serial number check byte and internal byte stay, lock bits can only be set
+			data[10] |= request.data[4];
+			data[11] |= request.data[5];
+		} else if (page == 3 && _type == ULTRALIGHT) {
+			for (uint8_t i = 0; i < 4; i++) {
+				data[12 + i] |= request.data[2 + i];	// OTP bits
+			}
+		} else {
+			memcpy(&data[page * 4], request.data.data() + 2, 4);
+		}
+		reply.appendBits(ACK, 4);
+		return true;
+	}
+	if (cmd == CMD_COMPAT_WRITE && request.bits == 16) {
+		uint8_t page = request.data[1];
+		if (page < 4 || page >= pages()) {
+			return nak(reply);
+		}
+		_compatPage = page;
+		reply.appendBits(ACK, 4);
+		return true;
+	}
+	if (cmd == CMD_FAST_READ && request.bits == 24 && _type == NTAG216) {
+		// Pages start to end, as many as asked for: more than the 64 byte FIFO of the MFRC522 overflows it
+		uint8_t start = request.data[1];
+		uint8_t end = request.data[2];
+		if (start > end || end >= pages()) {
+			return nak(reply);
+		}
+		reply.append(&data[start * 4], (end - start + 1) * 4);
+		reply.appendCrc();
+		return true;
+	}
+	if (cmd == CMD_GET_VERSION && request.bits == 8 && _type == NTAG216) {
+		static const uint8_t version[8] = {0x00, 0x04, 0x04, 0x02, 0x01, 0x00, 0x13, 0x03};
+		reply.append(version, 8);
+		reply.appendCrc();
+		return true;
+	}
+	return false;
+}
+
+// ---------------------------------------------------------------------------------------------------
+// ISO/IEC 14443-4
+// ---------------------------------------------------------------------------------------------------
+
+IsoDepPicc::IsoDepPicc(const uint8_t *uid, uint8_t uidSize, const uint8_t *ats, uint8_t atsLength)
+	: VirtualPicc(uid, uidSize, 0x20, 0), _layer4(false), _fsd(256), _blockNumber(0), _apdus(0) {
+	// TL, T0 (TA, TB, TC follow, FSCI 8 = 256 bytes), TA (same D only, 106kbit/s), TB (FWI 7), TC (CID)
+	static const uint8_t defaultAts[] = {0x05, 0x78, 0x80, 0x70, 0x02};
+	if (ats == nullptr || atsLength == 0 || atsLength > sizeof(_ats)) {
+		ats = defaultAts;
+		atsLength = sizeof(defaultAts);
+	}
+	memcpy(_ats, ats, atsLength);
+	_atsLength = atsLength;
+}
+
+void IsoDepPicc::apdu(const uint8_t *command, size_t length, std::vector<uint8_t> &response) {
+	(void)command;
+	(void)length;
+	response.push_back(0x90);
+	response.push_back(0x00);
+}
+
+bool IsoDepPicc::supportsCid() const {
+	uint8_t t0 = _atsLength > 1 ? _ats[1] : 0x00;
+	if (!(t0 & 0x40)) {
+		return true;
+	}
+	size_t tc = 2 + ((t0 & 0x10) ? 1 : 0) + ((t0 & 0x20) ? 1 : 0);
+	return tc < _atsLength && (_ats[tc] & 0x02);
+}
+
+uint16_t IsoDepPicc::fsc() const {
+	static const uint16_t fscs[9] = {16, 24, 32, 40, 48, 64, 96, 128, 256};
+	uint8_t fsci = _atsLength > 1 ? (_ats[1] & 0x0F) : 2;
+	return fsci < 9 ? fscs[fsci] : 256;
+}
+
+bool IsoDepPicc::command(const Frame &request, Frame &reply) {
+	if (!_layer4) {
+		if (request.bits != 16 || request.data[0] != CMD_RATS) {
+			return false;
+		}
+		static const uint16_t fsds[9] = {16, 24, 32, 40, 48, 64, 96, 128, 256};
+		uint8_t fsdi = request.data[1] >> 4;
+		_fsd = fsdi < 9 ? fsds[fsdi] : 256;
+		_layer4 = true;
+		_blockNumber = 1;	// So the first I-block of the reader, number 0, is new
+		reply.append(_ats, _atsLength);
+		reply.appendCrc();
+		_last = reply;
+		return true;
+	}
+	if (request.bytes() + 2 > fsc()) {		// CRC_A included
+		return false;
+	}
+	uint8_t pcb = request.data[0];
+	size_t header = 1 + ((pcb & 0x08) ? 1 : 0) + ((pcb & 0x04) ? 1 : 0);
+	if (request.bytes() < header) {
+		return false;
+	}
+	uint8_t cid = (pcb & 0x08) ? request.data[1] : 0;
+	if ((pcb & 0x08) && !supportsCid()) {
+		return false;		// A card without CID ignores blocks with one
+	}
+	if ((pcb & 0xE2) == 0x02) {
+		// I-block. A chained block is acknowledged with R(ACK), the last one answered
+		_blockNumber = pcb & 0x01;
+		bool chained = pcb & 0x10;
+		std::vector<uint8_t> response;
+		_chain.insert(_chain.end(), request.data.begin() + header, request.data.begin() + request.bytes());
+		if (!chained) {
+			apdu(_chain.data(), _chain.size(), response);
+			_chain.clear();
+			_apdus++;
+		}
+		reply.append((chained ? 0xA2 : 0x02) | (pcb & 0x08) | _blockNumber);
+		if (pcb & 0x08) {
+			reply.append(cid);
+		}
+		if (reply.bytes() + response.size() + 2 > _fsd) {
+			return false;
+		}
+		reply.append(response.data(), response.size());
+		reply.appendCrc();
+		_last = reply;
+		return true;
+	}
+	if ((pcb & 0xE6) == 0xA2) {
+		if ((pcb & 0x10) && (pcb & 0x01) != _blockNumber) {
+			// R(NAK) with the other block number, the reader checks that the card is there: R(ACK)
+			reply.append(0xA2 | (pcb & 0x08) | _blockNumber);
+			if (pcb & 0x08) {
+				reply.append(cid);
+			}
+			reply.appendCrc();
+			return true;
+		}
+		// The reader missed our last block
+		uint8_t rate = reply.rate;
+		reply = _last;
+		reply.rate = rate;
+		return true;
+	}
+	if ((pcb & 0xF0) == 0xD0 && request.bytes() >= 2) {
+		// PPS, answered with PPSS at the old rates. DSI and DRI must be offered by TA(1), same D if it says so
+		uint8_t dsi = 0;
+		uint8_t dri = 0;
+		if (request.data[1] & 0x10) {
+			if (request.bytes() < 3) {
+				return false;
+			}
+			dsi = (request.data[2] >> 2) & 0x03;
+			dri = request.data[2] & 0x03;
+		}
+		uint8_t ta = (_atsLength > 2 && (_ats[1] & 0x10)) ? _ats[2] : 0x00;
+		bool offered = (dsi == 0 || (ta & (0x10 << (dsi - 1)))) && (dri == 0 || (ta & (0x01 << (dri - 1))));
+		if (!offered || ((ta & 0x80) && dsi != dri)) {
+			return false;
+		}
+		reply.append(pcb);
+		reply.appendCrc();
+		_last = reply;
+		_txRate = dsi;
+		_rxRate = dri;
+		return true;
+	}
+	if ((pcb & 0xF7) == 0xC2) {
+		// S(DESELECT), answered before the card goes to HALT
+		reply.append(request.data.data(), header);
+		reply.appendCrc();
+		_state = HALT;
+		_layer4 = false;
+		return true;
+	}
+	return false;
+}
+
+// ---------------------------------------------------------------------------------------------------
+
+VirtualPicc *createPicc(const uint8_t *uid, uint8_t uidSize, unsigned variant) {
+	if (uidSize == 4) {
+		return new MifareClassic(uid, uidSize, variant % 8 == 7);
+	}
+	if (uidSize == 7) {
+		switch (variant % 3) {
+			case 0:
+				return new MifareUltralight(uid, MifareUltralight::ULTRALIGHT);
+			case 1:
+				return new MifareUltralight(uid, MifareUltralight::NTAG216);
+			default:
+				return new MifareClassic(uid, uidSize);
+		}
+	}
+	return new IsoDepPicc(uid, uidSize);
+}
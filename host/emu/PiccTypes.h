@@ -0,0 +1,115 @@
+/**
+ * Virtual cards of the common types, on top of the ISO/IEC 14443-3 behaviour of VirtualPicc.
+ *
+ *   MifareClassic     1K or 4K, key A/B authentication per sector, READ and the two step WRITE
+ *   MifareUltralight  Ultralight (16 pages) or NTAG216 (231 pages), READ, WRITE, COMPATIBILITY
+ *                     WRITE, GET_VERSION and FAST_READ on NTAG
+ *   IsoDepPicc        ISO/IEC 14443-4: RATS and ATS, PPS to the bit rates of TA(1), I-blocks answered
+ *                     by apdu(), R-blocks, DESELECT. Blocks with a CID are ignored if TC(1) has no
+ *                     CID support, frames longer than the FSC too. Chained I-blocks are joined to
+ *                     one command. The answer is not chained: one longer than the FSD of the reader
+ *                     is not sent
+ *
+ * createPicc() picks a type fitting a UID, so a roster turns into a mixed population.
+ */
+#ifndef PiccTypes_h
+#define PiccTypes_h
+
+#include "VirtualPicc.h"
+
+class MifareClassic : public VirtualPicc {
+public:
+	static const uint8_t CMD_AUTH_KEY_A = 0x60;
+	static const uint8_t CMD_AUTH_KEY_B = 0x61;
+	static const uint8_t CMD_WRITE = 0xA0;
+	static const uint8_t NAK_NOT_ALLOWED = 0x4;
+
+	/**
+	 * Fresh card: manufacturer block, all keys FFFFFFFFFFFF, transport access bits.
+	 */
+	MifareClassic(const uint8_t *uid, uint8_t uidSize, bool fourK = false);
+
+	uint16_t blocks() const { return (uint16_t)(memory().size() / 16); }
+	static uint8_t sectorOf(uint8_t block) { return block < 128 ? block / 4 : 32 + (block - 128) / 16; }
+	static uint16_t trailerOf(uint8_t sector) { return sector < 32 ? sector * 4 + 3 : 128 + (sector - 32) * 16 + 15; }
+
+	bool authenticate(uint8_t command, uint8_t block, const uint8_t *key, const uint8_t *uid) override;
+	unsigned long authentications() const { return _authentications; }
+
+protected:
+	bool command(const Iso14443::Frame &request, Iso14443::Frame &reply) override;
+	void activated() override;
+
+private:
+	int _sector;			// Authenticated sector, -1 if none
+	int _writeBlock;		// Block of a WRITE waiting for its data, -1 if none
+	unsigned long _authentications;
+};
+
+class MifareUltralight : public VirtualPicc {
+public:
+	enum Type { ULTRALIGHT, NTAG216 };
+
+	static const uint8_t CMD_GET_VERSION = 0x60;
+	static const uint8_t CMD_FAST_READ = 0x3A;
+	static const uint8_t CMD_WRITE = 0xA2;
+	static const uint8_t CMD_COMPAT_WRITE = 0xA0;
+
+	MifareUltralight(const uint8_t *uid, Type type = ULTRALIGHT);
+
+	Type type() const { return _type; }
+	uint16_t pages() const { return (uint16_t)(memory().size() / 4); }
+
+protected:
+	bool command(const Iso14443::Frame &request, Iso14443::Frame &reply) override;
+	void activated() override { _compatPage = -1; }
+
+	bool nak(Iso14443::Frame &reply);
+
+	Type _type;
+	int _compatPage;		// Page of a COMPATIBILITY WRITE waiting for its data, -1 if none
+};
+
+class IsoDepPicc : public VirtualPicc {
+public:
+	static const uint8_t CMD_RATS = 0xE0;
+
+	/**
+	 * ats is the answer to RATS without CRC, TL first. The default offers FSC 256 and 106kbit/s only.
+	 * The bit rates PPS may pick are those of TA(1), if T0 says it is there.
+	 */
+	IsoDepPicc(const uint8_t *uid, uint8_t uidSize, const uint8_t *ats = nullptr, uint8_t atsLength = 0);
+
+	bool layer4() const { return _layer4; }
+	uint16_t fsd() const { return _fsd; }	// Frame size the reader asked for with RATS
+	const uint8_t *ats() const { return _ats; }
+	unsigned long apdus() const { return _apdus; }
+
+protected:
+	bool command(const Iso14443::Frame &request, Iso14443::Frame &reply) override;
+	void activated() override { _layer4 = false; _chain.clear(); }
+	bool supportsCid() const;		// TC(1) of the ATS, blocks with a CID are ignored without
+	uint16_t fsc() const;			// FSCI of the ATS, longer frames are not received
+
+	/**
+	 * Answers a command APDU. The default is status word 9000 and no data.
+	 */
+	virtual void apdu(const uint8_t *command, size_t length, std::vector<uint8_t> &response);
+
+	uint8_t _ats[20];
+	uint8_t _atsLength;
+	bool _layer4;			// RATS done
+	uint16_t _fsd;
+	uint8_t _blockNumber;	// Of the last I-block received
+	Iso14443::Frame _last;	// Last block sent, repeated on R(NAK)
+	std::vector<uint8_t> _chain;	// INF of the chained I-blocks received so far
+	unsigned long _apdus;
+};
+
+/**
+ * A card for the UID: 4 bytes MIFARE Classic 1K (every 8th a 4K), 7 bytes Ultralight, NTAG216 or
+ * Classic 1K in turn, 10 bytes ISO 14443-4. variant spreads the types over a population.
+ */
+VirtualPicc *createPicc(const uint8_t *uid, uint8_t uidSize, unsigned variant);
+
+#endif
@@ -0,0 +1,281 @@
+/**
+ * ISO/IEC 14443-3 type A card and field, see VirtualPicc.h.
+ */
+#include "VirtualPicc.h"
+#include <string.h>
+#include <algorithm>
+
+using Iso14443::Frame;
+
+VirtualPicc::VirtualPicc(const uint8_t *uid, uint8_t uidSize, uint8_t sak, size_t memorySize, uint16_t atqa)
+	: _state(POWER_OFF), _authenticated(false), _rxRate(Iso14443::RATE_106), _txRate(Iso14443::RATE_106),
+	  _uidSize(uidSize), _sak(sak), _memory(memorySize, 0),
+	  _level(0), _fromHalt(false), _responseDelay(Iso14443::FDT_NS) {
+	memcpy(_uid, uid, uidSize);
+	if (atqa == 0) {
+		// UID size in bits 7..6, bit frame anticollision
+		atqa = (uidSize == 4 ? 0x00 : uidSize == 7 ? 0x40 : 0x80) | 0x04;
+	}
+	_atqa[0] = atqa & 0xFF;
+	_atqa[1] = atqa >> 8;
+}
+
+void VirtualPicc::powerOn() {
+	if (_state == POWER_OFF) {
+		_state = IDLE;
+		_authenticated = false;
+	}
+}
+
+void VirtualPicc::powerOff() {
+	_state = POWER_OFF;
+	_authenticated = false;
+}
+
+void VirtualPicc::reject() {
+	if (_state == READY || _state == ACTIVE) {
+		_state = _fromHalt ? HALT : IDLE;
+	}
+	_authenticated = false;
+}
+
+void VirtualPicc::cascadeLevel(uint8_t level, uint8_t *out) const {
+	bool last = level + 1 == cascadeLevels();
+	if (last) {
+		memcpy(out, _uid + level * 3, 4);
+	} else {
+		out[0] = CASCADE_TAG;
+		memcpy(out + 1, _uid + level * 3, 3);
+	}
+	out[4] = out[0] ^ out[1] ^ out[2] ^ out[3];
+}
+
+bool VirtualPicc::receive(const Frame &request, Frame &reply) {
+	if (_state == POWER_OFF) {
+		return false;
+	}
+	if (_state != ACTIVE) {
+		_rxRate = Iso14443::RATE_106;
+		_txRate = Iso14443::RATE_106;
+	}
+	if (request.rate != _rxRate) {
+		return false;		// Not even noise the card could take for a frame
+	}
+	reply.rate = _txRate;
+	// Short frame: REQA or WUPA
+	if (request.bits == 7) {
+		uint8_t cmd = request.data[0] & 0x7F;
+		bool wakeUp = cmd == CMD_WUPA && _state == HALT;
+		if ((cmd == CMD_REQA || cmd == CMD_WUPA) && (_state == IDLE || wakeUp)) {
+			_fromHalt = wakeUp;
+			_state = READY;
+			_level = 0;
+			reply.append(_atqa, 2);
+			return true;
+		}
+		// A request in READY or ACTIVE is a protocol error for the card
+		reject();
+		return false;
+	}
+	if (_state == IDLE || _state == HALT) {
+		return false;
+	}
+	if (request.encrypted != _authenticated) {
+		// Frames the card cannot decipher
+		reject();
+		return false;
+	}
+	if (_state == READY) {
+		if (!select(request, reply)) {
+			return false;
+		}
+		return true;
+	}
+	// ACTIVE
+	if (!request.crcValid()) {
+		reject();
+		return false;
+	}
+	Frame payload;
+	payload.append(request.data.data(), request.bytes() - 2);
+	payload.rate = request.rate;
+	payload.encrypted = request.encrypted;
+	if (payload.bits == 16 && payload.data[0] == CMD_HLTA && payload.data[1] == 0x00) {
+		_state = HALT;
+		_authenticated = false;
+		return false;
+	}
+	if (!command(payload, reply)) {
+		reject();
+		return false;
+	}
+	return reply.bits > 0;
+}
+
+bool VirtualPicc::select(const Frame &request, Frame &reply) {
+	if (request.bits < 16 || request.data[0] != CMD_SEL_CL1 + 2 * _level) {
+		reject();
+		return false;
+	}
+	uint8_t cl[5];
+	cascadeLevel(_level, cl);
+	uint8_t nvb = request.data[1];
+	if (nvb == 0x70) {
+		// SELECT: all 40 bits and the CRC
+		if (request.bits != 72 || !request.crcValid()) {
+			reject();
+			return false;
+		}
+		if (memcmp(request.data.data() + 2, cl, 5) != 0) {
+			return false;	// Another card is selected, stay READY
+		}
+		if (_level + 1 == cascadeLevels()) {
+			_state = ACTIVE;
+			activated();
+			reply.append(_sak);
+		} else {
+			_level++;
+			reply.append(0x04);	// Cascade bit, UID not complete
+		}
+		reply.appendCrc();
+		return true;
+	}
+	// ANTICOLLISION: the reader sends the bits it knows, cards matching them send the rest
+	unsigned int known = ((nvb >> 4) - 2) * 8 + (nvb & 0x07);
+	if ((nvb >> 4) < 2 || (nvb & 0x07) > 7 || known > 32 || request.bits != 16 + known) {
+		reject();
+		return false;
+	}
+	Frame mine;
+	mine.append(cl, 5);
+	for (unsigned int i = 0; i < known; i++) {
+		if (request.bitAt(16 + i) != mine.bitAt(i)) {
+			return false;
+		}
+	}
+	for (unsigned int i = known; i < 40; i++) {
+		reply.appendBits(mine.bitAt(i), 1);
+	}
+	return true;
+}
+
+bool VirtualPicc::command(const Frame &request, Frame &reply) {
+	if (request.bits == 16 && request.data[0] == CMD_READ) {
+		// 16 bytes from the block, wrapping around the end of the memory
+		size_t blocks = _memory.size() / 16;
+		if (request.data[1] >= blocks) {
+			reply.appendBits(NAK, 4);
+			return true;
+		}
+		reply.append(&_memory[request.data[1] * 16], 16);
+		reply.appendCrc();
+		return true;
+	}
+	return false;
+}
+
+bool VirtualPicc::authenticate(uint8_t command, uint8_t block, const uint8_t *key, const uint8_t *uid) {
+	(void)command;
+	(void)block;
+	(void)key;
+	(void)uid;
+	return false;
+}
+
+// ---------------------------------------------------------------------------------------------------
+// PiccField
+// ---------------------------------------------------------------------------------------------------
+
+void PiccField::add(VirtualPicc *picc) {
+	if (contains(picc)) {
+		return;
+	}
+	_cards.push_back(picc);
+	if (_powered) {
+		picc->powerOn();
+	}
+}
+
+void PiccField::remove(VirtualPicc *picc) {
+	_cards.erase(std::remove(_cards.begin(), _cards.end(), picc), _cards.end());
+	picc->powerOff();
+}
+
+bool PiccField::contains(const VirtualPicc *picc) const {
+	return std::find(_cards.begin(), _cards.end(), picc) != _cards.end();
+}
+
+void PiccField::setPowered(bool on) {
+	if (on == _powered) {
+		return;
+	}
+	_powered = on;
+	for (VirtualPicc *picc : _cards) {
+		if (on) {
+			picc->powerOn();
+		} else {
+			picc->powerOff();
+		}
+	}
+}
+
+bool PiccField::exchange(const Frame &request, Reply &reply) {
+	reply.frame = Frame();
+	reply.collision = -1;
+	reply.delay = 0;
+	if (!_powered) {
+		return false;
+	}
+	bool answered = false;
+	Frame first;		// Two answers disagreeing at a bit, one of them disagrees with the first answer there or before
+	for (VirtualPicc *picc : _cards) {
+		Frame answer;
+		answer.rate = request.rate;
+		if (!picc->receive(request, answer)) {
+			continue;
+		}
+		if (!answered) {
+			reply.frame = answer;
+			reply.delay = picc->responseDelay();
+			first = answer;
+			answered = true;
+			continue;
+		}
+		// Superimpose: the reader sees a collision at the first bit any two answers disagree on
+		size_t bits = std::min(first.bits, answer.bits);
+		size_t collision = bits;
+		for (size_t i = 0; i < bits; i++) {
+			if (first.bitAt(i) != answer.bitAt(i)) {
+				collision = i;
+				break;
+			}
+		}
+		if (collision < bits || answer.bits != first.bits) {
+			if (reply.collision < 0 || (int)collision < reply.collision) {
+				reply.collision = (int)collision;
+			}
+		}
+		for (size_t i = 0; i < answer.data.size() && i < reply.frame.data.size(); i++) {
+			reply.frame.data[i] |= answer.data[i];
+		}
+		if (answer.bits > reply.frame.bits) {
+			reply.frame.data.insert(reply.frame.data.end(), answer.data.begin() + reply.frame.data.size(), answer.data.end());
+			reply.frame.bits = answer.bits;
+		}
+		reply.delay = std::min(reply.delay, picc->responseDelay());
+	}
+	return answered;
+}
+
+bool PiccField::authenticate(uint8_t command, uint8_t block, const uint8_t *key, const uint8_t *uid) {
+	if (!_powered) {
+		return false;
+	}
+	bool accepted = false;
+	for (VirtualPicc *picc : _cards) {
+		if (picc->state() == VirtualPicc::ACTIVE && picc->authenticate(command, block, key, uid)) {
+			accepted = true;
+		}
+	}
+	return accepted;
+}
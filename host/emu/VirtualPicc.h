@@ -0,0 +1,140 @@
+/**
+ * A proximity card in the field of the emulated MFRC522.
+ *
+ * VirtualPicc implements ISO/IEC 14443-3 type A: the IDLE, READY, ACTIVE and HALT states, REQA and
+ * WUPA, the anticollision loop and SELECT over up to three cascade levels, and HLTA. In the ACTIVE
+ * state it answers READ from a memory of 16 byte blocks. Card types with more commands derive from
+ * it and override command().
+ *
+ * PiccField is the RF field: the cards in it hear every frame the reader sends, their answers are
+ * superimposed bit by bit, so two cards answering differently cause a collision.
+ */
+#ifndef VirtualPicc_h
+#define VirtualPicc_h
+
+#include "Iso14443.h"
+
+class VirtualPicc {
+public:
+	enum State { POWER_OFF, IDLE, READY, ACTIVE, HALT };
+
+	// Commands
+	static const uint8_t CMD_REQA = 0x26;
+	static const uint8_t CMD_WUPA = 0x52;
+	static const uint8_t CMD_SEL_CL1 = 0x93;
+	static const uint8_t CMD_HLTA = 0x50;
+	static const uint8_t CMD_READ = 0x30;
+	static const uint8_t CASCADE_TAG = 0x88;
+
+	// 4 bit answers
+	static const uint8_t ACK = 0xA;
+	static const uint8_t NAK = 0x0;
+
+	/**
+	 * uidSize is 4, 7 or 10. The ATQA follows from the UID size unless given.
+	 */
+	VirtualPicc(const uint8_t *uid, uint8_t uidSize, uint8_t sak, size_t memorySize, uint16_t atqa = 0);
+	virtual ~VirtualPicc() {}
+
+	const uint8_t *uid() const { return _uid; }
+	uint8_t uidSize() const { return _uidSize; }
+	uint8_t sak() const { return _sak; }
+	State state() const { return _state; }
+	std::vector<uint8_t> &memory() { return _memory; }
+	const std::vector<uint8_t> &memory() const { return _memory; }
+
+	void powerOn();
+	void powerOff();
+
+	/**
+	 * Handles a frame from the reader. Returns true and fills reply if the card answers.
+	 */
+	bool receive(const Iso14443::Frame &request, Iso14443::Frame &reply);
+
+	/**
+	 * Three pass MIFARE authentication, the reader's MFAuthent command. Crypto1 itself is not
+	 * modelled: the card compares the key and from then on expects encrypted frames.
+	 */
+	virtual bool authenticate(uint8_t command, uint8_t block, const uint8_t *key, const uint8_t *uid);
+
+	/**
+	 * Time from the end of a request to the start of the answer.
+	 */
+	uint64_t responseDelay() const { return _responseDelay; }
+	void setResponseDelay(uint64_t ns) { _responseDelay = ns; }
+
+protected:
+	/**
+	 * ACTIVE state command with a valid CRC, data without the CRC. Returns false for a command the
+	 * card does not know, which sends it back to IDLE (or HALT).
+	 */
+	virtual bool command(const Iso14443::Frame &request, Iso14443::Frame &reply);
+
+	/**
+	 * The card was just selected, commands of an earlier activation no longer apply.
+	 */
+	virtual void activated() {}
+
+	/**
+	 * Leaves READY or ACTIVE after an unexpected frame.
+	 */
+	void reject();
+
+	State _state;
+	bool _authenticated;
+	uint8_t _rxRate;		// Iso14443::BitRate of the frames the ACTIVE card understands, 106kbit/s in the other states
+	uint8_t _txRate;		// And of its answers
+
+private:
+	void cascadeLevel(uint8_t level, uint8_t *out) const;	// 4 UID bytes (CT first if not the last) and BCC
+	uint8_t cascadeLevels() const { return _uidSize == 4 ? 1 : _uidSize == 7 ? 2 : 3; }
+	bool select(const Iso14443::Frame &request, Iso14443::Frame &reply);
+
+	uint8_t _uid[10];
+	uint8_t _uidSize;
+	uint8_t _sak;
+	uint8_t _atqa[2];
+	std::vector<uint8_t> _memory;
+	uint8_t _level;			// Cascade level of the anticollision loop in READY
+	bool _fromHalt;			// Woken up from HALT, falls back there
+	uint64_t _responseDelay;
+};
+
+class PiccField {
+public:
+	struct Reply {
+		Iso14443::Frame frame;
+		int collision;		// First bit where the answers differ, -1 if none
+		uint64_t delay;		// From the end of the request to the start of the answer
+	};
+
+	/**
+	 * Puts a card into the field. It powers up if the reader's antenna is on.
+	 */
+	void add(VirtualPicc *picc);
+	void remove(VirtualPicc *picc);
+	bool contains(const VirtualPicc *picc) const;
+	const std::vector<VirtualPicc *> &cards() const { return _cards; }
+
+	/**
+	 * Antenna on or off. Switching off resets all cards.
+	 */
+	void setPowered(bool on);
+	bool powered() const { return _powered; }
+
+	/**
+	 * Sends a frame to all cards. Returns true if at least one answered.
+	 */
+	bool exchange(const Iso14443::Frame &request, Reply &reply);
+
+	/**
+	 * MIFARE authentication of the selected card, false if no card accepts the key.
+	 */
+	bool authenticate(uint8_t command, uint8_t block, const uint8_t *key, const uint8_t *uid);
+
+private:
+	std::vector<VirtualPicc *> _cards;
+	bool _powered = false;
+};
+
+#endif
@@ -0,0 +1,157 @@
+/**
+ * Host build of the Arduino core.
+ *
+ * Provides the subset of the Arduino API used by the sketch and the libraries in this repository,
+ * backed by the in-memory models in HostSim.h. Time is virtual: it only advances through delay(),
+ * delayMicroseconds() and the modelled cost of pin, SPI, serial and LCD operations.
+ */
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+typedef unsigned int word;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define LSBFIRST 0
+#define MSBFIRST 1
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+// Pin numbers of an Arduino Uno
+#define SS   10
+#define MOSI 11
+#define MISO 12
+#define SCK  13
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define NUM_DIGITAL_PINS 20
+
+// Port registers of the Uno: PORTD pins 0 to 7, PORTB pins 8 to 13, PORTC A0 to A5. On the host a port
+// register is an object, writing it changes the pins like digitalWrite() does, at the cost of a port write.
+#define NOT_A_PORT 0
+#define PB 2
+#define PC 3
+#define PD 4
+
+class PortRegister {
+public:
+	explicit PortRegister(uint8_t port) : _port(port) {}
+	operator uint8_t() const;
+	PortRegister &operator=(uint8_t value);
+	PortRegister &operator|=(uint8_t bits) { return *this = (uint8_t)(*this | bits); }
+	PortRegister &operator&=(uint8_t bits) { return *this = (uint8_t)(*this & bits); }
+
+private:
+	uint8_t _port;
+};
+
+// The status register of the AVR, only its interrupt flag I (bit 7): saved, cli() and written back, it
+// restores the interrupt state like the AVR core does around a port update
+class StatusRegister {
+public:
+	operator uint8_t() const;
+	StatusRegister &operator=(uint8_t value);
+};
+
+extern StatusRegister SREG;
+
+#define NOT_AN_INTERRUPT -1
+#define digitalPinToInterrupt(p) ((p) == 2 ? 0 : ((p) == 3 ? 1 : NOT_AN_INTERRUPT))
+
+// Flash memory is ordinary memory on the host, the size is that of an Uno
+#define FLASHEND 0x7FFF
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+#define pgm_read_ptr(addr) (*(void * const *)(addr))
+typedef uintptr_t uint_farptr_t;			// Far addresses of the boards with more than 64 KB of flash
+#define pgm_get_far_address(var) ((uint_farptr_t)&(var))
+#define pgm_read_byte_far(addr) pgm_read_byte((uintptr_t)(addr))
+#define pgm_read_word_far(addr) pgm_read_word((uintptr_t)(addr))
+#define pgm_read_dword_far(addr) pgm_read_dword((uintptr_t)(addr))
+#define memcmp_P memcmp
+#define memcpy_P memcpy
+#define strcpy_P strcpy
+#define strlen_P strlen
+#define strcmp_P strcmp
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(string_literal))
+
+#define lowByte(w) ((uint8_t) ((w) & 0xff))
+#define highByte(w) ((uint8_t) ((w) >> 8))
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+#define bit(b) (1UL << (b))
+
+#ifndef __cplusplus
+#error "The host Arduino core needs C++"
+#endif
+
+template<class T, class U> inline auto min(const T &a, const U &b) -> decltype(a < b ? a : b) { return b < a ? b : a; }
+template<class T, class U> inline auto max(const T &a, const U &b) -> decltype(a < b ? a : b) { return a < b ? b : a; }
+template<class T, class L, class H> inline T constrain(T x, L low, H high) { return x < low ? low : (x > high ? high : x); }
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+uint8_t digitalPinToPort(uint8_t pin);
+uint8_t digitalPinToBitMask(uint8_t pin);
+PortRegister *portOutputRegister(uint8_t port);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration = 0);
+void noTone(uint8_t pin);
+
+void attachInterrupt(uint8_t interruptNum, void (*userFunc)(), int mode);
+void detachInterrupt(uint8_t interruptNum);
+void interrupts();
+void noInterrupts();
+inline void cli() { noInterrupts(); }
+inline void sei() { interrupts(); }
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+
+void setup();
+void loop();
+
+#include "WString.h"
+#include "Print.h"
+#include "HardwareSerial.h"
+
+#endif
@@ -0,0 +1,31 @@
+/**
+ * Host build of the Arduino AVR EEPROM library.
+ */
+#include "EEPROM.h"
+#include "HostSim.h"
+#include <string.h>
+
+EEPROMClass EEPROM;
+
+uint8_t EEPROMClass::read(int idx) {
+	HostSim::advance(HostSim::costs().eepromRead);
+	return idx >= 0 && idx < SIZE ? _data[idx] : 0xFF;
+}
+
+void EEPROMClass::write(int idx, uint8_t val) {
+	HostSim::advance(HostSim::costs().eepromWrite);
+	if (idx >= 0 && idx < SIZE) {
+		_data[idx] = val;
+		_writes++;
+	}
+}
+
+void EEPROMClass::update(int idx, uint8_t val) {
+	if (read(idx) != val) {
+		write(idx, val);
+	}
+}
+
+void EEPROMClass::erase() {
+	memset(_data, 0xFF, sizeof(_data));
+}
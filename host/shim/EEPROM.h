@@ -0,0 +1,49 @@
+/**
+ * Host build of the Arduino AVR EEPROM library.
+ *
+ * 1024 bytes in memory, erased (0xFF) at start. HostSim::reset() leaves them alone, like a reset of
+ * the board does. A read costs the time of eeprom_read_byte(), a write the 3.4ms the AVR takes to
+ * erase and program a byte, update() only writes a byte that changes.
+ */
+#ifndef EEPROM_h
+#define EEPROM_h
+
+#include <Arduino.h>
+
+class EEPROMClass {
+public:
+	EEPROMClass() { erase(); }
+
+	uint8_t read(int idx);
+	void write(int idx, uint8_t val);
+	void update(int idx, uint8_t val);
+	uint16_t length() { return SIZE; }
+
+	template <typename T> T &get(int idx, T &t) {
+		uint8_t *bytes = (uint8_t *)&t;
+		for (size_t i = 0; i < sizeof(T); i++) {
+			bytes[i] = read(idx + (int)i);
+		}
+		return t;
+	}
+	template <typename T> const T &put(int idx, const T &t) {
+		const uint8_t *bytes = (const uint8_t *)&t;
+		for (size_t i = 0; i < sizeof(T); i++) {
+			update(idx + (int)i, bytes[i]);
+		}
+		return t;
+	}
+
+	// Host side of the EEPROM
+	void erase();								// All bytes back to 0xFF
+	unsigned long writes() const { return _writes; }	// Bytes programmed so far
+
+private:
+	static const uint16_t SIZE = 1024;			// ATmega328P
+	uint8_t _data[SIZE];
+	unsigned long _writes = 0;
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
@@ -0,0 +1,79 @@
+/**
+ * Host build of the Arduino HardwareSerial class.
+ */
+#include "Arduino.h"
+#include "HostSim.h"
+
+HardwareSerial Serial;
+
+void HardwareSerial::begin(unsigned long baud) {
+	_baud = baud;
+	_busyUntil = HostSim::nanos();
+}
+
+void HardwareSerial::end() {
+	flush();
+	_baud = 0;
+}
+
+uint32_t HardwareSerial::byteTime() const {
+	// Start bit, 8 data bits, stop bit
+	return _baud ? (uint32_t)(10000000000ULL / _baud) : 0;
+}
+
+int HardwareSerial::pendingBytes() const {
+	uint64_t now = HostSim::nanos();
+	if (_busyUntil <= now || byteTime() == 0) {
+		return 0;
+	}
+	// The byte on the wire has already left the buffer
+	return (int)((_busyUntil - now - 1) / byteTime());
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+	HostSim::advance(HostSim::costs().serialWrite);
+	int pending = pendingBytes();
+	if (pending >= SERIAL_TX_BUFFER_SIZE - 1) {
+		// Blocks until the UART has made room for one more byte
+		HostSim::advance((uint64_t)(pending - (SERIAL_TX_BUFFER_SIZE - 2)) * byteTime());
+	}
+	uint64_t now = HostSim::nanos();
+	_busyUntil = (_busyUntil > now ? _busyUntil : now) + byteTime();
+	_output.push_back((char)c);
+	HostSim::stats().serialBytes++;
+	return 1;
+}
+
+int HardwareSerial::availableForWrite() {
+	HostSim::advance(HostSim::costs().serialStatus);
+	return SERIAL_TX_BUFFER_SIZE - 1 - pendingBytes();
+}
+
+int HardwareSerial::available() {
+	HostSim::advance(HostSim::costs().serialStatus);
+	return (int)_input.size();
+}
+
+int HardwareSerial::read() {
+	if (_input.empty()) {
+		return -1;
+	}
+	uint8_t c = _input.front();
+	_input.pop_front();
+	return c;
+}
+
+int HardwareSerial::peek() {
+	return _input.empty() ? -1 : _input.front();
+}
+
+void HardwareSerial::flush() {
+	uint64_t now = HostSim::nanos();
+	if (_busyUntil > now) {
+		HostSim::advance(_busyUntil - now);
+	}
+}
+
+void HardwareSerial::inject(const std::string &data) {
+	_input.insert(_input.end(), data.begin(), data.end());
+}
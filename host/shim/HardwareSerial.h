@@ -0,0 +1,52 @@
+/**
+ * Host build of the Arduino HardwareSerial class.
+ *
+ * Models the UART of an Uno: a 64 byte transmit buffer drained at the configured baud rate
+ * (10 bits per byte). Writing into a full buffer blocks, ie it advances the virtual clock
+ * until there is room again, just like the original.
+ */
+#ifndef HardwareSerial_h
+#define HardwareSerial_h
+
+#include <stdint.h>
+#include <string>
+#include <deque>
+#include "Print.h"
+
+#ifndef SERIAL_TX_BUFFER_SIZE
+#define SERIAL_TX_BUFFER_SIZE 64
+#endif
+
+class HardwareSerial : public Stream {
+public:
+	void begin(unsigned long baud);
+	void end();
+	size_t write(uint8_t c) override;
+	using Print::write;
+	int availableForWrite() override;
+	int available() override;
+	int read() override;
+	int peek() override;
+	void flush() override;
+	operator bool() { return true; }
+
+	// Host side of the port
+	const std::string &output() const { return _output; }	// Everything written so far
+	void clearOutput() { _output.clear(); }
+	void inject(const std::string &data);					// Bytes the PC sends to the sketch
+	unsigned long baud() const { return _baud; }
+	uint64_t busyUntil() const { return _busyUntil; }		// Virtual time when the last byte leaves the UART
+
+private:
+	unsigned long _baud = 0;
+	uint64_t _busyUntil = 0;		// Transmit buffer drains until this point in time
+	std::string _output;
+	std::deque<uint8_t> _input;
+
+	uint32_t byteTime() const;
+	int pendingBytes() const;
+};
+
+extern HardwareSerial Serial;
+
+#endif
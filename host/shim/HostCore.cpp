@@ -0,0 +1,403 @@
+/**
+ * Host build of the Arduino core: virtual clock, pins, interrupts and the HostSim control interface.
+ */
+#include "Arduino.h"
+#include "HostSim.h"
+#include "SPI.h"
+#include <vector>
+#include <algorithm>
+
+namespace {
+
+struct Pin {
+	uint8_t mode;
+	uint8_t level;
+	unsigned long writes;
+	SPIDevice *device;			// Chip on the SPI bus selected by this pin, if any
+	HostSim::PinListener *listener;
+};
+
+struct Interrupt {
+	void (*handler)();
+	int mode;
+	bool pending;
+};
+
+uint64_t now = 0;
+Pin pins[NUM_DIGITAL_PINS];
+Interrupt isr[2];
+bool interruptsEnabled = true;
+bool inInterrupt = false;
+HostSim::Costs costTable;
+HostSim::Stats counters;
+std::vector<HostSim::ClockListener *> listeners;
+unsigned long randomState = 1;
+
+void runInterrupt(uint8_t num) {
+	if (!interruptsEnabled || inInterrupt) {
+		isr[num].pending = true;
+		return;
+	}
+	isr[num].pending = false;
+	inInterrupt = true;
+	counters.interrupts++;
+	isr[num].handler();
+	inInterrupt = false;
+}
+
+void runPendingInterrupts() {
+	for (uint8_t num = 0; num < 2; num++) {
+		if (isr[num].pending && isr[num].handler) {
+			runInterrupt(num);
+		}
+	}
+}
+
+void setLevel(uint8_t pin, uint8_t level) {
+	uint8_t old = pins[pin].level;
+	pins[pin].level = level;
+	if (old == level) {
+		return;
+	}
+	if (pins[pin].listener) {
+		pins[pin].listener->pinChanged(pin, level);
+	}
+	int num = digitalPinToInterrupt(pin);
+	if (num == NOT_AN_INTERRUPT || !isr[num].handler) {
+		return;
+	}
+	int mode = isr[num].mode;
+	if (mode == CHANGE || (mode == RISING && level == HIGH) || (mode == FALLING && level == LOW)) {
+		runInterrupt(num);
+	}
+}
+
+/**
+ * An output pin written by the sketch, through digitalWrite() or a port register.
+ */
+void writeOutput(uint8_t pin, uint8_t level) {
+	if (pins[pin].level == level) {
+		return;
+	}
+	pins[pin].writes++;
+	if (pins[pin].device) {
+		if (level == LOW) {
+			counters.spiSelects++;
+		}
+		pins[pin].level = level;
+		pins[pin].device->select(level == LOW);
+		return;
+	}
+	setLevel(pin, level);
+}
+
+/**
+ * First pin of a port and the number of pins it has on the Uno.
+ */
+bool portPins(uint8_t port, uint8_t &first, uint8_t &count) {
+	switch (port) {
+		case PB:
+			first = 8;
+			count = 6;
+			return true;
+		case PC:
+			first = A0;
+			count = 6;
+			return true;
+		case PD:
+			first = 0;
+			count = 8;
+			return true;
+		default:
+			return false;
+	}
+}
+
+PortRegister portRegisters[] = {PortRegister(NOT_A_PORT), PortRegister(1), PortRegister(PB), PortRegister(PC), PortRegister(PD)};
+
+} // namespace
+
+// ---------------------------------------------------------------------------------------------------
+// HostSim
+// ---------------------------------------------------------------------------------------------------
+
+uint64_t HostSim::nanos() {
+	return now;
+}
+
+void HostSim::advance(uint64_t ns) {
+	uint64_t target = now + ns;
+	for (;;) {
+		// Wake the listeners in the order of their events, so a chip sees the time it asked for
+		ClockListener *next = nullptr;
+		uint64_t nextTime = target;
+		for (ClockListener *listener : listeners) {
+			uint64_t event = listener->nextEvent();
+			if (event <= nextTime) {
+				next = listener;
+				nextTime = event;
+			}
+		}
+		if (next == nullptr) {
+			break;
+		}
+		if (nextTime > now) {
+			now = nextTime;
+		}
+		next->clockAdvanced(now);
+	}
+	// An interrupt run by a listener may have spent time of its own
+	if (target > now) {
+		now = target;
+	}
+}
+
+void HostSim::addClockListener(ClockListener *listener) {
+	listeners.push_back(listener);
+}
+
+void HostSim::removeClockListener(ClockListener *listener) {
+	listeners.erase(std::remove(listeners.begin(), listeners.end(), listener), listeners.end());
+}
+
+HostSim::Costs &HostSim::costs() {
+	return costTable;
+}
+
+HostSim::Stats &HostSim::stats() {
+	return counters;
+}
+
+void HostSim::resetStats() {
+	counters = Stats();
+}
+
+uint8_t HostSim::pinLevel(uint8_t pin) {
+	return pin < NUM_DIGITAL_PINS ? pins[pin].level : LOW;
+}
+
+void HostSim::driveInput(uint8_t pin, uint8_t level) {
+	if (pin < NUM_DIGITAL_PINS) {
+		setLevel(pin, level);
+	}
+}
+
+unsigned long HostSim::pinWrites(uint8_t pin) {
+	return pin < NUM_DIGITAL_PINS ? pins[pin].writes : 0;
+}
+
+void HostSim::attachPinListener(uint8_t pin, PinListener *listener) {
+	if (pin < NUM_DIGITAL_PINS) {
+		pins[pin].listener = listener;
+	}
+}
+
+void HostSim::attachSpiDevice(uint8_t chipSelectPin, SPIDevice *device) {
+	if (chipSelectPin < NUM_DIGITAL_PINS) {
+		pins[chipSelectPin].device = device;
+	}
+}
+
+void HostSim::detachSpiDevice(uint8_t chipSelectPin) {
+	attachSpiDevice(chipSelectPin, nullptr);
+}
+
+SPIDevice *HostSim::selectedSpiDevice() {
+	for (Pin &pin : pins) {
+		if (pin.device && pin.mode == OUTPUT && pin.level == LOW) {
+			return pin.device;
+		}
+	}
+	return nullptr;
+}
+
+void HostSim::reset() {
+	now = 0;
+	for (Pin &pin : pins) {
+		pin.mode = INPUT;
+		pin.level = LOW;
+		pin.writes = 0;
+	}
+	for (Interrupt &entry : isr) {
+		entry = Interrupt();
+	}
+	interruptsEnabled = true;
+	resetStats();
+}
+
+// ---------------------------------------------------------------------------------------------------
+// Arduino core
+// ---------------------------------------------------------------------------------------------------
+
+void pinMode(uint8_t pin, uint8_t mode) {
+	HostSim::advance(costTable.pinMode);
+	if (pin >= NUM_DIGITAL_PINS) {
+		return;
+	}
+	pins[pin].mode = mode;
+	if (mode == INPUT_PULLUP && !pins[pin].device) {
+		setLevel(pin, HIGH);
+	}
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+	HostSim::advance(costTable.digitalWrite);
+	counters.digitalWrites++;
+	if (pin >= NUM_DIGITAL_PINS) {
+		return;
+	}
+	writeOutput(pin, value ? HIGH : LOW);
+}
+
+uint8_t digitalPinToPort(uint8_t pin) {
+	if (pin >= NUM_DIGITAL_PINS) {
+		return NOT_A_PORT;
+	}
+	return pin < 8 ? PD : (pin < A0 ? PB : PC);
+}
+
+uint8_t digitalPinToBitMask(uint8_t pin) {
+	uint8_t first;
+	uint8_t count;
+	if (!portPins(digitalPinToPort(pin), first, count)) {
+		return 0;
+	}
+	return (uint8_t)(1 << (pin - first));
+}
+
+PortRegister *portOutputRegister(uint8_t port) {
+	return port <= PD ? &portRegisters[port] : &portRegisters[NOT_A_PORT];
+}
+
+PortRegister::operator uint8_t() const {
+	uint8_t first;
+	uint8_t count;
+	uint8_t value = 0;
+	if (portPins(_port, first, count)) {
+		for (uint8_t i = 0; i < count; i++) {
+			if (pins[first + i].level == HIGH) {
+				value |= (uint8_t)(1 << i);
+			}
+		}
+	}
+	return value;
+}
+
+PortRegister &PortRegister::operator=(uint8_t value) {
+	HostSim::advance(costTable.portWrite);
+	uint8_t first;
+	uint8_t count;
+	if (portPins(_port, first, count)) {
+		for (uint8_t i = 0; i < count; i++) {
+			if (pins[first + i].mode == OUTPUT) {
+				writeOutput(first + i, (value >> i) & 1 ? HIGH : LOW);
+			}
+		}
+	}
+	return *this;
+}
+
+int digitalRead(uint8_t pin) {
+	HostSim::advance(costTable.digitalRead);
+	counters.digitalReads++;
+	return pin < NUM_DIGITAL_PINS ? pins[pin].level : LOW;
+}
+
+int analogRead(uint8_t pin) {
+	(void)pin;
+	HostSim::advance(112000);	// 13 ADC clocks at 125kHz
+	return 0;
+}
+
+void analogWrite(uint8_t pin, int value) {
+	pinMode(pin, OUTPUT);
+	digitalWrite(pin, value >= 128 ? HIGH : LOW);
+}
+
+unsigned long millis() {
+	HostSim::advance(costTable.clockRead);
+	return (unsigned long)(now / 1000000);
+}
+
+unsigned long micros() {
+	HostSim::advance(costTable.clockRead);
+	return (unsigned long)(now / 1000);
+}
+
+void delay(unsigned long ms) {
+	HostSim::advance((uint64_t)ms * 1000000);
+}
+
+void delayMicroseconds(unsigned int us) {
+	HostSim::advance((uint64_t)us * 1000);
+}
+
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration) {
+	(void)frequency;
+	(void)duration;
+	digitalWrite(pin, HIGH);
+}
+
+void noTone(uint8_t pin) {
+	digitalWrite(pin, LOW);
+}
+
+void attachInterrupt(uint8_t interruptNum, void (*userFunc)(), int mode) {
+	if (interruptNum < 2) {
+		isr[interruptNum].handler = userFunc;
+		isr[interruptNum].mode = mode;
+		isr[interruptNum].pending = false;
+	}
+}
+
+void detachInterrupt(uint8_t interruptNum) {
+	if (interruptNum < 2) {
+		isr[interruptNum] = Interrupt();
+	}
+}
+
+void interrupts() {
+	interruptsEnabled = true;
+	runPendingInterrupts();
+}
+
+void noInterrupts() {
+	interruptsEnabled = false;
+}
+
+StatusRegister SREG;
+
+StatusRegister::operator uint8_t() const {
+	return interruptsEnabled ? 0x80 : 0x00;
+}
+
+StatusRegister &StatusRegister::operator=(uint8_t value) {
+	if (value & 0x80) {
+		interrupts();
+	} else {
+		noInterrupts();
+	}
+	return *this;
+}
+
+long random(long howbig) {
+	if (howbig == 0) {
+		return 0;
+	}
+	// Park-Miller minimal standard generator, like random() of avr-libc
+	randomState = (unsigned long)(((uint64_t)randomState * 16807) % 2147483647);
+	return (long)(randomState % (unsigned long)howbig);
+}
+
+long random(long howsmall, long howbig) {
+	if (howsmall >= howbig) {
+		return howsmall;
+	}
+	return random(howbig - howsmall) + howsmall;
+}
+
+void randomSeed(unsigned long seed) {
+	if (seed != 0) {
+		randomState = seed;
+	}
+}
@@ -0,0 +1,97 @@
+/**
+ * Control interface of the host build.
+ *
+ * The host Arduino core runs on a virtual clock in nanoseconds. Nothing advances it but delays and
+ * the modelled cost of I/O (see Costs, the defaults are taken from an Arduino Uno at 16MHz), so a
+ * benchmark measures what the code would spend on the board, independent of the machine it runs on.
+ *
+ * Simulated chips (for example the MFRC522 emulator) attach to the SPI bus by chip select pin and
+ * can subscribe to the clock to finish their work at the right moment, driving input pins and with
+ * that the interrupts the sketch attached.
+ */
+#ifndef HostSim_h
+#define HostSim_h
+
+#include <stdint.h>
+
+class SPIDevice;
+
+namespace HostSim {
+
+/**
+ * Modelled cost of the core functions, in nanoseconds.
+ */
+struct Costs {
+	uint32_t digitalWrite = 3400;		// Pin lookup, timer check and port write in wiring_digital.c
+	uint32_t portWrite = 250;			// Read-modify-write of a port register through a pointer
+	uint32_t digitalRead = 3000;
+	uint32_t pinMode = 3000;
+	uint32_t clockRead = 1000;			// millis() or micros()
+	uint32_t spiTransaction = 1000;		// SPI.beginTransaction()
+	uint32_t spiEndTransaction = 500;	// SPI.endTransaction()
+	uint32_t spiByteOverhead = 1000;	// SPI.transfer() on top of the 8 clock periods
+	uint32_t serialWrite = 5000;		// HardwareSerial::write() putting a byte into the buffer
+	uint32_t serialStatus = 1000;		// available() or availableForWrite()
+	uint32_t lcdWrite = 250000;			// One character or command in 4 bit mode
+	uint32_t lcdClear = 2250000;		// clear() and home() wait 2ms for the display
+	uint32_t eepromRead = 1000;			// EEPROM.read()
+	uint32_t eepromWrite = 3400000;		// EEPROM.write(), the AVR erases and programs the byte
+};
+
+/**
+ * Counters for everything the code under test did.
+ */
+struct Stats {
+	unsigned long digitalWrites;
+	unsigned long digitalReads;
+	unsigned long spiTransactions;	// SPI.beginTransaction() calls
+	unsigned long spiSelects;		// Falling edges on a chip select pin with a device attached
+	unsigned long spiBytes;
+	unsigned long serialBytes;
+	unsigned long lcdWrites;
+	unsigned long heapAllocations;	// String buffers allocated
+	unsigned long interrupts;		// Interrupt service routines run
+};
+
+/**
+ * Something that has to act when the virtual clock passes a certain point in time.
+ */
+class ClockListener {
+public:
+	virtual ~ClockListener() {}
+	virtual uint64_t nextEvent() = 0;		// Time of the next thing to do, UINT64_MAX if none
+	virtual void clockAdvanced(uint64_t now) = 0;
+};
+
+/**
+ * Something that has to know when the level of a pin changes, like a chip watching its reset pin.
+ */
+class PinListener {
+public:
+	virtual ~PinListener() {}
+	virtual void pinChanged(uint8_t pin, uint8_t level) = 0;
+};
+
+uint64_t nanos();
+void advance(uint64_t ns);				// Spend time, waking listeners on the way
+void addClockListener(ClockListener *listener);
+void removeClockListener(ClockListener *listener);
+
+Costs &costs();
+Stats &stats();
+void resetStats();
+
+uint8_t pinLevel(uint8_t pin);			// Level last written by the sketch or driven from outside
+void driveInput(uint8_t pin, uint8_t level);	// An external chip drives the pin, may raise an interrupt
+unsigned long pinWrites(uint8_t pin);	// Number of digitalWrite() calls that changed the pin
+void attachPinListener(uint8_t pin, PinListener *listener);	// nullptr detaches
+
+void attachSpiDevice(uint8_t chipSelectPin, SPIDevice *device);
+void detachSpiDevice(uint8_t chipSelectPin);
+SPIDevice *selectedSpiDevice();			// Device whose chip select pin is LOW, nullptr if none
+
+void reset();							// Clock back to zero, pins low, statistics cleared
+
+} // namespace HostSim
+
+#endif
@@ -0,0 +1,63 @@
+/**
+ * Host build of the Arduino LiquidCrystal library.
+ */
+#include "LiquidCrystal.h"
+#include "HostSim.h"
+
+LiquidCrystal::LiquidCrystal(uint8_t rs, uint8_t enable, uint8_t d0, uint8_t d1, uint8_t d2, uint8_t d3) {
+	(void)rs; (void)enable; (void)d0; (void)d1; (void)d2; (void)d3;
+	memset(_text, ' ', sizeof(_text));
+}
+
+LiquidCrystal::LiquidCrystal(uint8_t rs, uint8_t rw, uint8_t enable, uint8_t d0, uint8_t d1, uint8_t d2, uint8_t d3)
+		: LiquidCrystal(rs, enable, d0, d1, d2, d3) {
+	(void)rw;
+}
+
+void LiquidCrystal::begin(uint8_t cols, uint8_t rows, uint8_t charsize) {
+	(void)charsize;
+	_cols = cols < MAX_COLS ? cols : MAX_COLS;
+	_rows = rows < MAX_ROWS ? rows : MAX_ROWS;
+	// Power up wait and the initialisation sequence of the HD44780
+	HostSim::advance(50000000 + 6 * (uint64_t)HostSim::costs().lcdWrite);
+	clear();
+}
+
+void LiquidCrystal::clear() {
+	HostSim::advance(HostSim::costs().lcdClear);
+	memset(_text, ' ', sizeof(_text));
+	_col = 0;
+	_row = 0;
+}
+
+void LiquidCrystal::home() {
+	HostSim::advance(HostSim::costs().lcdClear);
+	_col = 0;
+	_row = 0;
+}
+
+void LiquidCrystal::setCursor(uint8_t col, uint8_t row) {
+	HostSim::advance(HostSim::costs().lcdWrite);
+	_row = row < _rows ? row : _rows - 1;
+	_col = col;
+}
+
+size_t LiquidCrystal::write(uint8_t c) {
+	HostSim::advance(HostSim::costs().lcdWrite);
+	HostSim::stats().lcdWrites++;
+	_writes++;
+	if (_col < _cols) {
+		_text[_row][_col] = (char)c;
+	}
+	_col++;
+	return 1;
+}
+
+std::string LiquidCrystal::line(uint8_t row) const {
+	if (row >= _rows) {
+		return std::string();
+	}
+	std::string text(_text[row], _cols);
+	text.erase(text.find_last_not_of(' ') + 1);
+	return text;
+}
@@ -0,0 +1,49 @@
+/**
+ * Host build of the Arduino LiquidCrystal library.
+ *
+ * Keeps the display contents in memory (HostSim reads them through line()). Timing follows the
+ * 4 bit HD44780 driver of the original library: about 200μs per character or cursor move and 2ms
+ * for clear() and home().
+ */
+#ifndef LiquidCrystal_h
+#define LiquidCrystal_h
+
+#include <Arduino.h>
+#include <string>
+
+class LiquidCrystal : public Print {
+public:
+	LiquidCrystal(uint8_t rs, uint8_t enable, uint8_t d0, uint8_t d1, uint8_t d2, uint8_t d3);
+	LiquidCrystal(uint8_t rs, uint8_t rw, uint8_t enable, uint8_t d0, uint8_t d1, uint8_t d2, uint8_t d3);
+
+	void begin(uint8_t cols, uint8_t rows, uint8_t charsize = 0);
+	void clear();
+	void home();
+	void noDisplay() {}
+	void display() {}
+	void noBlink() { _blink = false; }
+	void blink() { _blink = true; }
+	void noCursor() {}
+	void cursor() {}
+	void setCursor(uint8_t col, uint8_t row);
+	size_t write(uint8_t c) override;
+	using Print::write;
+
+	// Host side of the display
+	std::string line(uint8_t row) const;	// Contents of a row, trailing spaces removed
+	bool blinking() const { return _blink; }
+	unsigned long writes() const { return _writes; }	// Number of characters written so far
+
+private:
+	static const uint8_t MAX_COLS = 20;
+	static const uint8_t MAX_ROWS = 4;
+	char _text[MAX_ROWS][MAX_COLS];
+	uint8_t _cols = 16;
+	uint8_t _rows = 2;
+	uint8_t _col = 0;
+	uint8_t _row = 0;
+	bool _blink = false;
+	unsigned long _writes = 0;
+};
+
+#endif
@@ -0,0 +1,44 @@
+/**
+ * Host build of the Arduino SPI library.
+ */
+#include "SPI.h"
+#include "HostSim.h"
+
+SPIClass SPI;
+
+void SPIClass::begin() {
+}
+
+void SPIClass::end() {
+}
+
+void SPIClass::beginTransaction(SPISettings settings) {
+	HostSim::advance(HostSim::costs().spiTransaction);
+	HostSim::stats().spiTransactions++;
+	// The AVR runs SPI at most at half the CPU clock
+	_clock = settings.clock < 8000000 ? settings.clock : 8000000;
+}
+
+void SPIClass::endTransaction() {
+	HostSim::advance(HostSim::costs().spiEndTransaction);
+}
+
+uint8_t SPIClass::transfer(uint8_t data) {
+	HostSim::advance(HostSim::costs().spiByteOverhead + 8000000000ULL / _clock);
+	HostSim::stats().spiBytes++;
+	SPIDevice *device = HostSim::selectedSpiDevice();
+	return device ? device->transfer(data) : 0x00;
+}
+
+uint16_t SPIClass::transfer16(uint16_t data) {
+	uint8_t high = transfer(data >> 8);
+	uint8_t low = transfer(data & 0xFF);
+	return (uint16_t)(high << 8 | low);
+}
+
+void SPIClass::transfer(void *buf, size_t count) {
+	uint8_t *bytes = (uint8_t *)buf;
+	for (size_t i = 0; i < count; i++) {
+		bytes[i] = transfer(bytes[i]);
+	}
+}
@@ -0,0 +1,58 @@
+/**
+ * Host build of the Arduino SPI library.
+ *
+ * Bytes go to the SPIDevice attached (HostSim::attachSpiDevice()) to the chip select pin that is
+ * currently LOW. Without a device MISO reads 0x00. Each byte costs 8 clock periods of the
+ * transaction clock plus the CPU overhead of an AVR SPI transfer.
+ */
+#ifndef _SPI_H_INCLUDED
+#define _SPI_H_INCLUDED
+
+#include <Arduino.h>
+
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x04
+#define SPI_MODE2 0x08
+#define SPI_MODE3 0x0C
+
+#define SPI_CLOCK_DIV4 0x00
+#define SPI_CLOCK_DIV16 0x01
+
+class SPISettings {
+public:
+	SPISettings() : clock(4000000), bitOrder(MSBFIRST), dataMode(SPI_MODE0) {}
+	SPISettings(uint32_t clock, uint8_t bitOrder, uint8_t dataMode) : clock(clock), bitOrder(bitOrder), dataMode(dataMode) {}
+	uint32_t clock;
+	uint8_t bitOrder;
+	uint8_t dataMode;
+};
+
+/**
+ * A chip on the simulated SPI bus.
+ */
+class SPIDevice {
+public:
+	virtual ~SPIDevice() {}
+	virtual void select(bool selected) = 0;		// Chip select changed, true = selected (pin LOW)
+	virtual uint8_t transfer(uint8_t mosi) = 0;	// One full duplex byte while selected
+};
+
+class SPIClass {
+public:
+	void begin();
+	void end();
+	void beginTransaction(SPISettings settings);
+	void endTransaction();
+	uint8_t transfer(uint8_t data);
+	uint16_t transfer16(uint16_t data);
+	void transfer(void *buf, size_t count);
+	void usingInterrupt(uint8_t interruptNumber) { (void)interruptNumber; }
+	void setClockDivider(uint8_t div) { (void)div; }
+
+private:
+	uint32_t _clock = 4000000;
+};
+
+extern SPIClass SPI;
+
+#endif
@@ -0,0 +1,154 @@
+/**
+ * Host build of the Arduino String class.
+ */
+#include "Arduino.h"
+#include "HostSim.h"
+#include <stdio.h>
+
+namespace {
+
+char *allocate(unsigned int length) {
+	HostSim::stats().heapAllocations++;
+	return (char *)malloc(length + 1);
+}
+
+} // namespace
+
+String::String(const char *cstr) : buffer(nullptr), len(0) {
+	assign(cstr ? cstr : "", cstr ? strlen(cstr) : 0);
+}
+
+String::String(const __FlashStringHelper *str) : String(reinterpret_cast<const char *>(str)) {
+}
+
+String::String(const String &str) : buffer(nullptr), len(0) {
+	assign(str.buffer, str.len);
+}
+
+String::String(char c) : buffer(nullptr), len(0) {
+	assign(&c, 1);
+}
+
+String::String(unsigned char value, unsigned char base) : String((unsigned long)value, base) {
+}
+
+String::String(int value, unsigned char base) : String((long)value, base) {
+}
+
+String::String(unsigned int value, unsigned char base) : String((unsigned long)value, base) {
+}
+
+String::String(long value, unsigned char base) : buffer(nullptr), len(0) {
+	if (base == 10 && value < 0) {
+		char buf[24];
+		snprintf(buf, sizeof(buf), "%ld", value);
+		assign(buf, strlen(buf));
+		return;
+	}
+	*this = String((unsigned long)value, base);
+}
+
+String::String(unsigned long value, unsigned char base) : buffer(nullptr), len(0) {
+	char buf[8 * sizeof(long) + 1];
+	char *str = &buf[sizeof(buf) - 1];
+	*str = '\0';
+	if (base < 2) {
+		base = 10;
+	}
+	do {
+		char c = value % base;
+		value /= base;
+		*--str = c < 10 ? c + '0' : c + 'A' - 10;
+	} while (value);
+	assign(str, strlen(str));
+}
+
+String::~String() {
+	free(buffer);
+}
+
+String &String::operator=(const String &rhs) {
+	if (this != &rhs) {
+		assign(rhs.buffer, rhs.len);
+	}
+	return *this;
+}
+
+String &String::operator=(const char *cstr) {
+	assign(cstr ? cstr : "", cstr ? strlen(cstr) : 0);
+	return *this;
+}
+
+void String::assign(const char *cstr, unsigned int length) {
+	char *copy = allocate(length);
+	memcpy(copy, cstr, length);
+	copy[length] = '\0';
+	free(buffer);
+	buffer = copy;
+	len = length;
+}
+
+bool String::append(const char *cstr, unsigned int length) {
+	char *grown = allocate(len + length);
+	memcpy(grown, buffer, len);
+	memcpy(grown + len, cstr, length);
+	grown[len + length] = '\0';
+	free(buffer);
+	buffer = grown;
+	len += length;
+	return true;
+}
+
+bool String::concat(const String &str) {
+	return append(str.buffer, str.len);
+}
+
+bool String::concat(const char *cstr) {
+	return cstr ? append(cstr, strlen(cstr)) : false;
+}
+
+bool String::concat(char c) {
+	return append(&c, 1);
+}
+
+bool String::concat(int num) {
+	return concat(String(num));
+}
+
+bool String::concat(unsigned int num) {
+	return concat(String(num));
+}
+
+bool String::concat(long num) {
+	return concat(String(num));
+}
+
+bool String::concat(unsigned long num) {
+	return concat(String(num));
+}
+
+String operator+(const String &lhs, const String &rhs) {
+	String result(lhs);
+	result.concat(rhs);
+	return result;
+}
+
+String operator+(const String &lhs, const char *rhs) {
+	String result(lhs);
+	result.concat(rhs);
+	return result;
+}
+
+String operator+(const char *lhs, const String &rhs) {
+	String result(lhs);
+	result.concat(rhs);
+	return result;
+}
+
+bool String::operator==(const String &rhs) const {
+	return len == rhs.len && memcmp(buffer, rhs.buffer, len) == 0;
+}
+
+bool String::operator==(const char *cstr) const {
+	return strcmp(buffer, cstr ? cstr : "") == 0;
+}
@@ -0,0 +1,63 @@
+/**
+ * Host build of the Arduino String class.
+ *
+ * Heap backed like the original. Every allocation is counted in HostSim::stats().heapAllocations,
+ * so benchmarks can show which code paths still allocate.
+ */
+#ifndef WString_h
+#define WString_h
+
+#include <stddef.h>
+
+class __FlashStringHelper;
+
+class String {
+public:
+	String(const char *cstr = "");
+	String(const __FlashStringHelper *str);
+	String(const String &str);
+	explicit String(char c);
+	explicit String(unsigned char value, unsigned char base = 10);
+	explicit String(int value, unsigned char base = 10);
+	explicit String(unsigned int value, unsigned char base = 10);
+	explicit String(long value, unsigned char base = 10);
+	explicit String(unsigned long value, unsigned char base = 10);
+	~String();
+
+	String &operator=(const String &rhs);
+	String &operator=(const char *cstr);
+
+	bool concat(const String &str);
+	bool concat(const char *cstr);
+	bool concat(char c);
+	bool concat(int num);
+	bool concat(unsigned int num);
+	bool concat(long num);
+	bool concat(unsigned long num);
+
+	String &operator+=(const String &rhs) { concat(rhs); return *this; }
+	String &operator+=(const char *cstr) { concat(cstr); return *this; }
+	String &operator+=(char c) { concat(c); return *this; }
+
+	friend String operator+(const String &lhs, const String &rhs);
+	friend String operator+(const String &lhs, const char *rhs);
+	friend String operator+(const char *lhs, const String &rhs);
+
+	bool operator==(const String &rhs) const;
+	bool operator==(const char *cstr) const;
+	bool operator!=(const String &rhs) const { return !(*this == rhs); }
+	bool operator!=(const char *cstr) const { return !(*this == cstr); }
+
+	unsigned int length() const { return len; }
+	const char *c_str() const { return buffer; }
+	char operator[](unsigned int index) const { return index < len ? buffer[index] : 0; }
+
+private:
+	char *buffer;
+	unsigned int len;
+
+	void assign(const char *cstr, unsigned int length);
+	bool append(const char *cstr, unsigned int length);
+};
+
+#endif
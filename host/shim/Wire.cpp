@@ -0,0 +1,82 @@
+/**
+ * Host build of the Arduino AVR Wire library.
+ */
+#include "Wire.h"
+#include "HostSim.h"
+
+TwoWire Wire;
+
+void TwoWire::busTime(size_t bytes) {
+	// Start, the address byte and the data bytes with their acknowledge bit, stop
+	HostSim::advance((2 + 9 * (uint64_t)(bytes + 1)) * 1000000000ULL / _clock);
+	_transfers++;
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+	_address = address & 0x7F;
+	_txLength = 0;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+	(void)sendStop;
+	busTime(_txLength);
+	TwoWireDevice *device = _devices[_address];
+	if (!device) {
+		return 2;
+	}
+	device->i2cWrite(_txBuffer, _txLength);
+	_txLength = 0;
+	return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, bool sendStop) {
+	(void)sendStop;
+	if (quantity > BUFFER_LENGTH) {
+		quantity = BUFFER_LENGTH;
+	}
+	_rxIndex = 0;
+	_rxLength = 0;
+	TwoWireDevice *device = _devices[address & 0x7F];
+	if (!device) {
+		busTime(0);
+		return 0;
+	}
+	busTime(quantity);
+	for (uint8_t index = 0; index < quantity; index++) {
+		_rxBuffer[index] = device->i2cRead();
+	}
+	_rxLength = quantity;
+	return quantity;
+}
+
+size_t TwoWire::write(uint8_t data) {
+	if (_txLength >= BUFFER_LENGTH) {
+		return 0;
+	}
+	_txBuffer[_txLength++] = data;
+	return 1;
+}
+
+size_t TwoWire::write(const uint8_t *data, size_t length) {
+	size_t written = 0;
+	while (written < length && write(data[written])) {
+		written++;
+	}
+	return written;
+}
+
+int TwoWire::available() {
+	return _rxLength - _rxIndex;
+}
+
+int TwoWire::read() {
+	return _rxIndex < _rxLength ? _rxBuffer[_rxIndex++] : -1;
+}
+
+int TwoWire::peek() {
+	return _rxIndex < _rxLength ? _rxBuffer[_rxIndex] : -1;
+}
+
+void TwoWire::attachDevice(uint8_t address, TwoWireDevice *device) {
+	_devices[address & 0x7F] = device;
+}
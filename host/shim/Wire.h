@@ -0,0 +1,65 @@
+/**
+ * Host build of the Arduino AVR Wire library.
+ *
+ * The master side of the I2C bus with the 32 byte buffers of the AVR library: write() refuses bytes
+ * past the buffer and requestFrom() reads at most 32. Transfers go to the TwoWireDevice attached to
+ * the address (attachDevice()), without one the address is not acknowledged. Each byte costs the 9
+ * clock periods of the bus clock, a transfer also its start and stop condition.
+ */
+#ifndef TwoWire_h
+#define TwoWire_h
+
+#include <Arduino.h>
+
+#ifndef BUFFER_LENGTH
+#define BUFFER_LENGTH 32
+#endif
+
+/**
+ * A chip on the simulated I2C bus.
+ */
+class TwoWireDevice {
+public:
+	virtual ~TwoWireDevice() {}
+	virtual void i2cWrite(const uint8_t *data, size_t length) = 0;	// Bytes written in one transfer of the master
+	virtual uint8_t i2cRead() = 0;									// One byte read by the master
+};
+
+class TwoWire : public Stream {
+public:
+	void begin() {}
+	void end() {}
+	void setClock(uint32_t clock) { _clock = clock; }
+
+	void beginTransmission(uint8_t address);
+	uint8_t endTransmission(bool sendStop = true);	// 0 on success, 2 if the address is not acknowledged
+	uint8_t requestFrom(uint8_t address, uint8_t quantity, bool sendStop = true);
+
+	size_t write(uint8_t data) override;
+	size_t write(const uint8_t *data, size_t length) override;
+	using Print::write;
+	int available() override;
+	int read() override;
+	int peek() override;
+
+	// Host side of the bus
+	void attachDevice(uint8_t address, TwoWireDevice *device);	// nullptr detaches
+	unsigned long transfers() const { return _transfers; }		// Start conditions, repeated ones included
+
+private:
+	uint32_t _clock = 100000;
+	uint8_t _address = 0;
+	uint8_t _txBuffer[BUFFER_LENGTH];
+	uint8_t _txLength = 0;
+	uint8_t _rxBuffer[BUFFER_LENGTH];
+	uint8_t _rxLength = 0;
+	uint8_t _rxIndex = 0;
+	unsigned long _transfers = 0;
+	TwoWireDevice *_devices[128] = {};
+
+	void busTime(size_t bytes);
+};
+
+extern TwoWire Wire;
+
+#endif
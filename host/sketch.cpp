@@ -0,0 +1,7 @@
+/**
+ * The sketch as a translation unit of the host build.
+ *
+ * The Arduino IDE compiles the .ino as C++ after adding #include <Arduino.h>; this does the same.
+ */
+#include <Arduino.h>
+#include "Team D-10.ino"
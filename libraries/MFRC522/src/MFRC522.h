@@ -18,9 +18,9 @@
 #include <Arduino.h>
 #include <SPI.h>
 
-#ifndef MFRC522_SPICLOCK
-#define MFRC522_SPICLOCK (4000000u)	// MFRC522 accept upto 10MHz, set to 4MHz.
-#endif
+#include "MFRC522Transport.h"
+
+class MFRC522KeyCache;
 
 // Firmware data for self-test
 // Reference values based on firmware version
@@ -75,7 +75,8 @@ const byte FM17522_firmware_reference[] PROGMEM = {
 	0x56, 0x9A, 0x98, 0x82, 0x26, 0xEA, 0x2A, 0x62
 };
 
-class MFRC522 {
+// The constants, types and transport independent functions of the MFRC522 library
+class MFRC522Constants {
 public:
 	// Size of the MFRC522 FIFO
 	static constexpr byte FIFO_SIZE = 64;		// The FIFO is 64 bytes.
@@ -212,7 +213,10 @@ public:
 		PICC_CMD_MF_TRANSFER	= 0xB0,		// Writes the contents of the internal data register to a block.
 		// The commands used for MIFARE Ultralight (from http://www.nxp.com/documents/data_sheet/MF0ICU1.pdf, Section 8.6)
 		// The PICC_CMD_MF_READ and PICC_CMD_MF_WRITE can also be used for MIFARE Ultralight.
-		PICC_CMD_UL_WRITE		= 0xA2		// Writes one 4 byte page to the PICC.
+		PICC_CMD_UL_WRITE		= 0xA2,		// Writes one 4 byte page to the PICC.
+		// NTAG21x (from https://www.nxp.com/docs/en/data-sheet/NTAG213_215_216.pdf, Section 10)
+		PICC_CMD_UL_GET_VERSION	= 0x60,		// Returns 8 bytes of vendor, product type and storage size.
+		PICC_CMD_UL_FAST_READ	= 0x3A		// Reads the pages from a start to an end address in one frame.
 	};
 	
 	// MIFARE constants that does not fit anywhere else
@@ -248,9 +252,25 @@ public:
 		STATUS_INTERNAL_ERROR	,	// Internal error in the code. Should not happen ;-)
 		STATUS_INVALID			,	// Invalid argument.
 		STATUS_CRC_WRONG		,	// The CRC_A does not match
+		STATUS_PENDING			,	// An asynchronous command has not completed yet
 		STATUS_MIFARE_NACK		= 0xff	// A MIFARE PICC responded with NAK.
 	};
 	
+	// Operations with a timeout of their own, see PCD_SetTimeout()
+	enum PCD_Operation : byte {
+		OPERATION_TRANSCEIVE		= 0,	// A frame to a PICC and its answer, PCD_TransceiveData() and PCD_PollTransceive()
+		OPERATION_AUTHENTICATE		= 1,	// The MFAuthent command of PCD_Authenticate()
+		OPERATION_CALCULATE_CRC		= 2,	// The CRC coprocessor, PCD_CalculateCRC()
+		OPERATION_COUNT
+	};
+	
+	// What PICC_PollCardEvent() has seen
+	enum PICC_Event : byte {
+		EVENT_NONE				,	// Nothing has changed
+		EVENT_NEW_CARD			,	// A PICC was read into uid and halted
+		EVENT_CARD_REMOVED			// The PICC of the last EVENT_NEW_CARD has left the field, its UID is in uid
+	};
+	
 	// A struct used for passing the UID of a PICC.
 	typedef struct {
 		byte		size;			// Number of bytes in the UID. 4, 7 or 10.
@@ -258,30 +278,78 @@ public:
 		byte		sak;			// The SAK (Select acknowledge) byte returned from the PICC after successful selection.
 	} Uid;
 
+	// One register write of a script for PCD_WriteRegisters()
+	struct RegisterWrite {
+		PCD_Register	reg;
+		byte			value;
+	};
+
 	// A struct used for passing a MIFARE Crypto1 key
 	typedef struct {
 		byte		keyByte[MF_KEY_SIZE];
 	} MIFARE_Key;
 	
+	/////////////////////////////////////////////////////////////////////////////////////
+	// Support functions
+	/////////////////////////////////////////////////////////////////////////////////////
+	static void CalculateCRC_A(const byte *data, byte length, byte *result);
+	// old function used too much memory, now name moved to flash; if you need char, copy from flash to memory
+	//const char *GetStatusCodeName(byte code);
+	static const __FlashStringHelper *GetStatusCodeName(StatusCode code);
+	static PICC_Type PICC_GetType(byte sak);
+	// old function used too much memory, now name moved to flash; if you need char, copy from flash to memory
+	//const char *PICC_GetTypeName(byte type);
+	static const __FlashStringHelper *PICC_GetTypeName(PICC_Type type);
+
+protected:
+	// Flags of the register shadow cache slots, see PCD_SetRegisterCache() and registerCacheSlots in MFRC522.cpp.
+	static constexpr byte REGISTER_NOT_CACHED		= 0xFF;
+	static constexpr byte REGISTER_CACHE_VOLATILE	= 0x80;	// The chip changes some bits itself (CollPos, StartSend): reads go to the chip
+	static constexpr byte REGISTER_CACHE_STROBE		= 0x40;	// Bit 7 is a strobe (StartSend): such a write always goes out and leaves the shadow unknown
+	static constexpr byte REGISTER_CACHE_SLOT		= 0x1F;
+
+	// Tables in PROGMEM, defined in MFRC522.cpp
+	static const byte registerCacheSlots[64];	// Shadow cache slot of each register address, see PCD_SetRegisterCache()
+	static const RegisterWrite resetBaudRatesScript[3];
+	static const RegisterWrite initScript[9];
+};
+
+/**
+ * The driver, on top of a transport that reaches the registers of the chip, see MFRC522Transport.h.
+ * Use MFRC522 for the chip on the SPI bus.
+ */
+template <class Transport>
+class MFRC522Base : public MFRC522Constants {
+public:
 	// Member variables
 	Uid uid;								// Used by PICC_ReadCardSerial().
 	
 	/////////////////////////////////////////////////////////////////////////////////////
 	// Functions for setting up the Arduino
 	/////////////////////////////////////////////////////////////////////////////////////
-	MFRC522();
-	MFRC522(byte resetPowerDownPin);
-	MFRC522(byte chipSelectPin, byte resetPowerDownPin);
+	MFRC522Base();
+	MFRC522Base(byte resetPowerDownPin);
+	MFRC522Base(byte chipSelectPin, byte resetPowerDownPin);
+	MFRC522Base(const Transport &transport, byte resetPowerDownPin = UNUSED_PIN);
 	
 	/////////////////////////////////////////////////////////////////////////////////////
 	// Basic interface functions for communicating with the MFRC522
 	/////////////////////////////////////////////////////////////////////////////////////
 	void PCD_WriteRegister(PCD_Register reg, byte value);
 	void PCD_WriteRegister(PCD_Register reg, byte count, byte *values);
+	void PCD_WriteRegisters(const RegisterWrite *script, byte count);
+	void PCD_WriteRegisters_P(const RegisterWrite *script, byte count);
 	byte PCD_ReadRegister(PCD_Register reg);
 	void PCD_ReadRegister(PCD_Register reg, byte count, byte *values, byte rxAlign = 0);
 	void PCD_SetRegisterBitMask(PCD_Register reg, byte mask);
 	void PCD_ClearRegisterBitMask(PCD_Register reg, byte mask);
+	void PCD_SetRegisterCache(bool enabled);
+	void PCD_InvalidateRegisterCache();
+	void PCD_SetSoftwareCRC(bool enabled);
+	void PCD_SetHardwareCRC(bool enabled);
+	void PCD_SetTimeout(PCD_Operation operation, uint32_t timeoutMicros);
+	uint32_t PCD_GetTimeout(PCD_Operation operation);
+	void PCD_SetRequestWindow(uint16_t windowMicros);
 	StatusCode PCD_CalculateCRC(byte *data, byte length, byte *result);
 	
 	/////////////////////////////////////////////////////////////////////////////////////
@@ -308,20 +376,35 @@ public:
 	/////////////////////////////////////////////////////////////////////////////////////
 	StatusCode PCD_TransceiveData(byte *sendData, byte sendLen, byte *backData, byte *backLen, byte *validBits = nullptr, byte rxAlign = 0, bool checkCRC = false);
 	StatusCode PCD_CommunicateWithPICC(byte command, byte waitIRq, byte *sendData, byte sendLen, byte *backData = nullptr, byte *backLen = nullptr, byte *validBits = nullptr, byte rxAlign = 0, bool checkCRC = false);
+	StatusCode PCD_TransceiveStream(byte *sendData, uint16_t sendLen, byte *backData, uint16_t *backLen);
 	StatusCode PICC_RequestA(byte *bufferATQA, byte *bufferSize);
 	StatusCode PICC_WakeupA(byte *bufferATQA, byte *bufferSize);
 	StatusCode PICC_REQA_or_WUPA(byte command, byte *bufferATQA, byte *bufferSize);
 	virtual StatusCode PICC_Select(Uid *uid, byte validBits = 0);
 	StatusCode PICC_HaltA();
+	
+	/////////////////////////////////////////////////////////////////////////////////////
+	// Asynchronous communication with PICCs
+	/////////////////////////////////////////////////////////////////////////////////////
+	StatusCode PCD_StartTransceive(byte *sendData, byte sendLen, byte *backData, byte *backLen, byte *validBits = nullptr, byte rxAlign = 0, bool checkCRC = false);
+	StatusCode PCD_PollTransceive();
+	void PCD_SetTransceiveInterrupt(bool enabled);
+	void PCD_TransceiveInterrupt();
+	StatusCode PICC_PollNewCardPresent();
 
 	/////////////////////////////////////////////////////////////////////////////////////
 	// Functions for communicating with MIFARE PICCs
 	/////////////////////////////////////////////////////////////////////////////////////
 	StatusCode PCD_Authenticate(byte command, byte blockAddr, MIFARE_Key *key, Uid *uid);
+	StatusCode PCD_AuthenticateWithKeys(byte command, byte blockAddr, MIFARE_Key *keys, byte keyCount, Uid *uid, byte *keyIndex = nullptr);
+	void PCD_SetKeyCache(MFRC522KeyCache *cache);
 	void PCD_StopCrypto1();
 	StatusCode MIFARE_Read(byte blockAddr, byte *buffer, byte *bufferSize);
+	StatusCode MIFARE_ReadRange(byte firstBlock, byte count, MIFARE_Key *key, byte *buffer, bool withTrailers = false, byte command = PICC_CMD_MF_AUTH_KEY_A);
+	StatusCode MIFARE_ReadSector(byte sector, MIFARE_Key *key, byte *buffer, bool withTrailer = false, byte command = PICC_CMD_MF_AUTH_KEY_A);
 	StatusCode MIFARE_Write(byte blockAddr, byte *buffer, byte bufferSize);
 	StatusCode MIFARE_Ultralight_Write(byte page, byte *buffer, byte bufferSize);
+	StatusCode MIFARE_Ultralight_ReadPages(byte firstPage, byte lastPage, byte *buffer);
 	StatusCode MIFARE_Decrement(byte blockAddr, int32_t delta);
 	StatusCode MIFARE_Increment(byte blockAddr, int32_t delta);
 	StatusCode MIFARE_Restore(byte blockAddr);
@@ -334,13 +417,6 @@ public:
 	// Support functions
 	/////////////////////////////////////////////////////////////////////////////////////
 	StatusCode PCD_MIFARE_Transceive(byte *sendData, byte sendLen, bool acceptTimeout = false);
-	// old function used too much memory, now name moved to flash; if you need char, copy from flash to memory
-	//const char *GetStatusCodeName(byte code);
-	static const __FlashStringHelper *GetStatusCodeName(StatusCode code);
-	static PICC_Type PICC_GetType(byte sak);
-	// old function used too much memory, now name moved to flash; if you need char, copy from flash to memory
-	//const char *PICC_GetTypeName(byte type);
-	static const __FlashStringHelper *PICC_GetTypeName(PICC_Type type);
 	
 	// Support functions for debuging
 	void PCD_DumpVersionToSerial();
@@ -361,11 +437,74 @@ public:
 	/////////////////////////////////////////////////////////////////////////////////////
 	virtual bool PICC_IsNewCardPresent();
 	virtual bool PICC_ReadCardSerial();
+	byte PICC_Inventory(Uid *uids, byte maxCount);
+	bool PICC_IsCardPresent(const Uid *uid);
+	PICC_Event PICC_PollCardEvent();
+	void PICC_SetPresenceInterval(uint16_t intervalMillis);
+	void PICC_SetIdlePolling(uint16_t maxPauseMillis);
 	
 protected:
-	byte _chipSelectPin;		// Arduino pin connected to MFRC522's SPI slave select input (Pin 24, NSS, active low)
+	Transport _transport;		// The bus to the MFRC522
 	byte _resetPowerDownPin;	// Arduino pin connected to MFRC522's reset and power down input (Pin 6, NRSTPD, active low)
+	bool PCD_RegisterWriteNeeded(PCD_Register reg, byte value);
+	void PCD_TransferRegister(PCD_Register reg, byte value);
+	void PCD_TransferRegister(PCD_Register reg, byte count, byte *values);
+	// Shadow copies of the configuration registers, see PCD_SetRegisterCache()
+	static constexpr byte REGISTER_CACHE_SIZE = 25;
+	bool _registerCacheEnabled;
+	uint32_t _registerCacheValid;				// Bit n set: _registerCache[n] holds the value last written to or read from the chip
+	byte _registerCache[REGISTER_CACHE_SIZE];
+	bool _softwareCrc;							// PCD_SetSoftwareCRC()
+	bool _hardwareCrc;							// PCD_SetHardwareCRC()
+	bool _frameCrcSet;							// PCD_SetFrameCRC() called for the next frame
+	uint32_t _timeoutMicros[OPERATION_COUNT];	// PCD_SetTimeout()
+	void PCD_SetFrameCRC(bool tx, bool rx);
+	void PCD_SetRequestTimer(bool request);
+	uint16_t _requestWindowTicks;				// PCD_SetRequestWindow(), 0 for the 25ms timer
+	bool _requestTimer;							// The timer holds the request window
+	void PCD_StartCommand(byte command, byte *sendData, byte sendLen, byte bitFraming);
+	StatusCode PCD_FinishCommand(byte *backData, byte *backLen, byte *validBits, byte rxAlign, bool checkCRC);
+	StatusCode PCD_StreamFrame(byte *sendData, uint16_t sendLen, byte *backData, uint16_t *backLen);
+	static byte PCD_NextPollPause(byte pause);
+	// The command started by PCD_StartTransceive()
+	struct PendingTransceive {
+		bool		active;
+		byte		*backData;
+		byte		*backLen;
+		byte		*validBits;
+		byte		rxAlign;
+		bool		checkCRC;
+		uint32_t	startMicros;
+		uint32_t	pollMicros;				// Last read of ComIrqReg after TxIRq
+		byte		pause;					// Before the next read, see PCD_NextPollPause()
+	} _pending;
+	bool _transceiveInterruptEnabled;			// PCD_SetTransceiveInterrupt()
+	volatile bool _transceiveInterrupt;			// Set by PCD_TransceiveInterrupt() from the IRQ pin's ISR
+	byte _requestATQA[2];						// Answer to the REQA of PICC_PollNewCardPresent()
+	byte _requestATQASize;
+	byte _requestValidBits;
+	// The PICC followed by PICC_PollCardEvent()
+	Uid _trackedUid;
+	bool _tracking;
+	byte _presenceMisses;						// Presence checks in a row the PICC did not answer
+	uint16_t _presenceIntervalMillis;			// PICC_SetPresenceInterval()
+	uint32_t _presenceCheckMillis;				// Last presence check of _trackedUid
+	uint16_t _idlePauseMaxMillis;				// PICC_SetIdlePolling()
+	uint16_t _idlePauseMillis;					// Between two REQAs of PICC_PollCardEvent()
+	uint32_t _lastAnswerMillis;					// Last time a PICC answered PICC_PollCardEvent()
+	uint32_t _lastRequestMillis;				// Last REQA of PICC_PollCardEvent()
+	MFRC522KeyCache *_keyCache;					// PCD_SetKeyCache()
+	byte PCD_RegisterCacheSlot(PCD_Register reg);
 	StatusCode MIFARE_TwoStepHelper(byte command, byte blockAddr, int32_t data);
 };
 
+// The chip on the SPI bus. MFRC522.cpp has the functions of both SPI transports compiled.
+#if MFRC522_FAST_CS
+typedef MFRC522Base<MFRC522FastSpiTransport> MFRC522;
+extern template class MFRC522Base<MFRC522FastSpiTransport>;
+#else
+typedef MFRC522Base<MFRC522SpiTransport> MFRC522;
+#endif
+extern template class MFRC522Base<MFRC522SpiTransport>;
+
 #endif
@@ -139,19 +139,27 @@ MFRC522::StatusCode MFRC522Extended::PICC_Select(	Uid *uid,			///< Pointer to Ui
 				buffer[1] = 0x70; // NVB - Number of Valid Bits: Seven whole bytes
 				// Calculate BCC - Block Check Character
 				buffer[6] = buffer[2] ^ buffer[3] ^ buffer[4] ^ buffer[5];
-				// Calculate CRC_A
-				result = PCD_CalculateCRC(buffer, 7, &buffer[7]);
-				if (result != STATUS_OK) {
-					return result;
-				}
 				txLastBits		= 0; // 0 => All 8 bits are valid.
-				bufferUsed		= 9;
+				if (_hardwareCrc) {
+					// The MFRC522 appends the CRC_A and checks the one of the SAK
+					PCD_SetFrameCRC(true, true);
+					bufferUsed	= 7;
+				}
+				else {
+					// Calculate CRC_A
+					result = PCD_CalculateCRC(buffer, 7, &buffer[7]);
+					if (result != STATUS_OK) {
+						return result;
+					}
+					bufferUsed	= 9;
+				}
 				// Store response in the last 3 bytes of buffer (BCC and CRC_A - not needed after tx)
 				responseBuffer	= &buffer[6];
 				responseLength	= 3;
 			}
 			else { // This is an ANTICOLLISION.
 				//Serial.print(F("ANTICOLLISION: currentLevelKnownBits=")); Serial.println(currentLevelKnownBits, DEC);
+				PCD_SetFrameCRC(false, false);
 				txLastBits		= currentLevelKnownBits % 8;
 				count			= currentLevelKnownBits / 8;	// Number of whole bytes in the UID part.
 				index			= 2 + count;					// Number of whole bytes: SEL + NVB + UIDs
@@ -212,16 +220,23 @@ MFRC522::StatusCode MFRC522Extended::PICC_Select(	Uid *uid,			///< Pointer to Ui
 		}
 		
 		// Check response SAK (Select Acknowledge)
-		if (responseLength != 3 || txLastBits != 0) { // SAK must be exactly 24 bits (1 byte + CRC_A).
-			return STATUS_ERROR;
-		}
-		// Verify CRC_A - do our own calculation and store the control in buffer[2..3] - those bytes are not needed anymore.
-		result = PCD_CalculateCRC(responseBuffer, 1, &buffer[2]);
-		if (result != STATUS_OK) {
-			return result;
+		if (_hardwareCrc) {
+			if (responseLength != 1 || txLastBits != 0) { // SAK must be exactly 8 bits, the MFRC522 has checked and removed the CRC_A.
+				return STATUS_ERROR;
+			}
 		}
-		if ((buffer[2] != responseBuffer[1]) || (buffer[3] != responseBuffer[2])) {
-			return STATUS_CRC_WRONG;
+		else {
+			if (responseLength != 3 || txLastBits != 0) { // SAK must be exactly 24 bits (1 byte + CRC_A).
+				return STATUS_ERROR;
+			}
+			// Verify CRC_A - do our own calculation and store the control in buffer[2..3] - those bytes are not needed anymore.
+			result = PCD_CalculateCRC(responseBuffer, 1, &buffer[2]);
+			if (result != STATUS_OK) {
+				return result;
+			}
+			if ((buffer[2] != responseBuffer[1]) || (buffer[3] != responseBuffer[2])) {
+				return STATUS_CRC_WRONG;
+			}
 		}
 		if (responseBuffer[0] & 0x04) { // Cascade bit set - UID not complete yes
 			cascadeLevel++;
@@ -242,6 +257,37 @@ MFRC522::StatusCode MFRC522Extended::PICC_Select(	Uid *uid,			///< Pointer to Ui
 		Ats ats;
 		result = PICC_RequestATS(&ats);
 		if (result == STATUS_OK) {
+			// PPS to the fastest bit rates both sides support, see PICC_SetBitRateNegotiation()
+			if (_negotiateBitRate)
+			{
+				result = PICC_NegotiateBitRate(&ats);
+				if (result == STATUS_OK)
+				{
+					tag.ats = ats;
+					tag.blockNumber = false;
+				}
+				else if (_maxBitRate != BITRATE_106KBITS)
+				{
+					// The PICC keeps a new bit rate until it leaves the ACTIVE state:
+					// reset the field and activate it again at 106 kBaud
+					TagBitRates maxBitRate = _maxBitRate;
+					PCD_ResetBitRate();
+					PCD_AntennaOff();
+					delay(5);
+					PCD_AntennaOn();
+					byte bufferATQA[2];
+					byte bufferSize = sizeof(bufferATQA);
+					result = PICC_WakeupA(bufferATQA, &bufferSize);
+					if (result == STATUS_OK || result == STATUS_COLLISION)
+					{
+						_maxBitRate = BITRATE_106KBITS;
+						result = PICC_Select(uid, uid->size * 8);	// Keeps the ATS in tag.ats
+						_maxBitRate = maxBitRate;
+					}
+				}
+				return result;
+			}
+
 			// Check the ATS
 			if (ats.size > 0)
 			{
@@ -328,9 +374,15 @@ MFRC522::StatusCode MFRC522Extended::PICC_Select(	Uid *uid,			///< Pointer to Ui
 						dr = BITRATE_106KBITS;
 					}
 
-					PICC_PPS(ds, dr);
+					if (PICC_PPS(ds, dr) == STATUS_OK)
+					{
+						ats.sendBitRate = ds;
+						ats.receiveBitRate = dr;
+					}
 				}
 			}
+			tag.ats = ats;
+			tag.blockNumber = false;
 		}
 	}
 
@@ -365,22 +417,46 @@ MFRC522::StatusCode MFRC522Extended::PICC_RequestATS(Ats *ats)
 	// ------------+-----+-----+-----+-----+-----+-----+-----+-----+-----+-----------
 	// FSD (bytes) |  16 |  24 |  32 |  40 |  48 |  64 |  96 | 128 | 256 | RFU > 256
 	//
-	bufferATS[1] = 0x50; // FSD=64, CID=0
+	switch (MFRC522_TCL_FSD) {
+		case 96:
+			bufferATS[1] = 0x60; // FSD=96, CID=0
+			break;
+		case 128:
+			bufferATS[1] = 0x70; // FSD=128, CID=0
+			break;
+		case 256:
+			bufferATS[1] = 0x80; // FSD=256, CID=0
+			break;
+		default:
+			bufferATS[1] = 0x50; // FSD=64, CID=0
+			break;
+	}
 
-	// Calculate CRC_A
-	result = PCD_CalculateCRC(bufferATS, 2, &bufferATS[2]);
-	if (result != STATUS_OK) {
-		return result;
+	byte crcLength = 2;	// CRC_A at the end of the response
+	if (_hardwareCrc) {
+		// The MFRC522 appends the CRC_A and checks and removes the one of the ATS. It stays on for T=CL.
+		PCD_SetFrameCRC(true, true);
+		result = PCD_TransceiveData(bufferATS, 2, bufferATS, &bufferSize);
+		crcLength = 0;
 	}
+	else {
+		// Calculate CRC_A
+		result = PCD_CalculateCRC(bufferATS, 2, &bufferATS[2]);
+		if (result != STATUS_OK) {
+			return result;
+		}
 
-	// Transmit the buffer and receive the response, validate CRC_A.
-	result = PCD_TransceiveData(bufferATS, 4, bufferATS, &bufferSize, NULL, 0, true);
+		// Transmit the buffer and receive the response, validate CRC_A.
+		result = PCD_TransceiveData(bufferATS, 4, bufferATS, &bufferSize, NULL, 0, true);
+	}
 	if (result != STATUS_OK) {
 		PICC_HaltA();
 	}
 
 	// Set the ats structure data
 	ats->size = bufferATS[0];
+	ats->sendBitRate = BITRATE_106KBITS;
+	ats->receiveBitRate = BITRATE_106KBITS;
 
 	// T0 byte:
 	//
@@ -399,10 +475,10 @@ MFRC522::StatusCode MFRC522Extended::PICC_RequestATS(Ats *ats)
 	// Default FSCI is 2 (32 bytes)
 	if (ats->size > 0x01)
 	{
-		// TC1, TB1 and TA1 where NOT transmitted
-		ats->ta1.transmitted = (bool)(bufferATS[1] & 0x40);
+		// TC1, TB1 and TA1 transmitted?
+		ats->ta1.transmitted = (bool)(bufferATS[1] & 0x10);
 		ats->tb1.transmitted = (bool)(bufferATS[1] & 0x20);
-		ats->tc1.transmitted = (bool)(bufferATS[1] & 0x10);
+		ats->tc1.transmitted = (bool)(bufferATS[1] & 0x40);
 
 		// Decode FSCI
 		switch (bufferATS[1] & 0x0F)
@@ -432,9 +508,7 @@ MFRC522::StatusCode MFRC522Extended::PICC_RequestATS(Ats *ats)
 				ats->fsc = 128;
 				break;
 			case 0x08:
-				// This value cannot be hold by a byte
-				// The reason I ignore it is that MFRC255 FIFO is 64 bytes so this is not a possible value (or atleast it shouldn't)
-				//ats->fsc = 256;
+				ats->fsc = 256;
 				break;
 				// TODO: What to do with RFU (Reserved for future use)?
 			default:
@@ -519,7 +593,7 @@ MFRC522::StatusCode MFRC522Extended::PICC_RequestATS(Ats *ats)
 		ats->tc1.supportsNAD = false;
 	}
 
-	memcpy(ats->data, bufferATS, bufferSize - 2);
+	memcpy(ats->data, bufferATS, bufferSize - crcLength);
 
 	return result;
 } // End PICC_RequestATS()
@@ -541,14 +615,21 @@ MFRC522::StatusCode MFRC522Extended::PICC_PPS()
 	ppsBuffer[0] = 0xD0;	// CID is hardcoded as 0 in RATS
 	ppsBuffer[1] = 0x00;	// PPS0 indicates whether PPS1 is present
 
-	// Calculate CRC_A
-	result = PCD_CalculateCRC(ppsBuffer, 2, &ppsBuffer[2]);
-	if (result != STATUS_OK) {
-		return result;
+	if (_hardwareCrc) {
+		// The MFRC522 appends and checks the CRC_A
+		PCD_SetFrameCRC(true, true);
+		result = PCD_TransceiveData(ppsBuffer, 2, ppsBuffer, &ppsBufferSize);
 	}
+	else {
+		// Calculate CRC_A
+		result = PCD_CalculateCRC(ppsBuffer, 2, &ppsBuffer[2]);
+		if (result != STATUS_OK) {
+			return result;
+		}
 
-	// Transmit the buffer and receive the response, validate CRC_A.
-	result = PCD_TransceiveData(ppsBuffer, 4, ppsBuffer, &ppsBufferSize, NULL, 0, true);
+		// Transmit the buffer and receive the response, validate CRC_A.
+		result = PCD_TransceiveData(ppsBuffer, 4, ppsBuffer, &ppsBufferSize, NULL, 0, true);
+	}
 	if (result == STATUS_OK)
 	{
 		// Enable CRC for T=CL
@@ -584,24 +665,31 @@ MFRC522::StatusCode MFRC522Extended::PICC_PPS(TagBitRates sendBitRate,
 	ppsBuffer[0] = 0xD0;	// CID is hardcoded as 0 in RATS
 	ppsBuffer[1] = 0x11;	// PPS0 indicates whether PPS1 is present
 
-	// Bit 8 - Set to '0' as MFRC522 allows different bit rates for send and receive
-	// Bit 4 - Set to '0' as it is Reserved for future use.
-	//ppsBuffer[2] = (((sendBitRate & 0x03) << 4) | (receiveBitRate & 0x03)) & 0xE7;
-	ppsBuffer[2] = (((sendBitRate & 0x03) << 2) | (receiveBitRate & 0x03)) & 0xE7;
+	// PPS1: DSI in bits 4-3, DRI in bits 2-1, bits 8-5 are RFU and '0'
+	ppsBuffer[2] = ((sendBitRate & 0x03) << 2) | (receiveBitRate & 0x03);
 
-	// Calculate CRC_A
-	result = PCD_CalculateCRC(ppsBuffer, 3, &ppsBuffer[3]);
-	if (result != STATUS_OK) {
-		return result;
+	byte crcLength = 2;	// CRC_A at the end of the response
+	if (_hardwareCrc) {
+		// The MFRC522 appends the CRC_A and checks and removes the one of the response
+		PCD_SetFrameCRC(true, true);
+		result = PCD_TransceiveData(ppsBuffer, 3, ppsBuffer, &ppsBufferSize);
+		crcLength = 0;
+	}
+	else {
+		// Calculate CRC_A
+		result = PCD_CalculateCRC(ppsBuffer, 3, &ppsBuffer[3]);
+		if (result != STATUS_OK) {
+			return result;
+		}
+		
+		// Transmit the buffer and receive the response, validate CRC_A.
+		result = PCD_TransceiveData(ppsBuffer, 5, ppsBuffer, &ppsBufferSize, NULL, 0, true);
 	}
-	
-	// Transmit the buffer and receive the response, validate CRC_A.
-	result = PCD_TransceiveData(ppsBuffer, 5, ppsBuffer, &ppsBufferSize, NULL, 0, true);
 	if (result == STATUS_OK)
 	{
 		// Make sure it is an answer to our PPS
 		// We should receive our PPS byte and 2 CRC bytes
-		if ((ppsBufferSize == 3) && (ppsBuffer[0] == 0xD0)) {
+		if ((ppsBufferSize == 1 + crcLength) && (ppsBuffer[0] == 0xD0)) {
 			byte txReg = PCD_ReadRegister(TxModeReg) & 0x8F;
 			byte rxReg = PCD_ReadRegister(RxModeReg) & 0x8F;
 
@@ -616,8 +704,8 @@ MFRC522::StatusCode MFRC522Extended::PICC_PPS(TagBitRates sendBitRate,
 			PCD_WriteRegister(TxModeReg, txReg);
 			PCD_WriteRegister(RxModeReg, rxReg);
 
-			// At 212kBps
-			switch (sendBitRate) {
+			// The modulation width of the MFRC522 goes with the rate it sends at, DR
+			switch (receiveBitRate) {
 				case BITRATE_212KBITS:
 					{
 						//PCD_WriteRegister(ModWidthReg, 0x13);
@@ -656,6 +744,106 @@ MFRC522::StatusCode MFRC522Extended::PICC_PPS(TagBitRates sendBitRate,
 } // End PICC_PPS()
 
 
+/**
+ * Runs PPS to the highest D both the PICC, according to TA(1) of its ATS, and the PCD support in each direction,
+ * at most the maxBitRate of PICC_SetBitRateNegotiation(). A PICC that only takes the same D both ways gets the highest
+ * common one. The new rates are verified with an R(NAK), which the PICC answers with an R(ACK), and kept in
+ * ats->sendBitRate and ats->receiveBitRate. Nothing is sent if 106 kBaud is all there is.
+ *
+ * @return STATUS_OK on success, STATUS_??? otherwise. The MFRC522 is left at the new rates even if the R(NAK) failed.
+ */
+MFRC522::StatusCode MFRC522Extended::PICC_NegotiateBitRate(Ats *ats		///< The ATS of the PICC, from PICC_RequestATS().
+) {
+	if (!ats->ta1.transmitted) {
+		return STATUS_OK;
+	}
+
+	// ats->ta1.ds and dr hold the TA(1) bits: 1 for 212, 2 for 424 and 4 for 848 kBaud
+	TagBitRates ds = BITRATE_106KBITS;
+	TagBitRates dr = BITRATE_106KBITS;
+	for (byte rate = _maxBitRate; rate > BITRATE_106KBITS; rate--) {
+		byte supported = 1 << (rate - 1);
+		if (ats->ta1.sameD) {
+			if ((ats->ta1.ds & supported) && (ats->ta1.dr & supported)) {
+				ds = dr = (TagBitRates)rate;
+				break;
+			}
+			continue;
+		}
+		if (ds == BITRATE_106KBITS && (ats->ta1.ds & supported)) {
+			ds = (TagBitRates)rate;
+		}
+		if (dr == BITRATE_106KBITS && (ats->ta1.dr & supported)) {
+			dr = (TagBitRates)rate;
+		}
+	}
+	if (ds == BITRATE_106KBITS && dr == BITRATE_106KBITS) {
+		return STATUS_OK;
+	}
+
+	StatusCode result = PICC_PPS(ds, dr);
+	if (result != STATUS_OK) {
+		return result;
+	}
+	ats->sendBitRate = ds;
+	ats->receiveBitRate = dr;
+
+	// The first frames at the new rates
+	PcbBlock out;
+	PcbBlock in;
+	byte inData[4];
+	out.prologue.pcb = 0xB2;	// R(NAK), block number 0
+	out.prologue.cid = 0x00;
+	out.prologue.nad = 0x00;
+	if (ats->tc1.supportsCID) {
+		out.prologue.pcb |= 0x08;
+	}
+	out.inf.size = 0;
+	out.inf.data = NULL;
+	in.inf.size = sizeof(inData);
+	in.inf.data = inData;
+	result = TCL_Transceive(&out, &in);
+	if (result == STATUS_OK && (in.prologue.pcb & 0xF6) != 0xA2) {
+		return STATUS_ERROR;
+	}
+	return result;
+} // End PICC_NegotiateBitRate()
+
+/**
+ * With enabled, PICC_Select() of an ISO/IEC 14443-4 PICC runs PICC_NegotiateBitRate() after RATS, in place of the
+ * PPS to at most 212 kBaud it does otherwise. If that fails the field is reset and the PICC selected again at
+ * 106 kBaud. A lower maxBitRate leaves the rates a reader antenna cannot manage alone.
+ */
+void MFRC522Extended::PICC_SetBitRateNegotiation(bool enabled,				///< true to negotiate the bit rate
+												TagBitRates maxBitRate	///< The highest rate to ask for
+) {
+	_negotiateBitRate = enabled;
+	_maxBitRate = maxBitRate;
+} // End PICC_SetBitRateNegotiation()
+
+/**
+ * Both directions back to 106 kBaud without CRC_A, for the next PICC.
+ */
+void MFRC522Extended::PCD_ResetBitRate() {
+	PCD_WriteRegister(TxModeReg, 0x00);
+	PCD_WriteRegister(RxModeReg, 0x00);
+	PCD_WriteRegister(ModWidthReg, 0x26);
+} // End PCD_ResetBitRate()
+
+/**
+ * Sets TxCRCEn and RxCRCEn for the next T=CL block: every block carries a CRC_A, the MFRC522 appends it and checks and
+ * removes the one of the response, with and without PCD_SetHardwareCRC().
+ */
+void MFRC522Extended::TCL_SetFrameCRC() {
+	if (_hardwareCrc) {
+		PCD_SetFrameCRC(true, true);	// Also keeps PCD_StartCommand() from clearing them
+	}
+	else {
+		PCD_SetRegisterBitMask(TxModeReg, 0x80);
+		PCD_SetRegisterBitMask(RxModeReg, 0x80);
+	}
+} // End TCL_SetFrameCRC()
+
 /////////////////////////////////////////////////////////////////////////////////////
 // Functions for communicating with ISO/IEC 14433-4 cards
 /////////////////////////////////////////////////////////////////////////////////////
@@ -663,10 +851,10 @@ MFRC522::StatusCode MFRC522Extended::PICC_PPS(TagBitRates sendBitRate,
 MFRC522::StatusCode MFRC522Extended::TCL_Transceive(PcbBlock *send, PcbBlock *back)
 {
 	MFRC522::StatusCode result;
-	byte inBuffer[FIFO_SIZE];
-	byte inBufferSize = FIFO_SIZE;
-	byte outBuffer[send->inf.size + 5]; // PCB + CID + NAD + INF + EPILOGUE (CRC)
-	byte outBufferOffset = 1;
+	byte inBuffer[MFRC522_TCL_FSD];
+	uint16_t inBufferSize = MFRC522_TCL_FSD;
+	byte outBuffer[send->inf.size + 3]; // PCB + CID + NAD + INF, the MFRC522 adds the EPILOGUE (CRC)
+	uint16_t outBufferOffset = 1;
 	byte inBufferOffset = 1;
 
 	// Set the PCB byte
@@ -690,20 +878,11 @@ MFRC522::StatusCode MFRC522Extended::TCL_Transceive(PcbBlock *send, PcbBlock *ba
 		outBufferOffset += send->inf.size;
 	}
 
-	// Is the CRC enabled for transmission?
-	byte txModeReg = PCD_ReadRegister(TxModeReg);
-	if ((txModeReg & 0x80) != 0x80) {
-		// Calculate CRC_A
-		result = PCD_CalculateCRC(outBuffer, outBufferOffset, &outBuffer[outBufferOffset]);
-		if (result != STATUS_OK) {
-			return result;
-		}
-
-		outBufferOffset += 2;
-	}
+	// The MFRC522 appends the CRC_A and checks and removes the one of the response
+	TCL_SetFrameCRC();
 
-	// Transceive the block
-	result = PCD_TransceiveData(outBuffer, outBufferOffset, inBuffer, &inBufferSize);
+	// Transceive the block, over 64 bytes it streams through the FIFO
+	result = PCD_TransceiveStream(outBuffer, outBufferOffset, inBuffer, &inBufferSize);
 	if (result != STATUS_OK) {
 		return result;
 	}
@@ -723,33 +902,6 @@ MFRC522::StatusCode MFRC522Extended::TCL_Transceive(PcbBlock *send, PcbBlock *ba
 		inBufferOffset++;
 	}
 
-	// Check if CRC is taken care of by MFRC522
-	byte rxModeReg = PCD_ReadRegister(TxModeReg);
-	if ((rxModeReg & 0x80) != 0x80) {
-		Serial.print("CRC is not taken care of by MFRC522: ");
-		Serial.println(rxModeReg, HEX);
-
-		// Check the CRC
-		// We need at least the CRC_A value.
-		if ((int)(inBufferSize - inBufferOffset) < 2) {
-			return STATUS_CRC_WRONG;
-		}
-
-		// Verify CRC_A - do our own calculation and store the control in controlBuffer.
-		byte controlBuffer[2];
-		MFRC522::StatusCode status = PCD_CalculateCRC(inBuffer, inBufferSize - 2, controlBuffer);
-		if (status != STATUS_OK) {
-			return status;
-		}
-
-		if ((inBuffer[inBufferSize - 2] != controlBuffer[0]) || (inBuffer[inBufferSize - 1] != controlBuffer[1])) {
-			return STATUS_CRC_WRONG;
-		}
-
-		// Take away the CRC bytes
-		inBufferSize -= 2;
-	}
-
 	// Got more data?
 	if (inBufferSize > inBufferOffset) {
 		if ((inBufferSize - inBufferOffset) > back->inf.size) {
@@ -763,7 +915,7 @@ MFRC522::StatusCode MFRC522Extended::TCL_Transceive(PcbBlock *send, PcbBlock *ba
 	}
 
 	// If the response is a R-Block check NACK
-	if (((inBuffer[0] & 0xC0) == 0x80) && (inBuffer[0] & 0x20)) {
+	if (((inBuffer[0] & 0xC0) == 0x80) && (inBuffer[0] & 0x10)) {
 		return STATUS_MIFARE_NACK;
 	}
 	
@@ -778,8 +930,8 @@ MFRC522::StatusCode MFRC522Extended::TCL_Transceive(TagInfo *tag, byte *sendData
 
 	PcbBlock out;
 	PcbBlock in;
-	byte outBuffer[FIFO_SIZE];
-	byte outBufferSize = FIFO_SIZE;
+	byte outBuffer[MFRC522_TCL_FSD - 4];	// The INF field of a frame of FSD bytes with PCB, CID and CRC_A
+	byte outBufferSize = sizeof(outBuffer);
 	byte totalBackLen = *backLen;
 
 	// This command sends an I-Block
@@ -794,7 +946,29 @@ MFRC522::StatusCode MFRC522Extended::TCL_Transceive(TagInfo *tag, byte *sendData
 	out.prologue.pcb &= 0xFB;
 	out.prologue.nad = 0x00;
 
-	// Set the block number
+	// A block must fit the FSC of the PICC: the data it does not take goes ahead in a chain of I-blocks,
+	// each acknowledged with an R(ACK) of its block number
+	byte maxInfSize = (byte)min(tag->ats.fsc - ((out.prologue.pcb & 0x08) ? 4 : 3), 0xFF);
+	while (sendData && sendLen > maxInfSize) {
+		out.prologue.pcb = (out.prologue.pcb & 0xEE) | 0x10 | (tag->blockNumber ? 0x01 : 0x00);
+		out.inf.size = maxInfSize;
+		out.inf.data = sendData;
+		in.inf.data = outBuffer;
+		in.inf.size = outBufferSize;
+
+		result = TCL_Transceive(&out, &in);
+		if (result != STATUS_OK) {
+			return result;
+		}
+		if ((in.prologue.pcb & 0xF6) != 0xA2 || (bool)(in.prologue.pcb & 0x01) != tag->blockNumber) {
+			return STATUS_ERROR;
+		}
+		tag->blockNumber = !tag->blockNumber;
+		sendData += maxInfSize;
+		sendLen -= maxInfSize;
+	}
+	// The last block, not chained. Set the block number
+	out.prologue.pcb &= 0xEE;
 	if (tag->blockNumber) {
 		out.prologue.pcb |= 0x01;
 	}
@@ -821,7 +995,7 @@ MFRC522::StatusCode MFRC522Extended::TCL_Transceive(TagInfo *tag, byte *sendData
 	// Swap block number on success
 	tag->blockNumber = !tag->blockNumber;
 
-	if (backData && (backLen > 0)) {
+	if (backData && backLen) {
 		if (*backLen < in.inf.size)
 			return STATUS_NO_ROOM;
 
@@ -837,14 +1011,14 @@ MFRC522::StatusCode MFRC522Extended::TCL_Transceive(TagInfo *tag, byte *sendData
 	// Send an ACK to receive more data
 	// TODO: Should be checked I've never needed to send an ACK
 	while (in.prologue.pcb & 0x10) {
-		byte ackData[FIFO_SIZE];
-		byte ackDataSize = FIFO_SIZE;
+		byte ackData[MFRC522_TCL_FSD - 4];
+		byte ackDataSize = sizeof(ackData);
 
 		result = TCL_TransceiveRBlock(tag, true, ackData, &ackDataSize);
 		if (result != STATUS_OK)
 			return result;
 
-		if (backData && (backLen > 0)) {
+		if (backData && backLen) {
 			if ((*backLen + ackDataSize) > totalBackLen)
 				return STATUS_NO_ROOM;
 
@@ -865,8 +1039,8 @@ MFRC522::StatusCode MFRC522Extended::TCL_TransceiveRBlock(TagInfo *tag, bool ack
 
 	PcbBlock out;
 	PcbBlock in;
-	byte outBuffer[FIFO_SIZE];
-	byte outBufferSize = FIFO_SIZE;
+	byte outBuffer[MFRC522_TCL_FSD - 4];	// The INF field of a frame of FSD bytes with PCB, CID and CRC_A
+	byte outBufferSize = sizeof(outBuffer);
 
 	// This command sends an R-Block
 	if (ack)
@@ -936,6 +1110,7 @@ MFRC522::StatusCode MFRC522Extended::TCL_Deselect(TagInfo *tag)
 		outBufferSize = 2;
 	}
 
+	TCL_SetFrameCRC();
 	result = PCD_TransceiveData(outBuffer, outBufferSize, inBuffer, &inBufferSize);
 	if (result != STATUS_OK) {
 		return result;
@@ -1103,11 +1278,7 @@ bool MFRC522Extended::PICC_IsNewCardPresent() {
 	byte bufferATQA[2];
 	byte bufferSize = sizeof(bufferATQA);
 
-	// Reset baud rates
-	PCD_WriteRegister(TxModeReg, 0x00);
-	PCD_WriteRegister(RxModeReg, 0x00);
-	// Reset ModWidthReg
-	PCD_WriteRegister(ModWidthReg, 0x26);
+	PCD_ResetBitRate();
 
 	MFRC522::StatusCode result = PICC_RequestA(bufferATQA, &bufferSize);
 
@@ -1132,6 +1303,9 @@ bool MFRC522Extended::PICC_IsNewCardPresent() {
 		tag.ats.tc1.supportsCID = true;
 		tag.ats.tc1.supportsNAD = false;
 
+		tag.ats.sendBitRate = MFRC522Extended::BITRATE_106KBITS;
+		tag.ats.receiveBitRate = MFRC522Extended::BITRATE_106KBITS;
+
 		memset(tag.ats.data, 0, FIFO_SIZE - 2);
 
 		tag.blockNumber = false;
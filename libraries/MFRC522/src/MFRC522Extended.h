@@ -9,6 +9,19 @@
 #include <Arduino.h>
 #include "MFRC522.h"
 
+// Largest ISO/IEC 14443-4 frame the reader takes, announced with RATS: 64, 96, 128 or 256 bytes. Frames over 64 bytes
+// stream through the FIFO, see PCD_TransceiveStream(). TCL_Transceive() keeps three buffers of about this size on the
+// stack, with 256 that is some 770 bytes: on AVR the default is 64. MFRC522Extended.cpp is compiled on its own, so a
+// #define in the sketch does not reach it: set it as a build flag, -DMFRC522_TCL_FSD=256 (build_flags in PlatformIO,
+// compiler.cpp.extra_flags in platform.local.txt for the Arduino IDE).
+#ifndef MFRC522_TCL_FSD
+#if defined(ARDUINO_ARCH_AVR)
+#define MFRC522_TCL_FSD 64
+#else
+#define MFRC522_TCL_FSD 256
+#endif
+#endif
+
 class MFRC522Extended : public MFRC522 {
 		
 public:
@@ -23,7 +36,7 @@ public:
 	// Structure to store ISO/IEC 14443-4 ATS
 	typedef struct {
 		byte size;
-		byte fsc;                 // Frame size for proximity card
+		uint16_t fsc;             // Frame size for proximity card
 
 		struct {
 			bool transmitted;
@@ -44,8 +57,12 @@ public:
 			bool supportsNAD;
 		} tc1;
 
+		// Bit rates in use, 106 kBaud until PPS. Set by PICC_Select()
+		TagBitRates sendBitRate;	// DS, PICC to PCD
+		TagBitRates receiveBitRate;	// DR, PCD to PICC
+
 		// Raw data from ATS
-		byte data[FIFO_SIZE - 2]; // ATS cannot be bigger than FSD - 2 bytes (CRC), according to ISO 14443-4 5.2.2
+		byte data[FIFO_SIZE - 2]; // ATS cannot be bigger than FSD - 2 bytes (CRC), according to ISO 14443-4 5.2.2. Real ones fit the FIFO.
 	} Ats;
 
 	// A struct used for passing the PICC information
@@ -77,9 +94,9 @@ public:
 	/////////////////////////////////////////////////////////////////////////////////////
 	// Contructors
 	/////////////////////////////////////////////////////////////////////////////////////
-	MFRC522Extended() : MFRC522() {};
-	MFRC522Extended(uint8_t rst) : MFRC522(rst) {};
-	MFRC522Extended(uint8_t ss, uint8_t rst) : MFRC522(ss, rst) {};
+	MFRC522Extended() : MFRC522(), _negotiateBitRate(false), _maxBitRate(BITRATE_848KBITS) {};
+	MFRC522Extended(uint8_t rst) : MFRC522(rst), _negotiateBitRate(false), _maxBitRate(BITRATE_848KBITS) {};
+	MFRC522Extended(uint8_t ss, uint8_t rst) : MFRC522(ss, rst), _negotiateBitRate(false), _maxBitRate(BITRATE_848KBITS) {};
 	
 	/////////////////////////////////////////////////////////////////////////////////////
 	// Functions for communicating with PICCs
@@ -88,6 +105,8 @@ public:
 	StatusCode PICC_RequestATS(Ats *ats);
 	StatusCode PICC_PPS();	                                                  // PPS command without bitrate parameter
 	StatusCode PICC_PPS(TagBitRates sendBitRate, TagBitRates receiveBitRate); // Different D values
+	StatusCode PICC_NegotiateBitRate(Ats *ats);
+	void PICC_SetBitRateNegotiation(bool enabled, TagBitRates maxBitRate = BITRATE_848KBITS);
 	
 	/////////////////////////////////////////////////////////////////////////////////////
 	// Functions for communicating with ISO/IEC 14433-4 cards
@@ -115,6 +134,12 @@ public:
 	/////////////////////////////////////////////////////////////////////////////////////
 	bool PICC_IsNewCardPresent() override; // overrride
 	bool PICC_ReadCardSerial() override; // overrride
+
+protected:
+	bool _negotiateBitRate;		// PICC_SetBitRateNegotiation()
+	TagBitRates _maxBitRate;
+	void PCD_ResetBitRate();
+	void TCL_SetFrameCRC();
 };
 
 #endif
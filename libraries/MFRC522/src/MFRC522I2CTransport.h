@@ -0,0 +1,80 @@
+/**
+ * The MFRC522 on the I2C bus, datasheet section 8.1.3:
+ *
+ * 		#include <Wire.h>
+ * 		#include <MFRC522I2CTransport.h>
+ *
+ * 		MFRC522_I2C mfrc522(MFRC522I2CTransport(0x28), RST_PIN);
+ *
+ * 		Wire.begin();
+ * 		mfrc522.PCD_Init();
+ *
+ * The address is set by the pins EA and D1 to D6 of the chip. Including this file compiles the functions of
+ * MFRC522Base for the transport in the sketch, MFRC522.cpp only has them for SPI.
+ */
+#ifndef MFRC522I2CTransport_h
+#define MFRC522I2CTransport_h
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "MFRC522Impl.h"
+
+// Bytes per I2C transfer, the AVR Wire library buffers 32 including the register address.
+#ifndef MFRC522_I2C_CHUNK
+#define MFRC522_I2C_CHUNK 31
+#endif
+
+class MFRC522I2CTransport {
+public:
+	MFRC522I2CTransport(byte address = 0x28, TwoWire &wire = Wire) : _address(address), _wire(&wire) {}
+
+	void begin() {}
+	void beginTransaction() {}
+	void endTransaction() {}
+
+	void writeRegister(byte reg, byte value) {
+		writeRegister(reg, 1, &value);
+	}
+
+	// The MFRC522 does not increment the register address, all bytes go to the same register.
+	void writeRegister(byte reg, byte count, const byte *values) {
+		do {
+			byte chunk = count < MFRC522_I2C_CHUNK ? count : MFRC522_I2C_CHUNK;
+			_wire->beginTransmission(_address);
+			_wire->write(reg >> 1);				// The register address, unshifted
+			_wire->write(values, chunk);
+			_wire->endTransmission();
+			values += chunk;
+			count -= chunk;
+		} while (count > 0);
+	}
+
+	byte readRegister(byte reg) {
+		byte value;
+		readRegister(reg, 1, &value);
+		return value;
+	}
+
+	void readRegister(byte reg, byte count, byte *values) {
+		while (count > 0) {
+			byte chunk = count < MFRC522_I2C_CHUNK ? count : MFRC522_I2C_CHUNK;
+			_wire->beginTransmission(_address);
+			_wire->write(reg >> 1);
+			_wire->endTransmission(false);		// Repeated start for the read
+			_wire->requestFrom(_address, chunk);
+			for (byte index = 0; index < chunk; index++) {
+				values[index] = _wire->available() ? _wire->read() : 0;
+			}
+			values += chunk;
+			count -= chunk;
+		}
+	}
+
+private:
+	byte _address;		// 7 bit I2C address of the MFRC522
+	TwoWire *_wire;
+};
+
+typedef MFRC522Base<MFRC522I2CTransport> MFRC522_I2C;
+
+#endif
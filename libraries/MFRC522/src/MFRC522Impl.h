@@ -0,0 +1,2943 @@
+/*
+* MFRC522Impl.h - Library to use ARDUINO RFID MODULE KIT 13.56 MHZ WITH TAGS SPI W AND R BY COOQROBOT.
+* NOTE: Please also check the comments in MFRC522.h - they provide useful hints and background information.
+* Released into the public domain.
+* 
+* The functions of MFRC522Base for any transport. MFRC522.cpp instantiates them for the SPI transports,
+* the headers of the other transports include this file so the compiler instantiates them where they are used.
+*/
+#ifndef MFRC522Impl_h
+#define MFRC522Impl_h
+
+#include <Arduino.h>
+#include "MFRC522.h"
+#include "MFRC522KeyCache.h"
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Functions for setting up the Arduino
+/////////////////////////////////////////////////////////////////////////////////////
+/**
+ * Constructor.
+ */
+template <class Transport>
+MFRC522Base<Transport>::MFRC522Base(): MFRC522Base(Transport(), UNUSED_PIN) { // The transport's default, SS for SPI. UNUSED_PIN means there is no connection from Arduino to MFRC522's reset and power down input
+} // End constructor
+
+/**
+ * Constructor.
+ * Prepares the output pins.
+ */
+template <class Transport>
+MFRC522Base<Transport>::MFRC522Base(	byte resetPowerDownPin	///< Arduino pin connected to MFRC522's reset and power down input (Pin 6, NRSTPD, active low). If there is no connection from the CPU to NRSTPD, set this to UINT8_MAX. In this case, only soft reset will be used in PCD_Init().
+								): MFRC522Base(Transport(), resetPowerDownPin) { // SS is the default of the SPI transports
+} // End constructor
+
+/**
+ * Constructor.
+ * Prepares the output pins.
+ */
+template <class Transport>
+MFRC522Base<Transport>::MFRC522Base(	byte chipSelectPin,		///< Arduino pin connected to MFRC522's SPI slave select input (Pin 24, NSS, active low)
+									byte resetPowerDownPin	///< Arduino pin connected to MFRC522's reset and power down input (Pin 6, NRSTPD, active low). If there is no connection from the CPU to NRSTPD, set this to UINT8_MAX. In this case, only soft reset will be used in PCD_Init().
+								): MFRC522Base(Transport(chipSelectPin), resetPowerDownPin) {
+} // End constructor
+
+/**
+ * Constructor.
+ * Talks to the MFRC522 through the given transport, for example an MFRC522I2CTransport.
+ */
+template <class Transport>
+MFRC522Base<Transport>::MFRC522Base(	const Transport &transport,	///< The bus and address of the MFRC522, copied.
+									byte resetPowerDownPin		///< Arduino pin connected to MFRC522's reset and power down input (Pin 6, NRSTPD, active low). If there is no connection from the CPU to NRSTPD, set this to UINT8_MAX. In this case, only soft reset will be used in PCD_Init().
+								): _transport(transport) {
+	_resetPowerDownPin = resetPowerDownPin;
+	_registerCacheEnabled = false;
+	_registerCacheValid = 0;
+	_softwareCrc = false;
+	_hardwareCrc = false;
+	_frameCrcSet = false;
+	_timeoutMicros[OPERATION_TRANSCEIVE] = 36000;		// Longer than the 25ms timer set by PCD_Init()
+	_timeoutMicros[OPERATION_AUTHENTICATE] = 36000;
+	_timeoutMicros[OPERATION_CALCULATE_CRC] = 5000;		// 64 bytes take the coprocessor less than 100μs
+	_pending.active = false;
+	_transceiveInterruptEnabled = false;
+	_transceiveInterrupt = false;
+	_requestWindowTicks = 0;
+	_requestTimer = false;
+	_tracking = false;
+	_presenceIntervalMillis = 250;
+	_idlePauseMaxMillis = 0;
+	_idlePauseMillis = 0;
+	_lastAnswerMillis = 0;
+	_lastRequestMillis = 0;
+	_keyCache = nullptr;
+} // End constructor
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Basic interface functions for communicating with the MFRC522
+/////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Enables or disables the shadow cache of the configuration registers (modes, antenna, modulation, gain, timer
+ * settings, interrupt enables). With the cache enabled a write of the value the register already holds is skipped
+ * and reads and the read-modify-write of PCD_SetRegisterBitMask() and PCD_ClearRegisterBitMask() are served from RAM.
+ * Costs 30 bytes of RAM.
+ * 
+ * The cache follows every write made through this class and soft resets. Call PCD_InvalidateRegisterCache()
+ * if the chip is reset or written to in any other way.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PCD_SetRegisterCache(	bool enabled	///< true to keep shadow copies, false to always talk to the chip
+												) {
+	_registerCacheEnabled = enabled;
+	_registerCacheValid = 0;
+} // End PCD_SetRegisterCache()
+
+/**
+ * Forgets the shadow copies, the next access of each register goes to the chip.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PCD_InvalidateRegisterCache() {
+	_registerCacheValid = 0;
+} // End PCD_InvalidateRegisterCache()
+
+/**
+ * Looks up the shadow cache slot of a register.
+ * 
+ * @return The slot with the REGISTER_CACHE_* flags, REGISTER_NOT_CACHED if the register or the cache is not used.
+ */
+template <class Transport>
+byte MFRC522Base<Transport>::PCD_RegisterCacheSlot(	PCD_Register reg	///< The register. One of the PCD_Register enums.
+													) {
+	if (!_registerCacheEnabled) {
+		return REGISTER_NOT_CACHED;
+	}
+	return pgm_read_byte(&registerCacheSlots[(reg >> 1) & 0x3F]);
+} // End PCD_RegisterCacheSlot()
+
+/**
+ * Keeps the register cache up to date for a write.
+ * 
+ * @return false if the register holds the value already and the write can be skipped.
+ */
+template <class Transport>
+bool MFRC522Base<Transport>::PCD_RegisterWriteNeeded(	PCD_Register reg,	///< The register to write to. One of the PCD_Register enums.
+														byte value			///< The value to write.
+													) {
+	byte slot = PCD_RegisterCacheSlot(reg);
+	if (slot != REGISTER_NOT_CACHED) {
+		uint32_t slotBit = (uint32_t)1 << (slot & REGISTER_CACHE_SLOT);
+		if ((slot & REGISTER_CACHE_STROBE) && (value & 0x80)) {
+			_registerCacheValid &= ~slotBit;
+		} else if ((_registerCacheValid & slotBit) && _registerCache[slot & REGISTER_CACHE_SLOT] == value) {
+			return false;
+		} else {
+			_registerCache[slot & REGISTER_CACHE_SLOT] = value;
+			_registerCacheValid |= slotBit;
+		}
+	} else if (_registerCacheEnabled && reg == CommandReg && (value & 0x0F) == PCD_SoftReset) {
+		_registerCacheValid = 0;	// All registers go back to their reset values
+	}
+	return true;
+} // End PCD_RegisterWriteNeeded()
+
+/**
+ * Writes a byte to a register inside a bus transaction already begun.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PCD_TransferRegister(	PCD_Register reg,	///< The register to write to. One of the PCD_Register enums.
+													byte value			///< The value to write.
+												) {
+	if (!PCD_RegisterWriteNeeded(reg, value)) {
+		return;
+	}
+	_transport.writeRegister(reg, value);
+} // End PCD_TransferRegister()
+
+/**
+ * Writes a number of bytes to a register inside a bus transaction already begun.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PCD_TransferRegister(	PCD_Register reg,	///< The register to write to. One of the PCD_Register enums.
+													byte count,			///< The number of bytes to write to the register
+													byte *values		///< The values to write. Byte array.
+												) {
+	byte slot = PCD_RegisterCacheSlot(reg);
+	if (slot != REGISTER_NOT_CACHED) {
+		_registerCacheValid &= ~((uint32_t)1 << (slot & REGISTER_CACHE_SLOT));
+	}
+	_transport.writeRegister(reg, count, values);
+} // End PCD_TransferRegister()
+
+/**
+ * Writes a byte to the specified register in the MFRC522 chip.
+ * The interface is described in the datasheet section 8.1.2.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PCD_WriteRegister(	PCD_Register reg,	///< The register to write to. One of the PCD_Register enums.
+												byte value			///< The value to write.
+											) {
+	if (!PCD_RegisterWriteNeeded(reg, value)) {
+		return;	// The register holds this value already
+	}
+	_transport.beginTransaction();
+	_transport.writeRegister(reg, value);
+	_transport.endTransaction();
+} // End PCD_WriteRegister()
+
+/**
+ * Writes a number of bytes to the specified register in the MFRC522 chip.
+ * The interface is described in the datasheet section 8.1.2.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PCD_WriteRegister(	PCD_Register reg,	///< The register to write to. One of the PCD_Register enums.
+												byte count,			///< The number of bytes to write to the register
+												byte *values		///< The values to write. Byte array.
+											) {
+	_transport.beginTransaction();
+	PCD_TransferRegister(reg, count, values);
+	_transport.endTransaction();
+} // End PCD_WriteRegister()
+
+/**
+ * Writes a script of register values in one bus transaction, for example a setup sequence:
+ * 
+ * 		static constexpr MFRC522::RegisterWrite script[] = {
+ * 			{MFRC522::TxModeReg, 0x00}, {MFRC522::RxModeReg, 0x00}, {MFRC522::ModWidthReg, 0x26}
+ * 		};
+ * 		mfrc522.PCD_WriteRegisters(script, sizeof(script) / sizeof(script[0]));
+ * 
+ * The registers are written in order, the bus is acquired once instead of once per register.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PCD_WriteRegisters(	const RegisterWrite *script,	///< The register writes, in RAM.
+													byte count						///< The number of entries in script.
+												) {
+	_transport.beginTransaction();
+	for (byte index = 0; index < count; index++) {
+		PCD_TransferRegister(script[index].reg, script[index].value);
+	}
+	_transport.endTransaction();
+} // End PCD_WriteRegisters()
+
+/**
+ * Like PCD_WriteRegisters(), with the script in flash (PROGMEM).
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PCD_WriteRegisters_P(	const RegisterWrite *script,	///< The register writes, in PROGMEM.
+													byte count						///< The number of entries in script.
+												) {
+	_transport.beginTransaction();
+	for (byte index = 0; index < count; index++) {
+		PCD_TransferRegister((PCD_Register)pgm_read_byte(&script[index].reg), pgm_read_byte(&script[index].value));
+	}
+	_transport.endTransaction();
+} // End PCD_WriteRegisters_P()
+
+/**
+ * Reads a byte from the specified register in the MFRC522 chip.
+ * The interface is described in the datasheet section 8.1.2.
+ */
+template <class Transport>
+byte MFRC522Base<Transport>::PCD_ReadRegister(	PCD_Register reg	///< The register to read from. One of the PCD_Register enums.
+											) {
+	byte slot = PCD_RegisterCacheSlot(reg);
+	uint32_t slotBit = 0;
+	if (slot != REGISTER_NOT_CACHED) {
+		slotBit = (uint32_t)1 << (slot & REGISTER_CACHE_SLOT);
+		if (!(slot & REGISTER_CACHE_VOLATILE) && (_registerCacheValid & slotBit)) {
+			return _registerCache[slot & REGISTER_CACHE_SLOT];
+		}
+	}
+	_transport.beginTransaction();
+	byte value = _transport.readRegister(reg);
+	_transport.endTransaction();
+	if (slotBit) {
+		_registerCache[slot & REGISTER_CACHE_SLOT] = value;
+		_registerCacheValid |= slotBit;
+	}
+	return value;
+} // End PCD_ReadRegister()
+
+/**
+ * Reads a number of bytes from the specified register in the MFRC522 chip.
+ * The interface is described in the datasheet section 8.1.2.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PCD_ReadRegister(	PCD_Register reg,	///< The register to read from. One of the PCD_Register enums.
+												byte count,			///< The number of bytes to read
+												byte *values,		///< Byte array to store the values in.
+												byte rxAlign		///< Only bit positions rxAlign..7 in values[0] are updated.
+											) {
+	if (count == 0) {
+		return;
+	}
+	byte first = values[0];
+	_transport.beginTransaction();
+	_transport.readRegister(reg, count, values);
+	_transport.endTransaction();
+	if (rxAlign) {		// Only update bit positions rxAlign..7 in values[0]
+		// Create bit mask for bit positions rxAlign..7
+		byte mask = (0xFF << rxAlign) & 0xFF;
+		// Apply mask to both the former value of values[0] and the new data.
+		values[0] = (first & ~mask) | (values[0] & mask);
+	}
+} // End PCD_ReadRegister()
+
+/**
+ * Sets the bits given in mask in register reg.
+ * With the register cache enabled the current value is taken from the shadow copy if there is one.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PCD_SetRegisterBitMask(	PCD_Register reg,	///< The register to update. One of the PCD_Register enums.
+														byte mask			///< The bits to set.
+													) { 
+	byte tmp;
+	byte slot = PCD_RegisterCacheSlot(reg);
+	if (slot != REGISTER_NOT_CACHED && (_registerCacheValid & ((uint32_t)1 << (slot & REGISTER_CACHE_SLOT)))) {
+		tmp = _registerCache[slot & REGISTER_CACHE_SLOT];
+	} else {
+		tmp = PCD_ReadRegister(reg);
+	}
+	PCD_WriteRegister(reg, tmp | mask);			// set bit mask
+} // End PCD_SetRegisterBitMask()
+
+/**
+ * Clears the bits given in mask from register reg.
+ * With the register cache enabled the current value is taken from the shadow copy if there is one.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PCD_ClearRegisterBitMask(	PCD_Register reg,	///< The register to update. One of the PCD_Register enums.
+														byte mask			///< The bits to clear.
+													  ) {
+	byte tmp;
+	byte slot = PCD_RegisterCacheSlot(reg);
+	if (slot != REGISTER_NOT_CACHED && (_registerCacheValid & ((uint32_t)1 << (slot & REGISTER_CACHE_SLOT)))) {
+		tmp = _registerCache[slot & REGISTER_CACHE_SLOT];
+	} else {
+		tmp = PCD_ReadRegister(reg);
+	}
+	PCD_WriteRegister(reg, tmp & (~mask));		// clear bit mask
+} // End PCD_ClearRegisterBitMask()
+
+/**
+ * Chooses how PCD_CalculateCRC() works: in software with CalculateCRC_A(), or with the CRC coprocessor of the MFRC522
+ * (the default). The coprocessor costs a dozen SPI transactions per CRC, the software a table lookup per byte.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PCD_SetSoftwareCRC(	bool enabled	///< true for the software CRC
+												) {
+	_softwareCrc = enabled;
+} // End PCD_SetSoftwareCRC()
+
+/**
+ * Lets the MFRC522 append and check the CRC_A of framed commands (TxCRCEn and RxCRCEn), instead of a PCD_CalculateCRC()
+ * before sending and after receiving. The CRC is switched on for the final SELECT, READ, HLTA, the MIFARE WRITE steps and
+ * RATS, and off again for REQA, WUPA and the anticollision frames, which carry none.
+ * Each switch is a read-modify-write of TxModeReg and RxModeReg, best combined with PCD_SetRegisterCache() so that
+ * only the changes reach the chip.
+ * With the hardware CRC MIFARE_Read() returns 16 bytes, the chip has removed the CRC_A.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PCD_SetHardwareCRC(	bool enabled	///< true for the CRC of the MFRC522
+												) {
+	if (_hardwareCrc && !enabled) {
+		PCD_ClearRegisterBitMask(TxModeReg, 0x80);
+		PCD_ClearRegisterBitMask(RxModeReg, 0x80);
+	}
+	_hardwareCrc = enabled;
+} // End PCD_SetHardwareCRC()
+
+/**
+ * Sets how long the library waits for an operation before it gives up with STATUS_TIMEOUT, measured with micros().
+ * For a frame to a PICC the timer of the MFRC522, 25ms after PCD_Init(), normally ends the wait first, the timeout
+ * only matters when the chip does not respond. The defaults are 36ms for a frame and for MFAuthent and 5ms for a CRC.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PCD_SetTimeout(	PCD_Operation operation,	///< One of the PCD_Operation enums.
+												uint32_t timeoutMicros		///< The timeout in microseconds.
+											) {
+	if (operation < OPERATION_COUNT) {
+		_timeoutMicros[operation] = timeoutMicros;
+	}
+} // End PCD_SetTimeout()
+
+/**
+ * Returns the timeout of an operation in microseconds, see PCD_SetTimeout().
+ */
+template <class Transport>
+uint32_t MFRC522Base<Transport>::PCD_GetTimeout(	PCD_Operation operation	///< One of the PCD_Operation enums.
+												) {
+	return operation < OPERATION_COUNT ? _timeoutMicros[operation] : 0;
+} // End PCD_GetTimeout()
+
+/**
+ * Sets how long REQA, WUPA and HLTA wait for an answer. An empty field costs this long per REQA instead of the 25ms
+ * timer set by PCD_Init(): a PICC sends its ATQA about 90μs after the REQA, and ISO/IEC 14443-3 takes any answer
+ * later than 1ms after HLTA for none. Once a PICC answers the timer is back at 25ms for SELECT and the commands after it.
+ * 0, the default, leaves the timer at 25ms for all frames.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PCD_SetRequestWindow(	uint16_t windowMicros	///< The wait in microseconds, 1000 is a good value.
+												) {
+	PCD_SetRequestTimer(false);
+	_requestWindowTicks = (windowMicros + 24) / 25;		// Timer periods of 25μs, see initScript
+} // End PCD_SetRequestWindow()
+
+/**
+ * Loads TReloadReg with the window of PCD_SetRequestWindow() or the 25ms of PCD_Init(), if it does not hold it already.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PCD_SetRequestTimer(	bool request	///< true for the request window, false for 25ms
+												) {
+	if (request == _requestTimer || (request && _requestWindowTicks == 0)) {
+		return;
+	}
+	uint16_t reload = request ? _requestWindowTicks : 1000;
+	RegisterWrite script[] = {
+		{TReloadRegH, (byte)(reload >> 8)},
+		{TReloadRegL, (byte)(reload & 0xFF)}
+	};
+	PCD_WriteRegisters(script, sizeof(script) / sizeof(script[0]));
+	_requestTimer = request;
+} // End PCD_SetRequestTimer()
+
+/**
+ * Sets TxCRCEn and RxCRCEn for the next frame if PCD_SetHardwareCRC() is on, does nothing otherwise.
+ * With tx the MFRC522 appends a CRC_A to the frame, with rx it checks and removes the CRC_A of the response.
+ * The setting holds for one frame: PCD_StartCommand() clears both bits for a frame without a call to this first.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PCD_SetFrameCRC(	bool tx,	///< true to append a CRC_A when sending
+												bool rx		///< true to check the CRC_A when receiving
+											) {
+	if (!_hardwareCrc) {
+		return;
+	}
+	if (tx) {
+		PCD_SetRegisterBitMask(TxModeReg, 0x80);
+	} else {
+		PCD_ClearRegisterBitMask(TxModeReg, 0x80);
+	}
+	if (rx) {
+		PCD_SetRegisterBitMask(RxModeReg, 0x80);
+	} else {
+		PCD_ClearRegisterBitMask(RxModeReg, 0x80);
+	}
+	_frameCrcSet = true;
+} // End PCD_SetFrameCRC()
+
+/**
+ * Calculates a CRC_A, in software or with the CRC coprocessor in the MFRC522, see PCD_SetSoftwareCRC().
+ * 
+ * @return STATUS_OK on success, STATUS_??? otherwise.
+ */
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::PCD_CalculateCRC(	byte *data,		///< In: Pointer to the data to transfer to the FIFO for CRC calculation.
+																byte length,	///< In: The number of bytes to transfer.
+																byte *result	///< Out: Pointer to result buffer. Result is written to result[0..1], low byte first.
+									 ) {
+	if (_softwareCrc) {
+		CalculateCRC_A(data, length, result);
+		return STATUS_OK;
+	}
+	_transport.beginTransaction();	// One transaction for the setup
+	PCD_TransferRegister(CommandReg, PCD_Idle);			// Stop any active command.
+	PCD_TransferRegister(DivIrqReg, 0x04);				// Clear the CRCIRq interrupt request bit
+	PCD_TransferRegister(FIFOLevelReg, 0x80);			// FlushBuffer = 1, FIFO initialization
+	PCD_TransferRegister(FIFODataReg, length, data);	// Write data to the FIFO
+	PCD_TransferRegister(CommandReg, PCD_CalcCRC);		// Start the calculation
+	_transport.endTransaction();
+	
+	// Wait for the CRC calculation to complete, at most the timeout of OPERATION_CALCULATE_CRC.
+	const uint32_t start = micros();
+	for (;;) {
+		// DivIrqReg[7..0] bits are: Set2 reserved reserved MfinActIRq reserved CRCIRq reserved reserved
+		byte n = PCD_ReadRegister(DivIrqReg);
+		if (n & 0x04) {									// CRCIRq bit set - calculation done
+			PCD_WriteRegister(CommandReg, PCD_Idle);	// Stop calculating CRC for new content in the FIFO.
+			// Transfer the result from the registers to the result buffer
+			result[0] = PCD_ReadRegister(CRCResultRegL);
+			result[1] = PCD_ReadRegister(CRCResultRegH);
+			return STATUS_OK;
+		}
+		if ((uint32_t)(micros() - start) > _timeoutMicros[OPERATION_CALCULATE_CRC]) {
+			// Nothing happend. Communication with the MFRC522 might be down.
+			return STATUS_TIMEOUT;
+		}
+	}
+} // End PCD_CalculateCRC()
+
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Functions for manipulating the MFRC522
+/////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Initializes the MFRC522 chip.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PCD_Init() {
+	bool hardReset = false;
+
+	// Set up the bus, for SPI the chip select pin as digital output without selecting the slave yet
+	_transport.begin();
+	
+	// If a valid pin number has been set, pull device out of power down / reset state.
+	if (_resetPowerDownPin != UNUSED_PIN) {
+		// First set the resetPowerDownPin as digital input, to check the MFRC522 power down mode.
+		pinMode(_resetPowerDownPin, INPUT);
+	
+		if (digitalRead(_resetPowerDownPin) == LOW) {	// The MFRC522 chip is in power down mode.
+			pinMode(_resetPowerDownPin, OUTPUT);		// Now set the resetPowerDownPin as digital output.
+			digitalWrite(_resetPowerDownPin, LOW);		// Make sure we have a clean LOW state.
+			delayMicroseconds(2);				// 8.8.1 Reset timing requirements says about 100ns. Let us be generous: 2μsl
+			digitalWrite(_resetPowerDownPin, HIGH);		// Exit power down mode. This triggers a hard reset.
+			// Section 8.8.2 in the datasheet says the oscillator start-up time is the start up time of the crystal + 37,74μs. Let us be generous: 50ms.
+			delay(50);
+			hardReset = true;
+			_registerCacheValid = 0;	// All registers are back at their reset values
+		}
+	}
+
+	if (!hardReset) { // Perform a soft reset if we haven't triggered a hard reset above.
+		PCD_Reset();
+	}
+	
+	PCD_WriteRegisters_P(initScript, sizeof(initScript) / sizeof(initScript[0]));
+	_requestTimer = false;					// initScript loads the 25ms
+	PCD_AntennaOn();						// Enable the antenna driver pins TX1 and TX2 (they were disabled by the reset)
+} // End PCD_Init()
+
+/**
+ * Initializes the MFRC522 chip. For the SPI transports only.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PCD_Init(	byte resetPowerDownPin	///< Arduino pin connected to MFRC522's reset and power down input (Pin 6, NRSTPD, active low)
+									) {
+	PCD_Init(SS, resetPowerDownPin); // SS is defined in pins_arduino.h
+} // End PCD_Init()
+
+/**
+ * Initializes the MFRC522 chip. For the SPI transports only.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PCD_Init(	byte chipSelectPin,		///< Arduino pin connected to MFRC522's SPI slave select input (Pin 24, NSS, active low)
+										byte resetPowerDownPin	///< Arduino pin connected to MFRC522's reset and power down input (Pin 6, NRSTPD, active low)
+									) {
+	_transport.setChipSelectPin(chipSelectPin);
+	_resetPowerDownPin = resetPowerDownPin; 
+	// Set the chipSelectPin as digital output, do not select the slave yet
+	PCD_Init();
+} // End PCD_Init()
+
+/**
+ * Performs a soft reset on the MFRC522 chip and waits for it to be ready again.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PCD_Reset() {
+	PCD_WriteRegister(CommandReg, PCD_SoftReset);	// Issue the SoftReset command.
+	// The datasheet does not mention how long the SoftRest command takes to complete.
+	// But the MFRC522 might have been in soft power-down mode (triggered by bit 4 of CommandReg) 
+	// Section 8.8.2 in the datasheet says the oscillator start-up time is the start up time of the crystal + 37,74μs. Let us be generous: 50ms.
+	uint8_t count = 0;
+	do {
+		// Wait for the PowerDown bit in CommandReg to be cleared (max 3x50ms)
+		delay(50);
+	} while ((PCD_ReadRegister(CommandReg) & (1 << 4)) && (++count) < 3);
+} // End PCD_Reset()
+
+/**
+ * Turns the antenna on by enabling pins TX1 and TX2.
+ * After a reset these pins are disabled.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PCD_AntennaOn() {
+	byte value = PCD_ReadRegister(TxControlReg);
+	if ((value & 0x03) != 0x03) {
+		PCD_WriteRegister(TxControlReg, value | 0x03);
+	}
+} // End PCD_AntennaOn()
+
+/**
+ * Turns the antenna off by disabling pins TX1 and TX2.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PCD_AntennaOff() {
+	PCD_ClearRegisterBitMask(TxControlReg, 0x03);
+} // End PCD_AntennaOff()
+
+/**
+ * Get the current MFRC522 Receiver Gain (RxGain[2:0]) value.
+ * See 9.3.3.6 / table 98 in http://www.nxp.com/documents/data_sheet/MFRC522.pdf
+ * NOTE: Return value scrubbed with (0x07<<4)=01110000b as RCFfgReg may use reserved bits.
+ * 
+ * @return Value of the RxGain, scrubbed to the 3 bits used.
+ */
+template <class Transport>
+byte MFRC522Base<Transport>::PCD_GetAntennaGain() {
+	return PCD_ReadRegister(RFCfgReg) & (0x07<<4);
+} // End PCD_GetAntennaGain()
+
+/**
+ * Set the MFRC522 Receiver Gain (RxGain) to value specified by given mask.
+ * See 9.3.3.6 / table 98 in http://www.nxp.com/documents/data_sheet/MFRC522.pdf
+ * NOTE: Given mask is scrubbed with (0x07<<4)=01110000b as RCFfgReg may use reserved bits.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PCD_SetAntennaGain(byte mask) {
+	if (PCD_GetAntennaGain() != mask) {						// only bother if there is a change
+		PCD_ClearRegisterBitMask(RFCfgReg, (0x07<<4));		// clear needed to allow 000 pattern
+		PCD_SetRegisterBitMask(RFCfgReg, mask & (0x07<<4));	// only set RxGain[2:0] bits
+	}
+} // End PCD_SetAntennaGain()
+
+/**
+ * Performs a self-test of the MFRC522
+ * See 16.1.1 in http://www.nxp.com/documents/data_sheet/MFRC522.pdf
+ * 
+ * @return Whether or not the test passed. Or false if no firmware reference is available.
+ */
+template <class Transport>
+bool MFRC522Base<Transport>::PCD_PerformSelfTest() {
+	// This follows directly the steps outlined in 16.1.1
+	// 1. Perform a soft reset.
+	PCD_Reset();
+	
+	// 2. Clear the internal buffer by writing 25 bytes of 00h
+	byte ZEROES[25] = {0x00};
+	PCD_WriteRegister(FIFOLevelReg, 0x80);		// flush the FIFO buffer
+	PCD_WriteRegister(FIFODataReg, 25, ZEROES);	// write 25 bytes of 00h to FIFO
+	PCD_WriteRegister(CommandReg, PCD_Mem);		// transfer to internal buffer
+	
+	// 3. Enable self-test
+	PCD_WriteRegister(AutoTestReg, 0x09);
+	
+	// 4. Write 00h to FIFO buffer
+	PCD_WriteRegister(FIFODataReg, 0x00);
+	
+	// 5. Start self-test by issuing the CalcCRC command
+	PCD_WriteRegister(CommandReg, PCD_CalcCRC);
+	
+	// 6. Wait for self-test to complete
+	byte n;
+	for (uint8_t i = 0; i < 0xFF; i++) {
+		// The datasheet does not specify exact completion condition except
+		// that FIFO buffer should contain 64 bytes.
+		// While selftest is initiated by CalcCRC command
+		// it behaves differently from normal CRC computation,
+		// so one can't reliably use DivIrqReg to check for completion.
+		// It is reported that some devices does not trigger CRCIRq flag
+		// during selftest.
+		n = PCD_ReadRegister(FIFOLevelReg);
+		if (n >= 64) {
+			break;
+		}
+	}
+	PCD_WriteRegister(CommandReg, PCD_Idle);		// Stop calculating CRC for new content in the FIFO.
+	
+	// 7. Read out resulting 64 bytes from the FIFO buffer.
+	byte result[64];
+	PCD_ReadRegister(FIFODataReg, 64, result, 0);
+	
+	// Auto self-test done
+	// Reset AutoTestReg register to be 0 again. Required for normal operation.
+	PCD_WriteRegister(AutoTestReg, 0x00);
+	
+	// Determine firmware version (see section 9.3.4.8 in spec)
+	byte version = PCD_ReadRegister(VersionReg);
+	
+	// Pick the appropriate reference values
+	const byte *reference;
+	switch (version) {
+		case 0x88:	// Fudan Semiconductor FM17522 clone
+			reference = FM17522_firmware_reference;
+			break;
+		case 0x90:	// Version 0.0
+			reference = MFRC522_firmware_referenceV0_0;
+			break;
+		case 0x91:	// Version 1.0
+			reference = MFRC522_firmware_referenceV1_0;
+			break;
+		case 0x92:	// Version 2.0
+			reference = MFRC522_firmware_referenceV2_0;
+			break;
+		default:	// Unknown version
+			return false; // abort test
+	}
+	
+	// Verify that the results match up to our expectations
+	for (uint8_t i = 0; i < 64; i++) {
+		if (result[i] != pgm_read_byte(&(reference[i]))) {
+			return false;
+		}
+	}
+	
+	// Test passed; all is good.
+	return true;
+} // End PCD_PerformSelfTest()
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Power control
+/////////////////////////////////////////////////////////////////////////////////////
+
+//IMPORTANT NOTE!!!!
+//Calling any other function that uses CommandReg will disable soft power down mode !!!
+//For more details about power control, refer to the datasheet - page 33 (8.6)
+
+template <class Transport>
+void MFRC522Base<Transport>::PCD_SoftPowerDown(){//Note : Only soft power down mode is available throught software
+	byte val = PCD_ReadRegister(CommandReg); // Read state of the command register 
+	val |= (1<<4);// set PowerDown bit ( bit 4 ) to 1 
+	PCD_WriteRegister(CommandReg, val);//write new value to the command register
+}
+
+template <class Transport>
+void MFRC522Base<Transport>::PCD_SoftPowerUp(){
+	byte val = PCD_ReadRegister(CommandReg); // Read state of the command register 
+	val &= ~(1<<4);// set PowerDown bit ( bit 4 ) to 0 
+	PCD_WriteRegister(CommandReg, val);//write new value to the command register
+	// wait until PowerDown bit is cleared (this indicates end of wake up procedure) 
+	const uint32_t timeout = (uint32_t)millis() + 500;// create timer for timeout (just in case) 
+	
+	while(millis()<=timeout){ // set timeout to 500 ms 
+		val = PCD_ReadRegister(CommandReg);// Read state of the command register
+		if(!(val & (1<<4))){ // if powerdown bit is 0 
+			break;// wake up procedure is finished 
+		}
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Functions for communicating with PICCs
+/////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Executes the Transceive command.
+ * CRC validation can only be done if backData and backLen are specified.
+ * 
+ * @return STATUS_OK on success, STATUS_??? otherwise.
+ */
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::PCD_TransceiveData(	byte *sendData,		///< Pointer to the data to transfer to the FIFO.
+																	byte sendLen,		///< Number of bytes to transfer to the FIFO.
+																	byte *backData,		///< nullptr or pointer to buffer if data should be read back after executing the command.
+																	byte *backLen,		///< In: Max number of bytes to write to *backData. Out: The number of bytes returned.
+																	byte *validBits,	///< In/Out: The number of valid bits in the last byte. 0 for 8 valid bits. Default nullptr.
+																	byte rxAlign,		///< In: Defines the bit position in backData[0] for the first bit received. Default 0.
+																	bool checkCRC		///< In: True => The last two bytes of the response is assumed to be a CRC_A that must be validated.
+												 ) {
+	byte waitIRq = 0x30;		// RxIRq and IdleIRq
+	return PCD_CommunicateWithPICC(PCD_Transceive, waitIRq, sendData, sendLen, backData, backLen, validBits, rxAlign, checkCRC);
+} // End PCD_TransceiveData()
+
+/**
+ * Transfers data to the MFRC522 FIFO, executes a command, waits for completion and transfers data back from the FIFO.
+ * CRC validation can only be done if backData and backLen are specified.
+ *
+ * @return STATUS_OK on success, STATUS_??? otherwise.
+ */
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::PCD_CommunicateWithPICC(	byte command,		///< The command to execute. One of the PCD_Command enums.
+																		byte waitIRq,		///< The bits in the ComIrqReg register that signals successful completion of the command.
+																		byte *sendData,		///< Pointer to the data to transfer to the FIFO.
+																		byte sendLen,		///< Number of bytes to transfer to the FIFO.
+																		byte *backData,		///< nullptr or pointer to buffer if data should be read back after executing the command.
+																		byte *backLen,		///< In: Max number of bytes to write to *backData. Out: The number of bytes returned.
+																		byte *validBits,	///< In/Out: The number of valid bits in the last byte. 0 for 8 valid bits.
+																		byte rxAlign,		///< In: Defines the bit position in backData[0] for the first bit received. Default 0.
+																		bool checkCRC		///< In: True => The last two bytes of the response is assumed to be a CRC_A that must be validated.
+													 ) {
+	// Prepare values for BitFramingReg
+	byte txLastBits = validBits ? *validBits : 0;
+	byte bitFraming = (rxAlign << 4) + txLastBits;		// RxAlign = BitFramingReg[6..4]. TxLastBits = BitFramingReg[2..0]
+	_pending.active = false;							// Replaces a command started by PCD_StartTransceive()
+	PCD_StartCommand(command, sendData, sendLen, bitFraming);
+	
+	// Wait for the command to complete, at most the timeout of the operation, see PCD_SetTimeout().
+	// In PCD_Init() we set the TAuto flag in TModeReg. This means the timer automatically starts when the PCD stops transmitting.
+	// Once TxIRq shows that the frame is out, nothing happens until the PICC answers or the timer runs out, so from
+	// then on ComIrqReg is read less and less often, at most 64μs apart, leaving the bus alone.
+	const uint32_t timeout = _timeoutMicros[command == PCD_MFAuthent ? OPERATION_AUTHENTICATE : OPERATION_TRANSCEIVE];
+	const uint32_t start = micros();
+	byte pause = 0;
+	for (;;) {
+		byte n = PCD_ReadRegister(ComIrqReg);	// ComIrqReg[7..0] bits are: Set1 TxIRq RxIRq IdleIRq HiAlertIRq LoAlertIRq ErrIRq TimerIRq
+		if (n & waitIRq) {					// One of the interrupts that signal success has been set.
+			break;
+		}
+		if (n & 0x01) {						// Timer interrupt - nothing received in 25ms
+			return STATUS_TIMEOUT;
+		}
+		if ((uint32_t)(micros() - start) > timeout) {
+			// Nothing happend. Communication with the MFRC522 might be down.
+			return STATUS_TIMEOUT;
+		}
+		if (n & 0x40) {						// TxIRq - the timer is running
+			pause = PCD_NextPollPause(pause);
+			delayMicroseconds(pause);
+		}
+	}
+	
+	return PCD_FinishCommand(backData, backLen, validBits, rxAlign, checkCRC);
+} // End PCD_CommunicateWithPICC()
+
+/**
+ * The pause before the next read of ComIrqReg while waiting for a PICC: 16μs after TxIRq, doubling up to 64μs.
+ */
+template <class Transport>
+byte MFRC522Base<Transport>::PCD_NextPollPause(	byte pause	///< The pause before, 0 for the first
+												) {
+	return pause ? (pause < 64 ? pause * 2 : 64) : 16;
+} // End PCD_NextPollPause()
+
+/**
+ * Stops any active command, loads sendData into the FIFO and executes command, all in one bus transaction.
+ * For PCD_Transceive the transmission is started as well.
+ * With PCD_SetHardwareCRC() a frame goes out without TxCRCEn and RxCRCEn unless PCD_SetFrameCRC() set them for it,
+ * so that a caller of PCD_TransceiveData() that adds its own CRC_A does not send two.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PCD_StartCommand(	byte command,		///< The command to execute. One of the PCD_Command enums.
+												byte *sendData,		///< Pointer to the data to transfer to the FIFO.
+												byte sendLen,		///< Number of bytes to transfer to the FIFO.
+												byte bitFraming		///< Value for BitFramingReg: RxAlign and TxLastBits.
+											) {
+	if (command == PCD_Transceive || command == PCD_Transmit) {
+		if (_hardwareCrc && !_frameCrcSet) {
+			PCD_SetFrameCRC(false, false);
+		}
+		_frameCrcSet = false;
+	}
+	_transport.beginTransaction();	// One transaction for the setup
+	PCD_TransferRegister(CommandReg, PCD_Idle);				// Stop any active command.
+	PCD_TransferRegister(ComIrqReg, 0x7F);					// Clear all seven interrupt request bits
+	PCD_TransferRegister(FIFOLevelReg, 0x80);				// FlushBuffer = 1, FIFO initialization
+	PCD_TransferRegister(FIFODataReg, sendLen, sendData);	// Write sendData to the FIFO
+	PCD_TransferRegister(BitFramingReg, bitFraming);		// Bit adjustments
+	PCD_TransferRegister(CommandReg, command);				// Execute the command
+	if (command == PCD_Transceive) {
+		PCD_TransferRegister(BitFramingReg, bitFraming | 0x80);	// StartSend=1, transmission of data starts
+	}
+	_transport.endTransaction();
+} // End PCD_StartCommand()
+
+/**
+ * Checks ErrorReg and collects the response after a command has signalled completion in ComIrqReg.
+ * CRC validation can only be done if backData and backLen are specified.
+ *
+ * @return STATUS_OK on success, STATUS_??? otherwise.
+ */
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::PCD_FinishCommand(	byte *backData,		///< nullptr or pointer to buffer if data should be read back after executing the command.
+																byte *backLen,		///< In: Max number of bytes to write to *backData. Out: The number of bytes returned.
+																byte *validBits,	///< Out: The number of valid bits in the last byte. 0 for 8 valid bits.
+																byte rxAlign,		///< In: Defines the bit position in backData[0] for the first bit received.
+																bool checkCRC		///< In: True => The last two bytes of the response is assumed to be a CRC_A that must be validated.
+															) {
+	// Stop now if any errors except collisions were detected.
+	byte errorRegValue = PCD_ReadRegister(ErrorReg); // ErrorReg[7..0] bits are: WrErr TempErr reserved BufferOvfl CollErr CRCErr ParityErr ProtocolErr
+	if (errorRegValue & 0x13) {	 // BufferOvfl ParityErr ProtocolErr
+		return STATUS_ERROR;
+	}
+  
+	byte _validBits = 0;
+	
+	// If the caller wants data back, get it from the MFRC522.
+	if (backData && backLen) {
+		byte n = PCD_ReadRegister(FIFOLevelReg);	// Number of bytes in the FIFO
+		if (n > *backLen) {
+			return STATUS_NO_ROOM;
+		}
+		*backLen = n;											// Number of bytes returned
+		PCD_ReadRegister(FIFODataReg, n, backData, rxAlign);	// Get received data from FIFO
+		_validBits = PCD_ReadRegister(ControlReg) & 0x07;		// RxLastBits[2:0] indicates the number of valid bits in the last received byte. If this value is 000b, the whole byte is valid.
+		if (validBits) {
+			*validBits = _validBits;
+		}
+	}
+	
+	// Tell about collisions
+	if (errorRegValue & 0x08) {		// CollErr
+		return STATUS_COLLISION;
+	}
+	
+	// CRCErr is only set with RxCRCEn, see PCD_SetHardwareCRC(). A 4 bit answer has no CRC_A: a MIFARE NAK.
+	if (errorRegValue & 0x04) {
+		if (backData && backLen && *backLen == 1 && _validBits == 4) {
+			return STATUS_MIFARE_NACK;
+		}
+		return STATUS_CRC_WRONG;
+	}
+	
+	// Perform CRC_A validation if requested.
+	if (backData && backLen && checkCRC) {
+		// In this case a MIFARE Classic NAK is not OK.
+		if (*backLen == 1 && _validBits == 4) {
+			return STATUS_MIFARE_NACK;
+		}
+		// We need at least the CRC_A value and all 8 bits of the last byte must be received.
+		if (*backLen < 2 || _validBits != 0) {
+			return STATUS_CRC_WRONG;
+		}
+		// Verify CRC_A - do our own calculation and store the control in controlBuffer.
+		byte controlBuffer[2];
+		StatusCode status = PCD_CalculateCRC(&backData[0], *backLen - 2, &controlBuffer[0]);
+		if (status != STATUS_OK) {
+			return status;
+		}
+		if ((backData[*backLen - 2] != controlBuffer[0]) || (backData[*backLen - 1] != controlBuffer[1])) {
+			return STATUS_CRC_WRONG;
+		}
+	}
+	
+	return STATUS_OK;
+} // End PCD_FinishCommand()
+
+/**
+ * Executes the Transceive command for frames that do not fit the 64 byte FIFO, up to 65535 bytes each way, like the
+ * ISO/IEC 14443-4 blocks of MFRC522_TCL_FSD bytes. With WaterLevelReg at 32 the MFRC522 sets LoAlertIRq when 32 bytes
+ * or fewer are left to send, then the FIFO is topped up, and HiAlertIRq when the answer has filled it to 32 bytes or
+ * more, then it is emptied into backData. WaterLevelReg is set back to its reset value 8 on return. Frames that fit the
+ * FIFO both ways go to PCD_TransceiveData().
+ * Whole bytes only. The CRC_A is added and checked as PCD_SetFrameCRC() or TxModeReg and RxModeReg say.
+ *
+ * @return STATUS_OK on success, STATUS_??? otherwise. STATUS_ERROR if the frame to send ran out, the bus was too slow.
+ */
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::PCD_TransceiveStream(	byte *sendData,		///< Pointer to the data to send.
+																	uint16_t sendLen,	///< Number of bytes to send.
+																	byte *backData,		///< nullptr or pointer to buffer if data should be read back.
+																	uint16_t *backLen	///< In: Max number of bytes to write to *backData. Out: The number of bytes returned.
+																) {
+	if (sendData == nullptr || sendLen == 0) {
+		return STATUS_INVALID;
+	}
+	uint16_t room = backData && backLen ? *backLen : 0;
+	if (sendLen <= FIFO_SIZE && room <= FIFO_SIZE) {
+		byte length = (byte)room;
+		StatusCode result = PCD_TransceiveData(sendData, (byte)sendLen, backData, backLen ? &length : nullptr);
+		if (backLen) {
+			*backLen = length;
+		}
+		return result;
+	}
+	
+	PCD_WriteRegister(WaterLevelReg, FIFO_SIZE / 2);
+	StatusCode result = PCD_StreamFrame(sendData, sendLen, backData, backLen);
+	PCD_WriteRegister(WaterLevelReg, 0x08);			// The reset value
+	return result;
+} // End PCD_TransceiveStream()
+
+/**
+ * The Transceive command of PCD_TransceiveStream(), with WaterLevelReg at 32.
+ *
+ * @return STATUS_OK on success, STATUS_??? otherwise.
+ */
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::PCD_StreamFrame(	byte *sendData,		///< Pointer to the data to send.
+																uint16_t sendLen,	///< Number of bytes to send.
+																byte *backData,		///< nullptr or pointer to buffer if data should be read back.
+																uint16_t *backLen	///< In: Max number of bytes to write to *backData. Out: The number of bytes returned.
+															) {
+	uint16_t room = backData && backLen ? *backLen : 0;
+	uint16_t sent = sendLen < FIFO_SIZE ? sendLen : FIFO_SIZE;
+	uint16_t received = 0;
+	_pending.active = false;							// Replaces a command started by PCD_StartTransceive()
+	PCD_StartCommand(PCD_Transceive, sendData, (byte)sent, 0);
+	
+	// As in PCD_CommunicateWithPICC(), but the timeout counts from the last bytes moved
+	const uint32_t timeout = _timeoutMicros[OPERATION_TRANSCEIVE];
+	uint32_t start = micros();
+	byte pause = 0;
+	for (;;) {
+		byte n = PCD_ReadRegister(ComIrqReg);	// ComIrqReg[7..0] bits are: Set1 TxIRq RxIRq IdleIRq HiAlertIRq LoAlertIRq ErrIRq TimerIRq
+		if (n & 0x30) {						// RxIRq or IdleIRq
+			break;
+		}
+		if (n & 0x01) {						// Timer interrupt - nothing received in 25ms
+			return STATUS_TIMEOUT;
+		}
+		if (sent < sendLen) {
+			if (n & 0x40) {					// TxIRq - the frame ended before all of it was in the FIFO
+				PCD_WriteRegister(CommandReg, PCD_Idle);
+				return STATUS_ERROR;
+			}
+			if (n & 0x04) {					// LoAlertIRq - top up the FIFO
+				PCD_WriteRegister(ComIrqReg, 0x04);
+				byte count = FIFO_SIZE - PCD_ReadRegister(FIFOLevelReg);
+				if (count > sendLen - sent) {
+					count = sendLen - sent;
+				}
+				if (count) {
+					PCD_WriteRegister(FIFODataReg, count, sendData + sent);
+					sent += count;
+					start = micros();
+				}
+				continue;
+			}
+		}
+		else if ((n & 0x48) == 0x48) {		// TxIRq and HiAlertIRq - empty the FIFO before the answer overflows it
+			PCD_WriteRegister(ComIrqReg, 0x08);
+			byte count = PCD_ReadRegister(FIFOLevelReg);
+			if (count > room - received) {
+				return STATUS_NO_ROOM;
+			}
+			if (count) {
+				PCD_ReadRegister(FIFODataReg, count, backData + received, 0);
+				received += count;
+				start = micros();
+			}
+			continue;
+		}
+		if ((uint32_t)(micros() - start) > timeout) {
+			return STATUS_TIMEOUT;
+		}
+		if (n & 0x40) {						// TxIRq - the timer is running or the answer arrives
+			pause = PCD_NextPollPause(pause);
+			delayMicroseconds(pause);
+		}
+	}
+	
+	byte errorRegValue = PCD_ReadRegister(ErrorReg); // ErrorReg[7..0] bits are: WrErr TempErr reserved BufferOvfl CollErr CRCErr ParityErr ProtocolErr
+	if (errorRegValue & 0x13) {	 // BufferOvfl ParityErr ProtocolErr
+		return STATUS_ERROR;
+	}
+	if (backData && backLen) {
+		byte count = PCD_ReadRegister(FIFOLevelReg);	// The rest of the answer
+		if (count > room - received) {
+			return STATUS_NO_ROOM;
+		}
+		PCD_ReadRegister(FIFODataReg, count, backData + received, 0);
+		*backLen = received + count;
+	}
+	if (errorRegValue & 0x08) {		// CollErr
+		return STATUS_COLLISION;
+	}
+	if (errorRegValue & 0x04) {		// CRCErr
+		return STATUS_CRC_WRONG;
+	}
+	return STATUS_OK;
+} // End PCD_StreamFrame()
+
+/**
+ * Transmits a REQuest command, Type A. Invites PICCs in state IDLE to go to READY and prepare for anticollision or selection. 7 bit frame.
+ * Beware: When two PICCs are in the field at the same time I often get STATUS_TIMEOUT - probably due do bad antenna design.
+ * 
+ * @return STATUS_OK on success, STATUS_??? otherwise.
+ */
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::PICC_RequestA(	byte *bufferATQA,	///< The buffer to store the ATQA (Answer to request) in
+															byte *bufferSize	///< Buffer size, at least two bytes. Also number of bytes returned if STATUS_OK.
+														) {
+	return PICC_REQA_or_WUPA(PICC_CMD_REQA, bufferATQA, bufferSize);
+} // End PICC_RequestA()
+
+/**
+ * Transmits a Wake-UP command, Type A. Invites PICCs in state IDLE and HALT to go to READY(*) and prepare for anticollision or selection. 7 bit frame.
+ * Beware: When two PICCs are in the field at the same time I often get STATUS_TIMEOUT - probably due do bad antenna design.
+ * 
+ * @return STATUS_OK on success, STATUS_??? otherwise.
+ */
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::PICC_WakeupA(	byte *bufferATQA,	///< The buffer to store the ATQA (Answer to request) in
+															byte *bufferSize	///< Buffer size, at least two bytes. Also number of bytes returned if STATUS_OK.
+														) {
+	return PICC_REQA_or_WUPA(PICC_CMD_WUPA, bufferATQA, bufferSize);
+} // End PICC_WakeupA()
+
+/**
+ * Transmits REQA or WUPA commands.
+ * Beware: When two PICCs are in the field at the same time I often get STATUS_TIMEOUT - probably due do bad antenna design.
+ * 
+ * @return STATUS_OK on success, STATUS_??? otherwise.
+ */ 
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::PICC_REQA_or_WUPA(	byte command, 		///< The command to send - PICC_CMD_REQA or PICC_CMD_WUPA
+																byte *bufferATQA,	///< The buffer to store the ATQA (Answer to request) in
+																byte *bufferSize	///< Buffer size, at least two bytes. Also number of bytes returned if STATUS_OK.
+															) {
+	byte validBits;
+	StatusCode status;
+	
+	if (bufferATQA == nullptr || *bufferSize < 2) {	// The ATQA response is 2 bytes long.
+		return STATUS_NO_ROOM;
+	}
+	PCD_ClearRegisterBitMask(CollReg, 0x80);		// ValuesAfterColl=1 => Bits received after collision are cleared.
+	PCD_SetFrameCRC(false, false);					// Neither the short frame nor the ATQA has a CRC_A
+	PCD_SetRequestTimer(true);						// See PCD_SetRequestWindow()
+	validBits = 7;									// For REQA and WUPA we need the short frame format - transmit only 7 bits of the last (and only) byte. TxLastBits = BitFramingReg[2..0]
+	status = PCD_TransceiveData(&command, 1, bufferATQA, bufferSize, &validBits);
+	if (status != STATUS_TIMEOUT) {
+		PCD_SetRequestTimer(false);					// A PICC answered, SELECT follows
+	}
+	if (status != STATUS_OK) {
+		return status;
+	}
+	if (*bufferSize != 2 || validBits != 0) {		// ATQA must be exactly 16 bits.
+		return STATUS_ERROR;
+	}
+	return STATUS_OK;
+} // End PICC_REQA_or_WUPA()
+
+/**
+ * Transmits SELECT/ANTICOLLISION commands to select a single PICC.
+ * Before calling this function the PICCs must be placed in the READY(*) state by calling PICC_RequestA() or PICC_WakeupA().
+ * On success:
+ * 		- The chosen PICC is in state ACTIVE(*) and all other PICCs have returned to state IDLE/HALT. (Figure 7 of the ISO/IEC 14443-3 draft.)
+ * 		- The UID size and value of the chosen PICC is returned in *uid along with the SAK.
+ * 
+ * A PICC UID consists of 4, 7 or 10 bytes.
+ * Only 4 bytes can be specified in a SELECT command, so for the longer UIDs two or three iterations are used:
+ * 		UID size	Number of UID bytes		Cascade levels		Example of PICC
+ * 		========	===================		==============		===============
+ * 		single				 4						1				MIFARE Classic
+ * 		double				 7						2				MIFARE Ultralight
+ * 		triple				10						3				Not currently in use?
+ * 
+ * @return STATUS_OK on success, STATUS_??? otherwise.
+ */
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::PICC_Select(	Uid *uid,			///< Pointer to Uid struct. Normally output, but can also be used to supply a known UID.
+															byte validBits		///< The number of known UID bits supplied in *uid. Normally 0. If set you must also supply uid->size.
+														 ) {
+	bool uidComplete;
+	bool selectDone;
+	bool useCascadeTag;
+	byte cascadeLevel = 1;
+	StatusCode result;
+	byte count;
+	byte checkBit;
+	byte index;
+	byte uidIndex;					// The first index in uid->uidByte[] that is used in the current Cascade Level.
+	int8_t currentLevelKnownBits;		// The number of known UID bits in the current Cascade Level.
+	byte buffer[9];					// The SELECT/ANTICOLLISION commands uses a 7 byte standard frame + 2 bytes CRC_A
+	byte bufferUsed;				// The number of bytes used in the buffer, ie the number of bytes to transfer to the FIFO.
+	byte rxAlign;					// Used in BitFramingReg. Defines the bit position for the first bit received.
+	byte txLastBits;				// Used in BitFramingReg. The number of valid bits in the last transmitted byte. 
+	byte *responseBuffer;
+	byte responseLength;
+	
+	// Description of buffer structure:
+	//		Byte 0: SEL 				Indicates the Cascade Level: PICC_CMD_SEL_CL1, PICC_CMD_SEL_CL2 or PICC_CMD_SEL_CL3
+	//		Byte 1: NVB					Number of Valid Bits (in complete command, not just the UID): High nibble: complete bytes, Low nibble: Extra bits. 
+	//		Byte 2: UID-data or CT		See explanation below. CT means Cascade Tag.
+	//		Byte 3: UID-data
+	//		Byte 4: UID-data
+	//		Byte 5: UID-data
+	//		Byte 6: BCC					Block Check Character - XOR of bytes 2-5
+	//		Byte 7: CRC_A
+	//		Byte 8: CRC_A
+	// The BCC and CRC_A are only transmitted if we know all the UID bits of the current Cascade Level.
+	//
+	// Description of bytes 2-5: (Section 6.5.4 of the ISO/IEC 14443-3 draft: UID contents and cascade levels)
+	//		UID size	Cascade level	Byte2	Byte3	Byte4	Byte5
+	//		========	=============	=====	=====	=====	=====
+	//		 4 bytes		1			uid0	uid1	uid2	uid3
+	//		 7 bytes		1			CT		uid0	uid1	uid2
+	//						2			uid3	uid4	uid5	uid6
+	//		10 bytes		1			CT		uid0	uid1	uid2
+	//						2			CT		uid3	uid4	uid5
+	//						3			uid6	uid7	uid8	uid9
+	
+	// Sanity checks
+	if (validBits > 80) {
+		return STATUS_INVALID;
+	}
+	
+	// Prepare MFRC522
+	PCD_ClearRegisterBitMask(CollReg, 0x80);		// ValuesAfterColl=1 => Bits received after collision are cleared.
+	
+	// Repeat Cascade Level loop until we have a complete UID.
+	uidComplete = false;
+	while (!uidComplete) {
+		// Set the Cascade Level in the SEL byte, find out if we need to use the Cascade Tag in byte 2.
+		switch (cascadeLevel) {
+			case 1:
+				buffer[0] = PICC_CMD_SEL_CL1;
+				uidIndex = 0;
+				useCascadeTag = validBits && uid->size > 4;	// When we know that the UID has more than 4 bytes
+				break;
+			
+			case 2:
+				buffer[0] = PICC_CMD_SEL_CL2;
+				uidIndex = 3;
+				useCascadeTag = validBits && uid->size > 7;	// When we know that the UID has more than 7 bytes
+				break;
+			
+			case 3:
+				buffer[0] = PICC_CMD_SEL_CL3;
+				uidIndex = 6;
+				useCascadeTag = false;						// Never used in CL3.
+				break;
+			
+			default:
+				return STATUS_INTERNAL_ERROR;
+				break;
+		}
+		
+		// How many UID bits are known in this Cascade Level?
+		currentLevelKnownBits = validBits - (8 * uidIndex);
+		if (currentLevelKnownBits < 0) {
+			currentLevelKnownBits = 0;
+		}
+		// Copy the known bits from uid->uidByte[] to buffer[]
+		index = 2; // destination index in buffer[]
+		if (useCascadeTag) {
+			buffer[index++] = PICC_CMD_CT;
+		}
+		byte bytesToCopy = currentLevelKnownBits / 8 + (currentLevelKnownBits % 8 ? 1 : 0); // The number of bytes needed to represent the known bits for this level.
+		if (bytesToCopy) {
+			byte maxBytes = useCascadeTag ? 3 : 4; // Max 4 bytes in each Cascade Level. Only 3 left if we use the Cascade Tag
+			if (bytesToCopy > maxBytes) {
+				bytesToCopy = maxBytes;
+			}
+			for (count = 0; count < bytesToCopy; count++) {
+				buffer[index++] = uid->uidByte[uidIndex + count];
+			}
+		}
+		// Now that the data has been copied we need to include the 8 bits in CT in currentLevelKnownBits
+		if (useCascadeTag) {
+			currentLevelKnownBits += 8;
+		}
+		
+		// Repeat anti collision loop until we can transmit all UID bits + BCC and receive a SAK - max 32 iterations.
+		selectDone = false;
+		while (!selectDone) {
+			// Find out how many bits and bytes to send and receive.
+			if (currentLevelKnownBits >= 32) { // All UID bits in this Cascade Level are known. This is a SELECT.
+				//Serial.print(F("SELECT: currentLevelKnownBits=")); Serial.println(currentLevelKnownBits, DEC);
+				buffer[1] = 0x70; // NVB - Number of Valid Bits: Seven whole bytes
+				// Calculate BCC - Block Check Character
+				buffer[6] = buffer[2] ^ buffer[3] ^ buffer[4] ^ buffer[5];
+				txLastBits		= 0; // 0 => All 8 bits are valid.
+				if (_hardwareCrc) {
+					// The MFRC522 appends the CRC_A and checks the one of the SAK
+					PCD_SetFrameCRC(true, true);
+					bufferUsed	= 7;
+				}
+				else {
+					// Calculate CRC_A
+					result = PCD_CalculateCRC(buffer, 7, &buffer[7]);
+					if (result != STATUS_OK) {
+						return result;
+					}
+					bufferUsed	= 9;
+				}
+				// Store response in the last 3 bytes of buffer (BCC and CRC_A - not needed after tx)
+				responseBuffer	= &buffer[6];
+				responseLength	= 3;
+			}
+			else { // This is an ANTICOLLISION.
+				//Serial.print(F("ANTICOLLISION: currentLevelKnownBits=")); Serial.println(currentLevelKnownBits, DEC);
+				PCD_SetFrameCRC(false, false);
+				txLastBits		= currentLevelKnownBits % 8;
+				count			= currentLevelKnownBits / 8;	// Number of whole bytes in the UID part.
+				index			= 2 + count;					// Number of whole bytes: SEL + NVB + UIDs
+				buffer[1]		= (index << 4) + txLastBits;	// NVB - Number of Valid Bits
+				bufferUsed		= index + (txLastBits ? 1 : 0);
+				// Store response in the unused part of buffer
+				responseBuffer	= &buffer[index];
+				responseLength	= sizeof(buffer) - index;
+			}
+			
+			// Set bit adjustments
+			rxAlign = txLastBits;											// Having a separate variable is overkill. But it makes the next line easier to read.
+			PCD_WriteRegister(BitFramingReg, (rxAlign << 4) + txLastBits);	// RxAlign = BitFramingReg[6..4]. TxLastBits = BitFramingReg[2..0]
+			
+			// Transmit the buffer and receive the response.
+			result = PCD_TransceiveData(buffer, bufferUsed, responseBuffer, &responseLength, &txLastBits, rxAlign);
+			if (result == STATUS_COLLISION) { // More than one PICC in the field => collision.
+				byte valueOfCollReg = PCD_ReadRegister(CollReg); // CollReg[7..0] bits are: ValuesAfterColl reserved CollPosNotValid CollPos[4:0]
+				if (valueOfCollReg & 0x20) { // CollPosNotValid
+					return STATUS_COLLISION; // Without a valid collision position we cannot continue
+				}
+				byte collisionPos = valueOfCollReg & 0x1F; // Values 0-31, 0 means bit 32.
+				if (collisionPos == 0) {
+					collisionPos = 32;
+				}
+				// CollPos counts from the first bit of the first byte received, which is the byte holding the
+				// first unknown bit: add the whole bytes sent to get the position in the Cascade Level.
+				collisionPos += 8 * (currentLevelKnownBits / 8);
+				if (collisionPos <= currentLevelKnownBits) { // No progress - should not happen 
+					return STATUS_INTERNAL_ERROR;
+				}
+				// Choose the PICC with the bit set.
+				currentLevelKnownBits	= collisionPos;
+				count			= currentLevelKnownBits % 8; // The bit to modify
+				checkBit		= (currentLevelKnownBits - 1) % 8;
+				index			= 1 + (currentLevelKnownBits / 8) + (count ? 1 : 0); // First byte is index 0.
+				buffer[index]	|= (1 << checkBit);
+			}
+			else if (result != STATUS_OK) {
+				return result;
+			}
+			else { // STATUS_OK
+				if (currentLevelKnownBits >= 32) { // This was a SELECT.
+					selectDone = true; // No more anticollision 
+					// We continue below outside the while.
+				}
+				else { // This was an ANTICOLLISION.
+					// We now have all 32 bits of the UID in this Cascade Level
+					currentLevelKnownBits = 32;
+					// Run loop again to do the SELECT.
+				}
+			}
+		} // End of while (!selectDone)
+		
+		// We do not check the CBB - it was constructed by us above.
+		
+		// Copy the found UID bytes from buffer[] to uid->uidByte[]
+		index			= (buffer[2] == PICC_CMD_CT) ? 3 : 2; // source index in buffer[]
+		bytesToCopy		= (buffer[2] == PICC_CMD_CT) ? 3 : 4;
+		for (count = 0; count < bytesToCopy; count++) {
+			uid->uidByte[uidIndex + count] = buffer[index++];
+		}
+		
+		// Check response SAK (Select Acknowledge)
+		if (_hardwareCrc) {
+			if (responseLength != 1 || txLastBits != 0) { // SAK must be exactly 8 bits, the MFRC522 has checked and removed the CRC_A.
+				return STATUS_ERROR;
+			}
+		}
+		else {
+			if (responseLength != 3 || txLastBits != 0) { // SAK must be exactly 24 bits (1 byte + CRC_A).
+				return STATUS_ERROR;
+			}
+			// Verify CRC_A - do our own calculation and store the control in buffer[2..3] - those bytes are not needed anymore.
+			result = PCD_CalculateCRC(responseBuffer, 1, &buffer[2]);
+			if (result != STATUS_OK) {
+				return result;
+			}
+			if ((buffer[2] != responseBuffer[1]) || (buffer[3] != responseBuffer[2])) {
+				return STATUS_CRC_WRONG;
+			}
+		}
+		if (responseBuffer[0] & 0x04) { // Cascade bit set - UID not complete yes
+			cascadeLevel++;
+		}
+		else {
+			uidComplete = true;
+			uid->sak = responseBuffer[0];
+		}
+	} // End of while (!uidComplete)
+	
+	// Set correct uid->size
+	uid->size = 3 * cascadeLevel + 1;
+
+	return STATUS_OK;
+} // End PICC_Select()
+
+/**
+ * Instructs a PICC in state ACTIVE(*) to go to state HALT.
+ *
+ * @return STATUS_OK on success, STATUS_??? otherwise.
+ */ 
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::PICC_HaltA() {
+	StatusCode result;
+	byte buffer[4];
+	
+	// Build command buffer
+	buffer[0] = PICC_CMD_HLTA;
+	buffer[1] = 0;
+	byte bufferUsed = sizeof(buffer);
+	if (_hardwareCrc) {
+		PCD_SetFrameCRC(true, false);	// The MFRC522 appends the CRC_A
+		bufferUsed = 2;
+	}
+	else {
+		// Calculate CRC_A
+		result = PCD_CalculateCRC(buffer, 2, &buffer[2]);
+		if (result != STATUS_OK) {
+			return result;
+		}
+	}
+	
+	// Send the command.
+	// The standard says:
+	//		If the PICC responds with any modulation during a period of 1 ms after the end of the frame containing the
+	//		HLTA command, this response shall be interpreted as 'not acknowledge'.
+	// We interpret that this way: Only STATUS_TIMEOUT is a success.
+	// So the request window is all the wait needed, see PCD_SetRequestWindow().
+	PCD_SetRequestTimer(true);
+	result = PCD_TransceiveData(buffer, bufferUsed, nullptr, 0);
+	if (result == STATUS_TIMEOUT) {
+		return STATUS_OK;
+	}
+	if (result == STATUS_OK) { // That is ironically NOT ok in this case ;-)
+		return STATUS_ERROR;
+	}
+	return result;
+} // End PICC_HaltA()
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Asynchronous communication with PICCs
+/////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Starts the Transceive command and returns without waiting for the PICC: the CPU is free for the LCD, LEDs or serial
+ * line while the frame is on air and the MFRC522 waits for the answer, up to the 25ms of its timer.
+ * PCD_PollTransceive() completes the command. In between no other function may talk to the MFRC522, a synchronous
+ * command abandons the pending one.
+ * backData, backLen and validBits are written when the command completes, they must stay valid until then.
+ *
+ * @return STATUS_OK if the command has been started, STATUS_??? otherwise.
+ */
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::PCD_StartTransceive(	byte *sendData,		///< Pointer to the data to transfer to the FIFO.
+																	byte sendLen,		///< Number of bytes to transfer to the FIFO.
+																	byte *backData,		///< nullptr or pointer to buffer if data should be read back after executing the command.
+																	byte *backLen,		///< In: Max number of bytes to write to *backData. Out: The number of bytes returned.
+																	byte *validBits,	///< In/Out: The number of valid bits in the last byte. 0 for 8 valid bits. Default nullptr.
+																	byte rxAlign,		///< In: Defines the bit position in backData[0] for the first bit received. Default 0.
+																	bool checkCRC		///< In: True => The last two bytes of the response is assumed to be a CRC_A that must be validated.
+																) {
+	if (sendData == nullptr || sendLen > FIFO_SIZE) {
+		return STATUS_INVALID;
+	}
+	if (_transceiveInterruptEnabled) {
+		PCD_WriteRegister(ComIEnReg, 0xB1);		// IRqInv (IRQ pin active low), RxIEn, IdleIEn, TimerIEn
+	}
+	byte txLastBits = validBits ? *validBits : 0;
+	_pending.backData = backData;
+	_pending.backLen = backLen;
+	_pending.validBits = validBits;
+	_pending.rxAlign = rxAlign;
+	_pending.checkCRC = checkCRC;
+	_transceiveInterrupt = false;
+	PCD_StartCommand(PCD_Transceive, sendData, sendLen, (rxAlign << 4) + txLastBits);
+	_pending.startMicros = micros();
+	_pending.pause = 0;
+	_pending.active = true;
+	return STATUS_OK;
+} // End PCD_StartTransceive()
+
+/**
+ * Checks on the command started by PCD_StartTransceive(), one read of ComIrqReg. With PCD_SetTransceiveInterrupt()
+ * not even that until the IRQ pin has signalled.
+ *
+ * @return STATUS_PENDING while the command runs, then its result like PCD_TransceiveData(). STATUS_INVALID if no command was started.
+ */
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::PCD_PollTransceive() {
+	if (!_pending.active) {
+		return STATUS_INVALID;
+	}
+	const uint32_t now = micros();
+	bool overdue = (uint32_t)(now - _pending.startMicros) > _timeoutMicros[OPERATION_TRANSCEIVE];
+	if (_transceiveInterruptEnabled && !_transceiveInterrupt && !overdue) {
+		return STATUS_PENDING;
+	}
+	if ((uint32_t)(now - _pending.pollMicros) < _pending.pause && !overdue) {	// The timer runs, see PCD_CommunicateWithPICC()
+		return STATUS_PENDING;
+	}
+	byte n = PCD_ReadRegister(ComIrqReg);
+	if (!(n & 0x30)) {				// Neither RxIRq nor IdleIRq
+		if ((n & 0x01) || overdue) {	// Timer interrupt - nothing received in 25ms
+			_pending.active = false;
+			return STATUS_TIMEOUT;
+		}
+		if (n & 0x40) {				// TxIRq
+			_pending.pause = PCD_NextPollPause(_pending.pause);
+			_pending.pollMicros = now;
+		}
+		return STATUS_PENDING;
+	}
+	_pending.active = false;
+	return PCD_FinishCommand(_pending.backData, _pending.backLen, _pending.validBits, _pending.rxAlign, _pending.checkCRC);
+} // End PCD_PollTransceive()
+
+/**
+ * With enabled, PCD_StartTransceive() lets the MFRC522 pull its IRQ pin low when the command completes or times out,
+ * and PCD_PollTransceive() talks to the chip only after PCD_TransceiveInterrupt() has been called.
+ * Connect IRQ to an interrupt pin with INPUT_PULLUP and attach an ISR for FALLING that calls PCD_TransceiveInterrupt().
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PCD_SetTransceiveInterrupt(	bool enabled	///< true when the IRQ pin is connected as described
+														) {
+	_transceiveInterruptEnabled = enabled;
+	if (!enabled) {
+		PCD_WriteRegister(ComIEnReg, 0x80);		// Reset value: IRqInv, no interrupt sources
+	}
+} // End PCD_SetTransceiveInterrupt()
+
+/**
+ * To be called from the ISR of the IRQ pin. Only sets a flag, the bus is left to PCD_PollTransceive().
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PCD_TransceiveInterrupt() {
+	_transceiveInterrupt = true;
+} // End PCD_TransceiveInterrupt()
+
+/**
+ * PICC_IsNewCardPresent() split over several calls: the first one sends the REQA, the following ones check for the
+ * answer. Call it from loop() until it stops returning STATUS_PENDING, the next call starts a new REQA.
+ * No other function may talk to the MFRC522 while it is pending.
+ *
+ * @return STATUS_OK if a PICC in state IDLE answered, STATUS_PENDING while waiting, STATUS_??? otherwise.
+ */
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::PICC_PollNewCardPresent() {
+	if (!_pending.active) {
+		// Reset baud rates and ModWidthReg
+		PCD_WriteRegisters_P(resetBaudRatesScript, sizeof(resetBaudRatesScript) / sizeof(resetBaudRatesScript[0]));
+		PCD_SetFrameCRC(false, false);			// Neither the short frame nor the ATQA has a CRC_A
+		PCD_ClearRegisterBitMask(CollReg, 0x80);	// ValuesAfterColl=1 => Bits received after collision are cleared.
+		PCD_SetRequestTimer(true);				// See PCD_SetRequestWindow()
+		byte command = PICC_CMD_REQA;
+		_requestATQASize = sizeof(_requestATQA);
+		_requestValidBits = 7;					// Short frame, see PICC_REQA_or_WUPA()
+		StatusCode result = PCD_StartTransceive(&command, 1, _requestATQA, &_requestATQASize, &_requestValidBits);
+		return result == STATUS_OK ? STATUS_PENDING : result;
+	}
+	StatusCode result = PCD_PollTransceive();
+	if (result != STATUS_PENDING && result != STATUS_TIMEOUT) {
+		PCD_SetRequestTimer(false);				// A PICC answered, SELECT follows
+	}
+	if (result == STATUS_COLLISION) {			// Several PICCs answered, PICC_Select() sorts them out
+		return STATUS_OK;
+	}
+	if (result == STATUS_OK && (_requestATQASize != 2 || _requestValidBits != 0)) {	// ATQA must be exactly 16 bits.
+		return STATUS_ERROR;
+	}
+	return result;
+} // End PICC_PollNewCardPresent()
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Functions for communicating with MIFARE PICCs
+/////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Executes the MFRC522 MFAuthent command.
+ * This command manages MIFARE authentication to enable a secure communication to any MIFARE Mini, MIFARE 1K and MIFARE 4K card.
+ * The authentication is described in the MFRC522 datasheet section 10.3.1.9 and http://www.nxp.com/documents/data_sheet/MF1S503x.pdf section 10.1.
+ * For use with MIFARE Classic PICCs.
+ * The PICC must be selected - ie in state ACTIVE(*) - before calling this function.
+ * Remember to call PCD_StopCrypto1() after communicating with the authenticated PICC - otherwise no new communications can start.
+ * 
+ * All keys are set to FFFFFFFFFFFFh at chip delivery.
+ * 
+ * @return STATUS_OK on success, STATUS_??? otherwise. Probably STATUS_TIMEOUT if you supply the wrong key.
+ */
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::PCD_Authenticate(byte command,		///< PICC_CMD_MF_AUTH_KEY_A or PICC_CMD_MF_AUTH_KEY_B
+															byte blockAddr, 	///< The block number. See numbering in the comments in the .h file.
+															MIFARE_Key *key,	///< Pointer to the Crypteo1 key to use (6 bytes)
+															Uid *uid			///< Pointer to Uid struct. The first 4 bytes of the UID is used.
+															) {
+	byte waitIRq = 0x10;		// IdleIRq
+	
+	// Build command buffer
+	byte sendData[12];
+	sendData[0] = command;
+	sendData[1] = blockAddr;
+	for (byte i = 0; i < MF_KEY_SIZE; i++) {	// 6 key bytes
+		sendData[2+i] = key->keyByte[i];
+	}
+	// Use the last uid bytes as specified in http://cache.nxp.com/documents/application_note/AN10927.pdf
+	// section 3.2.5 "MIFARE Classic Authentication".
+	// The only missed case is the MF1Sxxxx shortcut activation,
+	// but it requires cascade tag (CT) byte, that is not part of uid.
+	for (byte i = 0; i < 4; i++) {				// The last 4 bytes of the UID
+		sendData[8+i] = uid->uidByte[i+uid->size-4];
+	}
+	
+	// Start the authentication.
+	return PCD_CommunicateWithPICC(PCD_MFAuthent, waitIRq, &sendData[0], sizeof(sendData));
+} // End PCD_Authenticate()
+
+/**
+ * Authenticates with the first of keys the sector accepts. A key the PICC refuses sends it back to state IDLE, so it
+ * is woken and selected again (WUPA, SELECT of uid) before the next key is tried: each key that does not fit costs the
+ * 25ms of the timer and a SELECT. With a cache set by PCD_SetKeyCache() the key that opened the sector of this PICC
+ * last time is tried first, a known PICC opens on the first try.
+ * 
+ * @return STATUS_OK on success, the result of the last PCD_Authenticate() otherwise.
+ */
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::PCD_AuthenticateWithKeys(	byte command,		///< PICC_CMD_MF_AUTH_KEY_A or PICC_CMD_MF_AUTH_KEY_B
+																				byte blockAddr,		///< The block number. See numbering in the comments in the .h file.
+																				MIFARE_Key *keys,	///< The keys to try.
+																				byte keyCount,		///< The number of keys.
+																				Uid *uid,			///< The selected PICC, as read by PICC_Select().
+																				byte *keyIndex		///< Out: the index of the key that fitted. May be nullptr.
+																			) {
+	// The cache entry: the sector, bit 7 for key B
+	byte slot = (blockAddr < 128 ? blockAddr / 4 : 32 + (blockAddr - 128) / 16) | (command == PICC_CMD_MF_AUTH_KEY_B ? 0x80 : 0);
+	byte hint = _keyCache ? _keyCache->find(uid, slot) : MFRC522KeyCache::NO_HINT;
+	StatusCode result = STATUS_INVALID;
+	bool refused = false;
+	
+	// The hint first, then the others in their order
+	for (uint16_t attempt = 0; attempt <= keyCount; attempt++) {		// 16 bits, a list of 255 keys takes 256 attempts
+		byte index = attempt == 0 ? hint : (byte)(attempt - 1);
+		if (index >= keyCount || (attempt > 0 && index == hint)) {
+			continue;
+		}
+		if (refused) {
+			byte bufferATQA[2];
+			byte bufferSize = sizeof(bufferATQA);
+			Uid known = *uid;
+			PCD_StopCrypto1();
+			result = PICC_WakeupA(bufferATQA, &bufferSize);
+			if (result != STATUS_OK && result != STATUS_COLLISION) {
+				return result;		// The PICC has gone
+			}
+			result = PICC_Select(&known, known.size * 8);
+			if (result != STATUS_OK) {
+				return result;
+			}
+		}
+		result = PCD_Authenticate(command, blockAddr, &keys[index], uid);
+		if (result == STATUS_OK) {
+			if (_keyCache) {
+				_keyCache->remember(uid, slot, index);
+			}
+			if (keyIndex) {
+				*keyIndex = index;
+			}
+			return STATUS_OK;
+		}
+		refused = true;
+	}
+	return result;
+} // End PCD_AuthenticateWithKeys()
+
+/**
+ * Sets the cache of PCD_AuthenticateWithKeys(), see MFRC522KeyCache.h. nullptr, the default, tries the keys in their order.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PCD_SetKeyCache(	MFRC522KeyCache *cache	///< The cache, it has to live as long as this object.
+											) {
+	_keyCache = cache;
+} // End PCD_SetKeyCache()
+
+/**
+ * Used to exit the PCD from its authenticated state.
+ * Remember to call this function after communicating with an authenticated PICC - otherwise no new communications can start.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PCD_StopCrypto1() {
+	// Clear MFCrypto1On bit
+	PCD_ClearRegisterBitMask(Status2Reg, 0x08); // Status2Reg[7..0] bits are: TempSensClear I2CForceHS reserved reserved MFCrypto1On ModemState[2:0]
+} // End PCD_StopCrypto1()
+
+/**
+ * Reads 16 bytes (+ 2 bytes CRC_A) from the active PICC.
+ * 
+ * For MIFARE Classic the sector containing the block must be authenticated before calling this function.
+ * 
+ * For MIFARE Ultralight only addresses 00h to 0Fh are decoded.
+ * The MF0ICU1 returns a NAK for higher addresses.
+ * The MF0ICU1 responds to the READ command by sending 16 bytes starting from the page address defined by the command argument.
+ * For example; if blockAddr is 03h then pages 03h, 04h, 05h, 06h are returned.
+ * A roll-back is implemented: If blockAddr is 0Eh, then the contents of pages 0Eh, 0Fh, 00h and 01h are returned.
+ * 
+ * The buffer must be at least 18 bytes because a CRC_A is also returned.
+ * Checks the CRC_A before returning STATUS_OK. With PCD_SetHardwareCRC() the MFRC522 checks it and only the 16 bytes are returned.
+ * 
+ * @return STATUS_OK on success, STATUS_??? otherwise.
+ */
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::MIFARE_Read(	byte blockAddr, 	///< MIFARE Classic: The block (0-0xff) number. MIFARE Ultralight: The first page to return data from.
+															byte *buffer,		///< The buffer to store the data in
+															byte *bufferSize	///< Buffer size, at least 18 bytes. Also number of bytes returned if STATUS_OK.
+														) {
+	StatusCode result;
+	
+	// Sanity check
+	if (buffer == nullptr || *bufferSize < 18) {
+		return STATUS_NO_ROOM;
+	}
+	
+	// Build command buffer
+	buffer[0] = PICC_CMD_MF_READ;
+	buffer[1] = blockAddr;
+	if (_hardwareCrc) {
+		// The MFRC522 appends the CRC_A, checks the one of the response and removes it: 16 bytes come back.
+		PCD_SetFrameCRC(true, true);
+		return PCD_TransceiveData(buffer, 2, buffer, bufferSize);
+	}
+	// Calculate CRC_A
+	result = PCD_CalculateCRC(buffer, 2, &buffer[2]);
+	if (result != STATUS_OK) {
+		return result;
+	}
+	
+	// Transmit the buffer and receive the response, validate CRC_A.
+	return PCD_TransceiveData(buffer, 4, buffer, bufferSize, nullptr, 0, true);
+} // End MIFARE_Read()
+
+/**
+ * Reads count blocks of a MIFARE Classic PICC, starting at firstBlock, into buffer. Each sector on the way is
+ * authenticated once with key, then its blocks are read one READ after the other. The MFRC522 appends and checks the
+ * CRC_A of these frames, see PCD_SetHardwareCRC(), so a block is one frame to the PICC and 16 bytes from the FIFO.
+ * The sector trailers are skipped unless withTrailers is set: count is the number of blocks stored in buffer.
+ * 
+ * The PICC must be selected, its UID in uid, as after PICC_ReadCardSerial(). Call PCD_StopCrypto1() when done.
+ * 
+ * @return STATUS_OK on success, STATUS_??? otherwise.
+ */
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::MIFARE_ReadRange(	byte firstBlock,	///< The first block to read, 0 to 255.
+																		byte count,			///< The number of blocks to store in buffer.
+																		MIFARE_Key *key,	///< The Crypto1 key of the sectors.
+																		byte *buffer,		///< The buffer to store the data in, count * 16 bytes.
+																		bool withTrailers,	///< true to read the sector trailers as well.
+																		byte command		///< PICC_CMD_MF_AUTH_KEY_A or PICC_CMD_MF_AUTH_KEY_B
+																	) {
+	if (buffer == nullptr || key == nullptr) {
+		return STATUS_INVALID;
+	}
+	
+	bool hardwareCrc = _hardwareCrc;
+	_hardwareCrc = true;		// For MIFARE_Read(), set back below
+	StatusCode result = STATUS_OK;
+	byte authenticated = 0xFF;	// The sector the PICC has authenticated, none yet
+	uint16_t block = firstBlock;
+	while (count > 0) {
+		if (block > 0xFF) {
+			result = STATUS_INVALID;
+			break;
+		}
+		// Sectors 0 to 31 have 4 blocks, sectors 32 to 39 of the 4K have 16. The last block is the trailer.
+		bool trailer = block < 128 ? (block & 0x03) == 0x03 : (block & 0x0F) == 0x0F;
+		if (trailer && !withTrailers) {
+			block++;
+			continue;
+		}
+		byte sector = block < 128 ? block / 4 : 32 + (block - 128) / 16;
+		if (sector != authenticated) {
+			result = PCD_Authenticate(command, (byte)block, key, &uid);
+			if (result != STATUS_OK) {
+				break;
+			}
+			authenticated = sector;
+		}
+		byte frame[18];			// MIFARE_Read() wants room for the CRC_A
+		byte frameSize = sizeof(frame);
+		result = MIFARE_Read((byte)block, frame, &frameSize);
+		if (result != STATUS_OK) {
+			break;
+		}
+		if (frameSize != 16) {
+			result = STATUS_ERROR;
+			break;
+		}
+		memcpy(buffer, frame, 16);
+		buffer += 16;
+		block++;
+		count--;
+	}
+	PCD_SetHardwareCRC(hardwareCrc);
+	return result;
+} // End MIFARE_ReadRange()
+
+/**
+ * Reads the data blocks of one sector of a MIFARE Classic PICC with one authentication, see MIFARE_ReadRange().
+ * buffer takes 48 bytes for sectors 0 to 31 and 240 for sectors 32 to 39 of the 4K, 16 more with the trailer.
+ * 
+ * @return STATUS_OK on success, STATUS_??? otherwise.
+ */
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::MIFARE_ReadSector(	byte sector,		///< The sector, 0 to 39.
+																		MIFARE_Key *key,	///< The Crypto1 key of the sector.
+																		byte *buffer,		///< The buffer to store the data in.
+																		bool withTrailer,	///< true to read the sector trailer as well.
+																		byte command		///< PICC_CMD_MF_AUTH_KEY_A or PICC_CMD_MF_AUTH_KEY_B
+																	) {
+	if (sector > 39) {
+		return STATUS_INVALID;
+	}
+	byte firstBlock = sector < 32 ? sector * 4 : 128 + (sector - 32) * 16;
+	byte dataBlocks = sector < 32 ? 3 : 15;
+	return MIFARE_ReadRange(firstBlock, withTrailer ? dataBlocks + 1 : dataBlocks, key, buffer, withTrailer, command);
+} // End MIFARE_ReadSector()
+
+/**
+ * Writes 16 bytes to the active PICC.
+ * 
+ * For MIFARE Classic the sector containing the block must be authenticated before calling this function.
+ * 
+ * For MIFARE Ultralight the operation is called "COMPATIBILITY WRITE".
+ * Even though 16 bytes are transferred to the Ultralight PICC, only the least significant 4 bytes (bytes 0 to 3)
+ * are written to the specified address. It is recommended to set the remaining bytes 04h to 0Fh to all logic 0.
+ * * 
+ * @return STATUS_OK on success, STATUS_??? otherwise.
+ */
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::MIFARE_Write(	byte blockAddr, ///< MIFARE Classic: The block (0-0xff) number. MIFARE Ultralight: The page (2-15) to write to.
+															byte *buffer,	///< The 16 bytes to write to the PICC
+															byte bufferSize	///< Buffer size, must be at least 16 bytes. Exactly 16 bytes are written.
+														) {
+	StatusCode result;
+	
+	// Sanity check
+	if (buffer == nullptr || bufferSize < 16) {
+		return STATUS_INVALID;
+	}
+	
+	// Mifare Classic protocol requires two communications to perform a write.
+	// Step 1: Tell the PICC we want to write to block blockAddr.
+	byte cmdBuffer[2];
+	cmdBuffer[0] = PICC_CMD_MF_WRITE;
+	cmdBuffer[1] = blockAddr;
+	result = PCD_MIFARE_Transceive(cmdBuffer, 2); // Adds CRC_A and checks that the response is MF_ACK.
+	if (result != STATUS_OK) {
+		return result;
+	}
+	
+	// Step 2: Transfer the data
+	result = PCD_MIFARE_Transceive(buffer, bufferSize); // Adds CRC_A and checks that the response is MF_ACK.
+	if (result != STATUS_OK) {
+		return result;
+	}
+	
+	return STATUS_OK;
+} // End MIFARE_Write()
+
+/**
+ * Writes a 4 byte page to the active MIFARE Ultralight PICC.
+ * 
+ * @return STATUS_OK on success, STATUS_??? otherwise.
+ */
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::MIFARE_Ultralight_Write(	byte page, 		///< The page (2-15) to write to.
+																		byte *buffer,	///< The 4 bytes to write to the PICC
+																		byte bufferSize	///< Buffer size, must be at least 4 bytes. Exactly 4 bytes are written.
+																	) {
+	StatusCode result;
+	
+	// Sanity check
+	if (buffer == nullptr || bufferSize < 4) {
+		return STATUS_INVALID;
+	}
+	
+	// Build commmand buffer
+	byte cmdBuffer[6];
+	cmdBuffer[0] = PICC_CMD_UL_WRITE;
+	cmdBuffer[1] = page;
+	memcpy(&cmdBuffer[2], buffer, 4);
+	
+	// Perform the write
+	result = PCD_MIFARE_Transceive(cmdBuffer, 6); // Adds CRC_A and checks that the response is MF_ACK.
+	if (result != STATUS_OK) {
+		return result;
+	}
+	return STATUS_OK;
+} // End MIFARE_Ultralight_Write()
+
+/**
+ * Reads the pages firstPage to lastPage of the active MIFARE Ultralight or NTAG PICC into buffer, 4 bytes a page.
+ * 
+ * A PICC that answers GET_VERSION as an Ultralight EV1 or NTAG21x is read with FAST_READ, up to 63 pages a frame
+ * streamed through the FIFO with PCD_TransceiveStream(). Any other is read with READ, 4 pages a frame. GET_VERSION puts a PICC that does not know it back to IDLE,
+ * it is selected again with the uid member before the first READ.
+ * 
+ * @return STATUS_OK on success, STATUS_??? otherwise.
+ */
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::MIFARE_Ultralight_ReadPages(	byte firstPage,	///< The first page to read.
+																				byte lastPage,	///< The last page to read, at least firstPage.
+																				byte *buffer	///< The buffer to store the data in, (lastPage - firstPage + 1) * 4 bytes.
+																			) {
+	if (buffer == nullptr || lastPage < firstPage) {
+		return STATUS_INVALID;
+	}
+	
+	bool hardwareCrc = _hardwareCrc;
+	_hardwareCrc = true;		// For MIFARE_Read(), set back below
+	
+	// GET_VERSION tells the NXP Ultralight EV1 (product type 03h) and NTAG21x (04h) from the others
+	byte version[10];
+	byte versionSize = sizeof(version);
+	version[0] = PICC_CMD_UL_GET_VERSION;
+	PCD_SetFrameCRC(true, true);
+	StatusCode result = PCD_TransceiveData(version, 1, version, &versionSize);
+	bool fastRead = result == STATUS_OK && versionSize == 8 && version[1] == 0x04 && (version[2] == 0x03 || version[2] == 0x04);
+	if (result != STATUS_OK) {
+		// The PICC has gone to IDLE, wake and select it again
+		byte bufferATQA[2];
+		byte bufferSize = sizeof(bufferATQA);
+		Uid known = uid;
+		result = PICC_WakeupA(bufferATQA, &bufferSize);
+		if (result == STATUS_OK || result == STATUS_COLLISION) {
+			result = PICC_Select(&known, known.size * 8);
+		}
+		if (result != STATUS_OK) {
+			PCD_SetHardwareCRC(hardwareCrc);
+			return result;
+		}
+	}
+	
+	uint16_t page = firstPage;
+	while (page <= lastPage) {
+		byte pages;
+		if (fastRead) {
+			pages = lastPage - page + 1 < 63 ? lastPage - page + 1 : 63;	// 252 bytes, streamed through the FIFO
+			byte command[3] = {PICC_CMD_UL_FAST_READ, (byte)page, (byte)(page + pages - 1)};
+			uint16_t backLen = pages * 4;
+			PCD_SetFrameCRC(true, true);
+			result = PCD_TransceiveStream(command, sizeof(command), buffer, &backLen);
+			if (result == STATUS_OK && backLen != pages * 4) {
+				result = STATUS_ERROR;
+			}
+		} else {
+			pages = lastPage - page + 1 < 4 ? lastPage - page + 1 : 4;
+			byte frame[18];			// MIFARE_Read() wants room for the CRC_A
+			byte frameSize = sizeof(frame);
+			result = MIFARE_Read((byte)page, frame, &frameSize);
+			if (result == STATUS_OK && frameSize != 16) {
+				result = STATUS_ERROR;
+			}
+			if (result == STATUS_OK) {
+				memcpy(buffer, frame, pages * 4);
+			}
+		}
+		if (result != STATUS_OK) {
+			break;
+		}
+		buffer += pages * 4;
+		page += pages;
+	}
+	PCD_SetHardwareCRC(hardwareCrc);
+	return result;
+} // End MIFARE_Ultralight_ReadPages()
+
+/**
+ * MIFARE Decrement subtracts the delta from the value of the addressed block, and stores the result in a volatile memory.
+ * For MIFARE Classic only. The sector containing the block must be authenticated before calling this function.
+ * Only for blocks in "value block" mode, ie with access bits [C1 C2 C3] = [110] or [001].
+ * Use MIFARE_Transfer() to store the result in a block.
+ * 
+ * @return STATUS_OK on success, STATUS_??? otherwise.
+ */
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::MIFARE_Decrement(	byte blockAddr, ///< The block (0-0xff) number.
+																int32_t delta		///< This number is subtracted from the value of block blockAddr.
+															) {
+	return MIFARE_TwoStepHelper(PICC_CMD_MF_DECREMENT, blockAddr, delta);
+} // End MIFARE_Decrement()
+
+/**
+ * MIFARE Increment adds the delta to the value of the addressed block, and stores the result in a volatile memory.
+ * For MIFARE Classic only. The sector containing the block must be authenticated before calling this function.
+ * Only for blocks in "value block" mode, ie with access bits [C1 C2 C3] = [110] or [001].
+ * Use MIFARE_Transfer() to store the result in a block.
+ * 
+ * @return STATUS_OK on success, STATUS_??? otherwise.
+ */
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::MIFARE_Increment(	byte blockAddr, ///< The block (0-0xff) number.
+																int32_t delta		///< This number is added to the value of block blockAddr.
+															) {
+	return MIFARE_TwoStepHelper(PICC_CMD_MF_INCREMENT, blockAddr, delta);
+} // End MIFARE_Increment()
+
+/**
+ * MIFARE Restore copies the value of the addressed block into a volatile memory.
+ * For MIFARE Classic only. The sector containing the block must be authenticated before calling this function.
+ * Only for blocks in "value block" mode, ie with access bits [C1 C2 C3] = [110] or [001].
+ * Use MIFARE_Transfer() to store the result in a block.
+ * 
+ * @return STATUS_OK on success, STATUS_??? otherwise.
+ */
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::MIFARE_Restore(	byte blockAddr ///< The block (0-0xff) number.
+															) {
+	// The datasheet describes Restore as a two step operation, but does not explain what data to transfer in step 2.
+	// Doing only a single step does not work, so I chose to transfer 0L in step two.
+	return MIFARE_TwoStepHelper(PICC_CMD_MF_RESTORE, blockAddr, 0L);
+} // End MIFARE_Restore()
+
+/**
+ * Helper function for the two-step MIFARE Classic protocol operations Decrement, Increment and Restore.
+ * 
+ * @return STATUS_OK on success, STATUS_??? otherwise.
+ */
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::MIFARE_TwoStepHelper(	byte command,	///< The command to use
+																	byte blockAddr,	///< The block (0-0xff) number.
+																	int32_t data		///< The data to transfer in step 2
+																	) {
+	StatusCode result;
+	byte cmdBuffer[2]; // We only need room for 2 bytes.
+	
+	// Step 1: Tell the PICC the command and block address
+	cmdBuffer[0] = command;
+	cmdBuffer[1] = blockAddr;
+	result = PCD_MIFARE_Transceive(	cmdBuffer, 2); // Adds CRC_A and checks that the response is MF_ACK.
+	if (result != STATUS_OK) {
+		return result;
+	}
+	
+	// Step 2: Transfer the data
+	result = PCD_MIFARE_Transceive(	(byte *)&data, 4, true); // Adds CRC_A and accept timeout as success.
+	if (result != STATUS_OK) {
+		return result;
+	}
+	
+	return STATUS_OK;
+} // End MIFARE_TwoStepHelper()
+
+/**
+ * MIFARE Transfer writes the value stored in the volatile memory into one MIFARE Classic block.
+ * For MIFARE Classic only. The sector containing the block must be authenticated before calling this function.
+ * Only for blocks in "value block" mode, ie with access bits [C1 C2 C3] = [110] or [001].
+ * 
+ * @return STATUS_OK on success, STATUS_??? otherwise.
+ */
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::MIFARE_Transfer(	byte blockAddr ///< The block (0-0xff) number.
+															) {
+	StatusCode result;
+	byte cmdBuffer[2]; // We only need room for 2 bytes.
+	
+	// Tell the PICC we want to transfer the result into block blockAddr.
+	cmdBuffer[0] = PICC_CMD_MF_TRANSFER;
+	cmdBuffer[1] = blockAddr;
+	result = PCD_MIFARE_Transceive(	cmdBuffer, 2); // Adds CRC_A and checks that the response is MF_ACK.
+	if (result != STATUS_OK) {
+		return result;
+	}
+	return STATUS_OK;
+} // End MIFARE_Transfer()
+
+/**
+ * Helper routine to read the current value from a Value Block.
+ * 
+ * Only for MIFARE Classic and only for blocks in "value block" mode, that
+ * is: with access bits [C1 C2 C3] = [110] or [001]. The sector containing
+ * the block must be authenticated before calling this function. 
+ * 
+ * @param[in]   blockAddr   The block (0x00-0xff) number.
+ * @param[out]  value       Current value of the Value Block.
+ * @return STATUS_OK on success, STATUS_??? otherwise.
+  */
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::MIFARE_GetValue(byte blockAddr, int32_t *value) {
+	StatusCode status;
+	byte buffer[18];
+	byte size = sizeof(buffer);
+	
+	// Read the block
+	status = MIFARE_Read(blockAddr, buffer, &size);
+	if (status == STATUS_OK) {
+		// Extract the value
+		*value = (int32_t(buffer[3])<<24) | (int32_t(buffer[2])<<16) | (int32_t(buffer[1])<<8) | int32_t(buffer[0]);
+	}
+	return status;
+} // End MIFARE_GetValue()
+
+/**
+ * Helper routine to write a specific value into a Value Block.
+ * 
+ * Only for MIFARE Classic and only for blocks in "value block" mode, that
+ * is: with access bits [C1 C2 C3] = [110] or [001]. The sector containing
+ * the block must be authenticated before calling this function. 
+ * 
+ * @param[in]   blockAddr   The block (0x00-0xff) number.
+ * @param[in]   value       New value of the Value Block.
+ * @return STATUS_OK on success, STATUS_??? otherwise.
+ */
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::MIFARE_SetValue(byte blockAddr, int32_t value) {
+	byte buffer[18];
+	
+	// Translate the int32_t into 4 bytes; repeated 2x in value block
+	buffer[0] = buffer[ 8] = (value & 0xFF);
+	buffer[1] = buffer[ 9] = (value & 0xFF00) >> 8;
+	buffer[2] = buffer[10] = (value & 0xFF0000) >> 16;
+	buffer[3] = buffer[11] = (value & 0xFF000000) >> 24;
+	// Inverse 4 bytes also found in value block
+	buffer[4] = ~buffer[0];
+	buffer[5] = ~buffer[1];
+	buffer[6] = ~buffer[2];
+	buffer[7] = ~buffer[3];
+	// Address 2x with inverse address 2x
+	buffer[12] = buffer[14] = blockAddr;
+	buffer[13] = buffer[15] = ~blockAddr;
+	
+	// Write the whole data block
+	return MIFARE_Write(blockAddr, buffer, 16);
+} // End MIFARE_SetValue()
+
+/**
+ * Authenticate with a NTAG216.
+ * 
+ * Only for NTAG216. First implemented by Gargantuanman.
+ * 
+ * @param[in]   passWord   password.
+ * @param[in]   pACK       result success???.
+ * @return STATUS_OK on success, STATUS_??? otherwise.
+ */
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::PCD_NTAG216_AUTH(byte* passWord, byte pACK[]) //Authenticate with 32bit password
+{
+	// TODO: Fix cmdBuffer length and rxlength. They really should match.
+	//       (Better still, rxlength should not even be necessary.)
+
+	StatusCode result;
+	byte				cmdBuffer[18]; // We need room for 16 bytes data and 2 bytes CRC_A.
+	
+	cmdBuffer[0] = 0x1B; //Comando de autentificacion
+	
+	for (byte i = 0; i<4; i++)
+		cmdBuffer[i+1] = passWord[i];
+	
+	PCD_SetFrameCRC(false, false);	// The CRC_A is added here and the PACK returned with its own
+	result = PCD_CalculateCRC(cmdBuffer, 5, &cmdBuffer[5]);
+	
+	if (result!=STATUS_OK) {
+		return result;
+	}
+	
+	// Transceive the data, store the reply in cmdBuffer[]
+	byte waitIRq		= 0x30;	// RxIRq and IdleIRq
+//	byte cmdBufferSize	= sizeof(cmdBuffer);
+	byte validBits		= 0;
+	byte rxlength		= 5;
+	result = PCD_CommunicateWithPICC(PCD_Transceive, waitIRq, cmdBuffer, 7, cmdBuffer, &rxlength, &validBits);
+	
+	pACK[0] = cmdBuffer[0];
+	pACK[1] = cmdBuffer[1];
+	
+	if (result!=STATUS_OK) {
+		return result;
+	}
+	
+	return STATUS_OK;
+} // End PCD_NTAG216_AUTH()
+
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Support functions
+/////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Wrapper for MIFARE protocol communication.
+ * Adds CRC_A, executes the Transceive command and checks that the response is MF_ACK or a timeout.
+ * 
+ * @return STATUS_OK on success, STATUS_??? otherwise.
+ */
+template <class Transport>
+MFRC522Constants::StatusCode MFRC522Base<Transport>::PCD_MIFARE_Transceive(	byte *sendData,		///< Pointer to the data to transfer to the FIFO. Do NOT include the CRC_A.
+																	byte sendLen,		///< Number of bytes in sendData.
+																	bool acceptTimeout	///< True => A timeout is also success
+																) {
+	StatusCode result;
+	byte cmdBuffer[18]; // We need room for 16 bytes data and 2 bytes CRC_A.
+	
+	// Sanity check
+	if (sendData == nullptr || sendLen > 16) {
+		return STATUS_INVALID;
+	}
+	
+	// Copy sendData[] to cmdBuffer[] and add CRC_A
+	memcpy(cmdBuffer, sendData, sendLen);
+	if (_hardwareCrc) {
+		PCD_SetFrameCRC(true, false);	// The MFRC522 adds the CRC_A, the ACK has none
+	}
+	else {
+		result = PCD_CalculateCRC(cmdBuffer, sendLen, &cmdBuffer[sendLen]);
+		if (result != STATUS_OK) { 
+			return result;
+		}
+		sendLen += 2;
+	}
+	
+	// Transceive the data, store the reply in cmdBuffer[]
+	byte waitIRq = 0x30;		// RxIRq and IdleIRq
+	byte cmdBufferSize = sizeof(cmdBuffer);
+	byte validBits = 0;
+	result = PCD_CommunicateWithPICC(PCD_Transceive, waitIRq, cmdBuffer, sendLen, cmdBuffer, &cmdBufferSize, &validBits);
+	if (acceptTimeout && result == STATUS_TIMEOUT) {
+		return STATUS_OK;
+	}
+	if (result != STATUS_OK) {
+		return result;
+	}
+	// The PICC must reply with a 4 bit ACK
+	if (cmdBufferSize != 1 || validBits != 4) {
+		return STATUS_ERROR;
+	}
+	if (cmdBuffer[0] != MF_ACK) {
+		return STATUS_MIFARE_NACK;
+	}
+	return STATUS_OK;
+} // End PCD_MIFARE_Transceive()
+
+/**
+ * Dumps debug info about the connected PCD to Serial.
+ * Shows all known firmware versions
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PCD_DumpVersionToSerial() {
+	// Get the MFRC522 firmware version
+	byte v = PCD_ReadRegister(VersionReg);
+	Serial.print(F("Firmware Version: 0x"));
+	Serial.print(v, HEX);
+	// Lookup which version
+	switch(v) {
+		case 0x88: Serial.println(F(" = (clone)"));  break;
+		case 0x90: Serial.println(F(" = v0.0"));     break;
+		case 0x91: Serial.println(F(" = v1.0"));     break;
+		case 0x92: Serial.println(F(" = v2.0"));     break;
+		case 0x12: Serial.println(F(" = counterfeit chip"));     break;
+		default:   Serial.println(F(" = (unknown)"));
+	}
+	// When 0x00 or 0xFF is returned, communication probably failed
+	if ((v == 0x00) || (v == 0xFF))
+		Serial.println(F("WARNING: Communication failure, is the MFRC522 properly connected?"));
+} // End PCD_DumpVersionToSerial()
+
+/**
+ * Dumps debug info about the selected PICC to Serial.
+ * On success the PICC is halted after dumping the data.
+ * For MIFARE Classic the factory default key of 0xFFFFFFFFFFFF is tried.  
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PICC_DumpToSerial(Uid *uid	///< Pointer to Uid struct returned from a successful PICC_Select().
+												) {
+	MIFARE_Key key;
+	
+	// Dump UID, SAK and Type
+	PICC_DumpDetailsToSerial(uid);
+	
+	// Dump contents
+	PICC_Type piccType = PICC_GetType(uid->sak);
+	switch (piccType) {
+		case PICC_TYPE_MIFARE_MINI:
+		case PICC_TYPE_MIFARE_1K:
+		case PICC_TYPE_MIFARE_4K:
+			// All keys are set to FFFFFFFFFFFFh at chip delivery from the factory.
+			for (byte i = 0; i < 6; i++) {
+				key.keyByte[i] = 0xFF;
+			}
+			PICC_DumpMifareClassicToSerial(uid, piccType, &key);
+			break;
+			
+		case PICC_TYPE_MIFARE_UL:
+			PICC_DumpMifareUltralightToSerial();
+			break;
+			
+		case PICC_TYPE_ISO_14443_4:
+		case PICC_TYPE_MIFARE_DESFIRE:
+		case PICC_TYPE_ISO_18092:
+		case PICC_TYPE_MIFARE_PLUS:
+		case PICC_TYPE_TNP3XXX:
+			Serial.println(F("Dumping memory contents not implemented for that PICC type."));
+			break;
+			
+		case PICC_TYPE_UNKNOWN:
+		case PICC_TYPE_NOT_COMPLETE:
+		default:
+			break; // No memory dump here
+	}
+	
+	Serial.println();
+	PICC_HaltA(); // Already done if it was a MIFARE Classic PICC.
+} // End PICC_DumpToSerial()
+
+/**
+ * Dumps card info (UID,SAK,Type) about the selected PICC to Serial.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PICC_DumpDetailsToSerial(Uid *uid	///< Pointer to Uid struct returned from a successful PICC_Select().
+													) {
+	// UID
+	Serial.print(F("Card UID:"));
+	for (byte i = 0; i < uid->size; i++) {
+		if(uid->uidByte[i] < 0x10)
+			Serial.print(F(" 0"));
+		else
+			Serial.print(F(" "));
+		Serial.print(uid->uidByte[i], HEX);
+	} 
+	Serial.println();
+	
+	// SAK
+	Serial.print(F("Card SAK: "));
+	if(uid->sak < 0x10)
+		Serial.print(F("0"));
+	Serial.println(uid->sak, HEX);
+	
+	// (suggested) PICC type
+	PICC_Type piccType = PICC_GetType(uid->sak);
+	Serial.print(F("PICC type: "));
+	Serial.println(PICC_GetTypeName(piccType));
+} // End PICC_DumpDetailsToSerial()
+
+/**
+ * Dumps memory contents of a MIFARE Classic PICC.
+ * On success the PICC is halted after dumping the data.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PICC_DumpMifareClassicToSerial(	Uid *uid,			///< Pointer to Uid struct returned from a successful PICC_Select().
+																PICC_Type piccType,	///< One of the PICC_Type enums.
+																MIFARE_Key *key		///< Key A used for all sectors.
+															) {
+	byte no_of_sectors = 0;
+	switch (piccType) {
+		case PICC_TYPE_MIFARE_MINI:
+			// Has 5 sectors * 4 blocks/sector * 16 bytes/block = 320 bytes.
+			no_of_sectors = 5;
+			break;
+			
+		case PICC_TYPE_MIFARE_1K:
+			// Has 16 sectors * 4 blocks/sector * 16 bytes/block = 1024 bytes.
+			no_of_sectors = 16;
+			break;
+			
+		case PICC_TYPE_MIFARE_4K:
+			// Has (32 sectors * 4 blocks/sector + 8 sectors * 16 blocks/sector) * 16 bytes/block = 4096 bytes.
+			no_of_sectors = 40;
+			break;
+			
+		default: // Should not happen. Ignore.
+			break;
+	}
+	
+	// Dump sectors, highest address first.
+	if (no_of_sectors) {
+		Serial.println(F("Sector Block   0  1  2  3   4  5  6  7   8  9 10 11  12 13 14 15  AccessBits"));
+		for (int8_t i = no_of_sectors - 1; i >= 0; i--) {
+			PICC_DumpMifareClassicSectorToSerial(uid, key, i);
+		}
+	}
+	PICC_HaltA(); // Halt the PICC before stopping the encrypted session.
+	PCD_StopCrypto1();
+} // End PICC_DumpMifareClassicToSerial()
+
+/**
+ * Dumps memory contents of a sector of a MIFARE Classic PICC.
+ * Uses PCD_Authenticate(), MIFARE_Read() and PCD_StopCrypto1.
+ * Always uses PICC_CMD_MF_AUTH_KEY_A because only Key A can always read the sector trailer access bits.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PICC_DumpMifareClassicSectorToSerial(Uid *uid,			///< Pointer to Uid struct returned from a successful PICC_Select().
+																	MIFARE_Key *key,	///< Key A for the sector.
+																	byte sector			///< The sector to dump, 0..39.
+																	) {
+	StatusCode status;
+	byte firstBlock;		// Address of lowest address to dump actually last block dumped)
+	byte no_of_blocks;		// Number of blocks in sector
+	bool isSectorTrailer;	// Set to true while handling the "last" (ie highest address) in the sector.
+	
+	// The access bits are stored in a peculiar fashion.
+	// There are four groups:
+	//		g[3]	Access bits for the sector trailer, block 3 (for sectors 0-31) or block 15 (for sectors 32-39)
+	//		g[2]	Access bits for block 2 (for sectors 0-31) or blocks 10-14 (for sectors 32-39)
+	//		g[1]	Access bits for block 1 (for sectors 0-31) or blocks 5-9 (for sectors 32-39)
+	//		g[0]	Access bits for block 0 (for sectors 0-31) or blocks 0-4 (for sectors 32-39)
+	// Each group has access bits [C1 C2 C3]. In this code C1 is MSB and C3 is LSB.
+	// The four CX bits are stored together in a nible cx and an inverted nible cx_.
+	byte c1, c2, c3;		// Nibbles
+	byte c1_, c2_, c3_;		// Inverted nibbles
+	bool invertedError;		// True if one of the inverted nibbles did not match
+	byte g[4];				// Access bits for each of the four groups.
+	byte group;				// 0-3 - active group for access bits
+	bool firstInGroup;		// True for the first block dumped in the group
+	
+	// Determine position and size of sector.
+	if (sector < 32) { // Sectors 0..31 has 4 blocks each
+		no_of_blocks = 4;
+		firstBlock = sector * no_of_blocks;
+	}
+	else if (sector < 40) { // Sectors 32-39 has 16 blocks each
+		no_of_blocks = 16;
+		firstBlock = 128 + (sector - 32) * no_of_blocks;
+	}
+	else { // Illegal input, no MIFARE Classic PICC has more than 40 sectors.
+		return;
+	}
+		
+	// Dump blocks, highest address first.
+	byte byteCount;
+	byte buffer[18];
+	byte blockAddr;
+	isSectorTrailer = true;
+	invertedError = false;	// Avoid "unused variable" warning.
+	for (int8_t blockOffset = no_of_blocks - 1; blockOffset >= 0; blockOffset--) {
+		blockAddr = firstBlock + blockOffset;
+		// Sector number - only on first line
+		if (isSectorTrailer) {
+			if(sector < 10)
+				Serial.print(F("   ")); // Pad with spaces
+			else
+				Serial.print(F("  ")); // Pad with spaces
+			Serial.print(sector);
+			Serial.print(F("   "));
+		}
+		else {
+			Serial.print(F("       "));
+		}
+		// Block number
+		if(blockAddr < 10)
+			Serial.print(F("   ")); // Pad with spaces
+		else {
+			if(blockAddr < 100)
+				Serial.print(F("  ")); // Pad with spaces
+			else
+				Serial.print(F(" ")); // Pad with spaces
+		}
+		Serial.print(blockAddr);
+		Serial.print(F("  "));
+		// Establish encrypted communications before reading the first block
+		if (isSectorTrailer) {
+			status = PCD_Authenticate(PICC_CMD_MF_AUTH_KEY_A, firstBlock, key, uid);
+			if (status != STATUS_OK) {
+				Serial.print(F("PCD_Authenticate() failed: "));
+				Serial.println(GetStatusCodeName(status));
+				return;
+			}
+		}
+		// Read block
+		byteCount = sizeof(buffer);
+		status = MIFARE_Read(blockAddr, buffer, &byteCount);
+		if (status != STATUS_OK) {
+			Serial.print(F("MIFARE_Read() failed: "));
+			Serial.println(GetStatusCodeName(status));
+			continue;
+		}
+		// Dump data
+		for (byte index = 0; index < 16; index++) {
+			if(buffer[index] < 0x10)
+				Serial.print(F(" 0"));
+			else
+				Serial.print(F(" "));
+			Serial.print(buffer[index], HEX);
+			if ((index % 4) == 3) {
+				Serial.print(F(" "));
+			}
+		}
+		// Parse sector trailer data
+		if (isSectorTrailer) {
+			c1  = buffer[7] >> 4;
+			c2  = buffer[8] & 0xF;
+			c3  = buffer[8] >> 4;
+			c1_ = buffer[6] & 0xF;
+			c2_ = buffer[6] >> 4;
+			c3_ = buffer[7] & 0xF;
+			invertedError = (c1 != (~c1_ & 0xF)) || (c2 != (~c2_ & 0xF)) || (c3 != (~c3_ & 0xF));
+			g[0] = ((c1 & 1) << 2) | ((c2 & 1) << 1) | ((c3 & 1) << 0);
+			g[1] = ((c1 & 2) << 1) | ((c2 & 2) << 0) | ((c3 & 2) >> 1);
+			g[2] = ((c1 & 4) << 0) | ((c2 & 4) >> 1) | ((c3 & 4) >> 2);
+			g[3] = ((c1 & 8) >> 1) | ((c2 & 8) >> 2) | ((c3 & 8) >> 3);
+			isSectorTrailer = false;
+		}
+		
+		// Which access group is this block in?
+		if (no_of_blocks == 4) {
+			group = blockOffset;
+			firstInGroup = true;
+		}
+		else {
+			group = blockOffset / 5;
+			firstInGroup = (group == 3) || (group != (blockOffset + 1) / 5);
+		}
+		
+		if (firstInGroup) {
+			// Print access bits
+			Serial.print(F(" [ "));
+			Serial.print((g[group] >> 2) & 1, DEC); Serial.print(F(" "));
+			Serial.print((g[group] >> 1) & 1, DEC); Serial.print(F(" "));
+			Serial.print((g[group] >> 0) & 1, DEC);
+			Serial.print(F(" ] "));
+			if (invertedError) {
+				Serial.print(F(" Inverted access bits did not match! "));
+			}
+		}
+		
+		if (group != 3 && (g[group] == 1 || g[group] == 6)) { // Not a sector trailer, a value block
+			int32_t value = (int32_t(buffer[3])<<24) | (int32_t(buffer[2])<<16) | (int32_t(buffer[1])<<8) | int32_t(buffer[0]);
+			Serial.print(F(" Value=0x")); Serial.print(value, HEX);
+			Serial.print(F(" Adr=0x")); Serial.print(buffer[12], HEX);
+		}
+		Serial.println();
+	}
+	
+	return;
+} // End PICC_DumpMifareClassicSectorToSerial()
+
+/**
+ * Dumps memory contents of a MIFARE Ultralight PICC.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PICC_DumpMifareUltralightToSerial() {
+	StatusCode status;
+	byte byteCount;
+	byte buffer[18];
+	byte i;
+	
+	Serial.println(F("Page  0  1  2  3"));
+	// Try the mpages of the original Ultralight. Ultralight C has more pages.
+	for (byte page = 0; page < 16; page +=4) { // Read returns data for 4 pages at a time.
+		// Read pages
+		byteCount = sizeof(buffer);
+		status = MIFARE_Read(page, buffer, &byteCount);
+		if (status != STATUS_OK) {
+			Serial.print(F("MIFARE_Read() failed: "));
+			Serial.println(GetStatusCodeName(status));
+			break;
+		}
+		// Dump data
+		for (byte offset = 0; offset < 4; offset++) {
+			i = page + offset;
+			if(i < 10)
+				Serial.print(F("  ")); // Pad with spaces
+			else
+				Serial.print(F(" ")); // Pad with spaces
+			Serial.print(i);
+			Serial.print(F("  "));
+			for (byte index = 0; index < 4; index++) {
+				i = 4 * offset + index;
+				if(buffer[i] < 0x10)
+					Serial.print(F(" 0"));
+				else
+					Serial.print(F(" "));
+				Serial.print(buffer[i], HEX);
+			}
+			Serial.println();
+		}
+	}
+} // End PICC_DumpMifareUltralightToSerial()
+
+/**
+ * Calculates the bit pattern needed for the specified access bits. In the [C1 C2 C3] tuples C1 is MSB (=4) and C3 is LSB (=1).
+ */
+template <class Transport>
+void MFRC522Base<Transport>::MIFARE_SetAccessBits(	byte *accessBitBuffer,	///< Pointer to byte 6, 7 and 8 in the sector trailer. Bytes [0..2] will be set.
+													byte g0,				///< Access bits [C1 C2 C3] for block 0 (for sectors 0-31) or blocks 0-4 (for sectors 32-39)
+													byte g1,				///< Access bits C1 C2 C3] for block 1 (for sectors 0-31) or blocks 5-9 (for sectors 32-39)
+													byte g2,				///< Access bits C1 C2 C3] for block 2 (for sectors 0-31) or blocks 10-14 (for sectors 32-39)
+													byte g3					///< Access bits C1 C2 C3] for the sector trailer, block 3 (for sectors 0-31) or block 15 (for sectors 32-39)
+												) {
+	byte c1 = ((g3 & 4) << 1) | ((g2 & 4) << 0) | ((g1 & 4) >> 1) | ((g0 & 4) >> 2);
+	byte c2 = ((g3 & 2) << 2) | ((g2 & 2) << 1) | ((g1 & 2) << 0) | ((g0 & 2) >> 1);
+	byte c3 = ((g3 & 1) << 3) | ((g2 & 1) << 2) | ((g1 & 1) << 1) | ((g0 & 1) << 0);
+	
+	accessBitBuffer[0] = (~c2 & 0xF) << 4 | (~c1 & 0xF);
+	accessBitBuffer[1] =          c1 << 4 | (~c3 & 0xF);
+	accessBitBuffer[2] =          c3 << 4 | c2;
+} // End MIFARE_SetAccessBits()
+
+
+/**
+ * Performs the "magic sequence" needed to get Chinese UID changeable
+ * Mifare cards to allow writing to sector 0, where the card UID is stored.
+ *
+ * Note that you do not need to have selected the card through REQA or WUPA,
+ * this sequence works immediately when the card is in the reader vicinity.
+ * This means you can use this method even on "bricked" cards that your reader does
+ * not recognise anymore (see MFRC522::MIFARE_UnbrickUidSector).
+ * 
+ * Of course with non-bricked devices, you're free to select them before calling this function.
+ */
+template <class Transport>
+bool MFRC522Base<Transport>::MIFARE_OpenUidBackdoor(bool logErrors) {
+	// Magic sequence:
+	// > 50 00 57 CD (HALT + CRC)
+	// > 40 (7 bits only)
+	// < A (4 bits only)
+	// > 43
+	// < A (4 bits only)
+	// Then you can write to sector 0 without authenticating
+	
+	PICC_HaltA(); // 50 00 57 CD
+	PCD_SetFrameCRC(false, false); // The magic commands are sent bare
+	PCD_SetRequestTimer(false); // The block write of the magic card takes longer than the request window
+	
+	byte cmd = 0x40;
+	byte validBits = 7; /* Our command is only 7 bits. After receiving card response,
+						  this will contain amount of valid response bits. */
+	byte response[32]; // Card's response is written here
+	byte received = sizeof(response);
+	StatusCode status = PCD_TransceiveData(&cmd, (byte)1, response, &received, &validBits, (byte)0, false); // 40
+	if(status != STATUS_OK) {
+		if(logErrors) {
+			Serial.println(F("Card did not respond to 0x40 after HALT command. Are you sure it is a UID changeable one?"));
+			Serial.print(F("Error name: "));
+			Serial.println(GetStatusCodeName(status));
+		}
+		return false;
+	}
+	if (received != 1 || response[0] != 0x0A) {
+		if (logErrors) {
+			Serial.print(F("Got bad response on backdoor 0x40 command: "));
+			Serial.print(response[0], HEX);
+			Serial.print(F(" ("));
+			Serial.print(validBits);
+			Serial.print(F(" valid bits)\r\n"));
+		}
+		return false;
+	}
+	
+	cmd = 0x43;
+	validBits = 8;
+	status = PCD_TransceiveData(&cmd, (byte)1, response, &received, &validBits, (byte)0, false); // 43
+	if(status != STATUS_OK) {
+		if(logErrors) {
+			Serial.println(F("Error in communication at command 0x43, after successfully executing 0x40"));
+			Serial.print(F("Error name: "));
+			Serial.println(GetStatusCodeName(status));
+		}
+		return false;
+	}
+	if (received != 1 || response[0] != 0x0A) {
+		if (logErrors) {
+			Serial.print(F("Got bad response on backdoor 0x43 command: "));
+			Serial.print(response[0], HEX);
+			Serial.print(F(" ("));
+			Serial.print(validBits);
+			Serial.print(F(" valid bits)\r\n"));
+		}
+		return false;
+	}
+	
+	// You can now write to sector 0 without authenticating!
+	return true;
+} // End MIFARE_OpenUidBackdoor()
+
+/**
+ * Reads entire block 0, including all manufacturer data, and overwrites
+ * that block with the new UID, a freshly calculated BCC, and the original
+ * manufacturer data.
+ *
+ * It assumes a default KEY A of 0xFFFFFFFFFFFF.
+ * Make sure to have selected the card before this function is called.
+ */
+template <class Transport>
+bool MFRC522Base<Transport>::MIFARE_SetUid(byte *newUid, byte uidSize, bool logErrors) {
+	
+	// UID + BCC byte can not be larger than 16 together
+	if (!newUid || !uidSize || uidSize > 15) {
+		if (logErrors) {
+			Serial.println(F("New UID buffer empty, size 0, or size > 15 given"));
+		}
+		return false;
+	}
+	
+	// Authenticate for reading
+	MIFARE_Key key = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+	StatusCode status = PCD_Authenticate(PICC_CMD_MF_AUTH_KEY_A, (byte)1, &key, &uid);
+	if (status != STATUS_OK) {
+		
+		if (status == STATUS_TIMEOUT) {
+			// We get a read timeout if no card is selected yet, so let's select one
+			
+			// Wake the card up again if sleeping
+//			  byte atqa_answer[2];
+//			  byte atqa_size = 2;
+//			  PICC_WakeupA(atqa_answer, &atqa_size);
+			
+			if (!PICC_IsNewCardPresent() || !PICC_ReadCardSerial()) {
+				Serial.println(F("No card was previously selected, and none are available. Failed to set UID."));
+				return false;
+			}
+			
+			status = PCD_Authenticate(PICC_CMD_MF_AUTH_KEY_A, (byte)1, &key, &uid);
+			if (status != STATUS_OK) {
+				// We tried, time to give up
+				if (logErrors) {
+					Serial.println(F("Failed to authenticate to card for reading, could not set UID: "));
+					Serial.println(GetStatusCodeName(status));
+				}
+				return false;
+			}
+		}
+		else {
+			if (logErrors) {
+				Serial.print(F("PCD_Authenticate() failed: "));
+				Serial.println(GetStatusCodeName(status));
+			}
+			return false;
+		}
+	}
+	
+	// Read block 0
+	byte block0_buffer[18];
+	byte byteCount = sizeof(block0_buffer);
+	status = MIFARE_Read((byte)0, block0_buffer, &byteCount);
+	if (status != STATUS_OK) {
+		if (logErrors) {
+			Serial.print(F("MIFARE_Read() failed: "));
+			Serial.println(GetStatusCodeName(status));
+			Serial.println(F("Are you sure your KEY A for sector 0 is 0xFFFFFFFFFFFF?"));
+		}
+		return false;
+	}
+	
+	// Write new UID to the data we just read, and calculate BCC byte
+	byte bcc = 0;
+	for (uint8_t i = 0; i < uidSize; i++) {
+		block0_buffer[i] = newUid[i];
+		bcc ^= newUid[i];
+	}
+	
+	// Write BCC byte to buffer
+	block0_buffer[uidSize] = bcc;
+	
+	// Stop encrypted traffic so we can send raw bytes
+	PCD_StopCrypto1();
+	
+	// Activate UID backdoor
+	if (!MIFARE_OpenUidBackdoor(logErrors)) {
+		if (logErrors) {
+			Serial.println(F("Activating the UID backdoor failed."));
+		}
+		return false;
+	}
+	
+	// Write modified block 0 back to card
+	status = MIFARE_Write((byte)0, block0_buffer, (byte)16);
+	if (status != STATUS_OK) {
+		if (logErrors) {
+			Serial.print(F("MIFARE_Write() failed: "));
+			Serial.println(GetStatusCodeName(status));
+		}
+		return false;
+	}
+	
+	// Wake the card up again
+	byte atqa_answer[2];
+	byte atqa_size = 2;
+	PICC_WakeupA(atqa_answer, &atqa_size);
+	
+	return true;
+}
+
+/**
+ * Resets entire sector 0 to zeroes, so the card can be read again by readers.
+ */
+template <class Transport>
+bool MFRC522Base<Transport>::MIFARE_UnbrickUidSector(bool logErrors) {
+	MIFARE_OpenUidBackdoor(logErrors);
+	
+	byte block0_buffer[] = {0x01, 0x02, 0x03, 0x04, 0x04, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};	
+	
+	// Write modified block 0 back to card
+	StatusCode status = MIFARE_Write((byte)0, block0_buffer, (byte)16);
+	if (status != STATUS_OK) {
+		if (logErrors) {
+			Serial.print(F("MIFARE_Write() failed: "));
+			Serial.println(GetStatusCodeName(status));
+		}
+		return false;
+	}
+	return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Convenience functions - does not add extra functionality
+/////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Returns true if a PICC responds to PICC_CMD_REQA.
+ * Only "new" cards in state IDLE are invited. Sleeping cards in state HALT are ignored.
+ * 
+ * @return bool
+ */
+template <class Transport>
+bool MFRC522Base<Transport>::PICC_IsNewCardPresent() {
+	byte bufferATQA[2];
+	byte bufferSize = sizeof(bufferATQA);
+
+	// Reset baud rates and ModWidthReg
+	PCD_WriteRegisters_P(resetBaudRatesScript, sizeof(resetBaudRatesScript) / sizeof(resetBaudRatesScript[0]));
+
+	StatusCode result = PICC_RequestA(bufferATQA, &bufferSize);
+	return (result == STATUS_OK || result == STATUS_COLLISION);
+} // End PICC_IsNewCardPresent()
+
+/**
+ * Simple wrapper around PICC_Select.
+ * Returns true if a UID could be read.
+ * Remember to call PICC_IsNewCardPresent(), PICC_RequestA() or PICC_WakeupA() first.
+ * The read UID is available in the class variable uid.
+ * 
+ * @return bool
+ */
+template <class Transport>
+bool MFRC522Base<Transport>::PICC_ReadCardSerial() {
+	StatusCode result = PICC_Select(&uid);
+	return (result == STATUS_OK);
+} // End 
+
+/**
+ * Reads the UIDs of all PICCs in the field in one sweep.
+ * Each round a REQA is answered by every card in state IDLE, PICC_Select() follows the anticollision tree bit by
+ * bit to one of them and PICC_HaltA() puts it to sleep, so the next round finds the others. The sweep ends when
+ * no card answers any more or uids is full.
+ * 
+ * Cards halted before, for example after a read, are not found: WUPA would wake the cards halted here as well.
+ * The cards found are left in state HALT.
+ * 
+ * @return The number of UIDs stored in uids.
+ */
+template <class Transport>
+byte MFRC522Base<Transport>::PICC_Inventory(	Uid *uids,		///< Out: the UIDs found, with SAK.
+												byte maxCount	///< The number of Uid structs in uids.
+											) {
+	const byte maxFailures = 3;	// Rounds in a row without a new card before giving up
+	byte count = 0;
+	byte failures = 0;
+	
+	// Reset baud rates and ModWidthReg
+	PCD_WriteRegisters_P(resetBaudRatesScript, sizeof(resetBaudRatesScript) / sizeof(resetBaudRatesScript[0]));
+	
+	while (count < maxCount && failures < maxFailures) {
+		byte bufferATQA[2];
+		byte bufferSize = sizeof(bufferATQA);
+		StatusCode result = PICC_RequestA(bufferATQA, &bufferSize);
+		if (result == STATUS_TIMEOUT) {
+			break;						// No card left in state IDLE
+		}
+		if (result != STATUS_OK && result != STATUS_COLLISION) {	// Different ATQAs collide
+			failures++;
+			continue;
+		}
+		Uid *found = &uids[count];
+		if (PICC_Select(found) != STATUS_OK) {
+			failures++;
+			continue;
+		}
+		PICC_HaltA();
+		// A card that missed its HLTA answers again
+		bool known = false;
+		for (byte index = 0; index < count && !known; index++) {
+			known = uids[index].size == found->size && memcmp(uids[index].uidByte, found->uidByte, found->size) == 0;
+		}
+		if (known) {
+			failures++;
+			continue;
+		}
+		count++;
+		failures = 0;
+	}
+	return count;
+} // End PICC_Inventory()
+
+/**
+ * Checks if a PICC read before is still in the field, without reading it again: WUPA wakes it from state HALT, a
+ * SELECT with the whole UID gets its SAK and PICC_HaltA() puts it back to sleep. Other PICCs woken by the WUPA
+ * return to state IDLE or HALT.
+ * 
+ * @return true if the PICC answered.
+ */
+template <class Transport>
+bool MFRC522Base<Transport>::PICC_IsCardPresent(	const Uid *uid	///< The UID of the PICC, as read by PICC_Select().
+												) {
+	byte bufferATQA[2];
+	byte bufferSize = sizeof(bufferATQA);
+	Uid known = *uid;
+	
+	// Reset baud rates and ModWidthReg
+	PCD_WriteRegisters_P(resetBaudRatesScript, sizeof(resetBaudRatesScript) / sizeof(resetBaudRatesScript[0]));
+	
+	StatusCode result = PICC_WakeupA(bufferATQA, &bufferSize);
+	if (result != STATUS_OK && result != STATUS_COLLISION) {	// A new PICC in state IDLE may answer as well
+		return false;
+	}
+	if (PICC_Select(&known, known.size * 8) != STATUS_OK) {
+		return false;
+	}
+	PICC_HaltA();
+	return true;
+} // End PICC_IsCardPresent()
+
+/**
+ * PICC_PollNewCardPresent() and PICC_ReadCardSerial() for a reader that sees each PICC once: a PICC read is halted
+ * at once and is not read again while it stays in the field. Instead PICC_IsCardPresent() checks for it every
+ * PICC_SetPresenceInterval(), EVENT_CARD_REMOVED reports when it is gone. Between the checks the calls poll for
+ * new PICCs, so a PICC held on the reader costs one short check now and then instead of a SELECT per call.
+ * 
+ * Only the last PICC read is followed: a PICC halted before it stays asleep, but its removal is not reported.
+ * With PICC_SetIdlePolling() the REQAs are spaced out while no PICC has answered for a while.
+ * Call it from loop() like PICC_PollNewCardPresent().
+ * 
+ * @return EVENT_NEW_CARD with the UID in uid, EVENT_CARD_REMOVED with the UID of the PICC gone in uid, EVENT_NONE otherwise.
+ */
+template <class Transport>
+MFRC522Constants::PICC_Event MFRC522Base<Transport>::PICC_PollCardEvent() {
+	const byte missLimit = 2;			// Checks in a row without an answer before the PICC counts as removed
+	const uint16_t activeMillis = 1000;	// Polls at full speed this long after a PICC answered
+	
+	uint32_t now = millis();
+	if (_tracking && !_pending.active && (uint32_t)(now - _presenceCheckMillis) >= _presenceIntervalMillis) {
+		_presenceCheckMillis = now;
+		if (PICC_IsCardPresent(&_trackedUid)) {
+			_presenceMisses = 0;
+			_lastAnswerMillis = now;
+			_idlePauseMillis = 0;
+		}
+		else if (++_presenceMisses >= missLimit) {
+			_tracking = false;
+			uid = _trackedUid;
+			return EVENT_CARD_REMOVED;
+		}
+		return EVENT_NONE;
+	}
+	
+	if (!_pending.active) {
+		if ((uint32_t)(now - _lastRequestMillis) < _idlePauseMillis) {
+			return EVENT_NONE;
+		}
+		_lastRequestMillis = now;
+	}
+	StatusCode result = PICC_PollNewCardPresent();
+	if (result == STATUS_PENDING) {
+		return EVENT_NONE;
+	}
+	if (result == STATUS_TIMEOUT) {
+		// Nobody there: double the pause up to the limit of PICC_SetIdlePolling()
+		if (_idlePauseMaxMillis && (uint32_t)(now - _lastAnswerMillis) >= activeMillis) {
+			if (_idlePauseMillis >= _idlePauseMaxMillis / 2) {		// Also keeps the doubling inside 16 bits
+				_idlePauseMillis = _idlePauseMaxMillis;
+			} else {
+				_idlePauseMillis = _idlePauseMillis ? _idlePauseMillis * 2 : 1;
+			}
+		}
+		return EVENT_NONE;
+	}
+	_lastAnswerMillis = now;
+	_idlePauseMillis = 0;
+	if (result != STATUS_OK || !PICC_ReadCardSerial()) {
+		return EVENT_NONE;
+	}
+	PICC_HaltA();
+	// The PICC followed answers a REQA again if it lost power for a moment or missed the HLTA
+	bool same = _tracking && uid.size == _trackedUid.size && memcmp(uid.uidByte, _trackedUid.uidByte, uid.size) == 0;
+	_trackedUid = uid;
+	_tracking = true;
+	_presenceMisses = 0;
+	_presenceCheckMillis = millis();
+	return same ? EVENT_NONE : EVENT_NEW_CARD;
+} // End PICC_PollCardEvent()
+
+/**
+ * Sets how often PICC_PollCardEvent() checks if the PICC it follows is still in the field. 250ms by default.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PICC_SetPresenceInterval(	uint16_t intervalMillis	///< Milliseconds between two checks.
+														) {
+	_presenceIntervalMillis = intervalMillis;
+} // End PICC_SetPresenceInterval()
+
+/**
+ * Lets PICC_PollCardEvent() poll less while the field is empty: once no PICC has answered for a second, the pause
+ * between two REQAs starts at 1ms and doubles with every REQA without an answer, up to maxPauseMillis. The first
+ * answer brings it back to full speed. A new PICC is found up to maxPauseMillis later. 0, the default, polls at full
+ * speed all the time.
+ */
+template <class Transport>
+void MFRC522Base<Transport>::PICC_SetIdlePolling(	uint16_t maxPauseMillis	///< The longest pause between two REQAs in milliseconds.
+												) {
+	_idlePauseMaxMillis = maxPauseMillis;
+	if (_idlePauseMillis > maxPauseMillis) {
+		_idlePauseMillis = maxPauseMillis;
+	}
+} // End PICC_SetIdlePolling()
+
+#endif
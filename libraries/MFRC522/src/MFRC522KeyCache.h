@@ -0,0 +1,164 @@
+/**
+ * Which of a list of MIFARE Classic keys opened a sector of a card, remembered for the next time:
+ *
+ * 		#include <EEPROM.h>
+ * 		#include <MFRC522KeyCache.h>
+ *
+ * 		MFRC522::MIFARE_Key siteKeys[] = {...};
+ * 		MFRC522KeyCache keyCache;
+ *
+ * 		keyCache.load(EEPROM, 0);				// In setup(), the hints of the last run
+ * 		mfrc522.PCD_SetKeyCache(&keyCache);
+ * 		...
+ * 		mfrc522.PCD_AuthenticateWithKeys(MFRC522::PICC_CMD_MF_AUTH_KEY_A, block, siteKeys, 4, &mfrc522.uid);
+ * 		keyCache.save(EEPROM, 0);				// Only writes the bytes that changed
+ *
+ * An entry is the 4 UID bytes PCD_Authenticate() sends, the sector with the key type and the index of the key in the
+ * list: 6 bytes. The cache holds the MFRC522_KEY_CACHE_SIZE entries used last, a new one replaces the one unused for
+ * longest. Entries keep their place in the storage, the order of use is only kept in RAM: save() after a known card
+ * writes nothing, after a new one the 6 bytes of its entry and the count.
+ * load() and save() take any storage with read(address) and write(address, value), like EEPROM. On the ESP cores
+ * call EEPROM.begin() before and EEPROM.commit() after.
+ */
+#ifndef MFRC522KeyCache_h
+#define MFRC522KeyCache_h
+
+#include <Arduino.h>
+#include "MFRC522.h"
+
+// Number of entries, 7 bytes of RAM each.
+#ifndef MFRC522_KEY_CACHE_SIZE
+#define MFRC522_KEY_CACHE_SIZE 16
+#endif
+
+class MFRC522KeyCache {
+public:
+	static constexpr byte NO_HINT = 0xFF;
+	static constexpr int STORAGE_SIZE = 2 + MFRC522_KEY_CACHE_SIZE * 6;	// Bytes taken by save()
+
+	MFRC522KeyCache() : _count(0), _changed(false) {}
+
+	/**
+	 * The index of the key that opened the sector last time, NO_HINT if none is known or the UID is shorter than 4 bytes.
+	 * The entry found becomes the newest.
+	 */
+	byte find(const MFRC522Constants::Uid *uid, byte slot) {
+		if (uid->size < 4) {
+			return NO_HINT;
+		}
+		const byte *uidTail = uid->uidByte + uid->size - 4;
+		for (byte rank = 0; rank < _count; rank++) {
+			const Entry &entry = _entries[_order[rank]];
+			if (entry.slot == slot && memcmp(entry.uid, uidTail, 4) == 0) {
+				use(rank);
+				return entry.key;
+			}
+		}
+		return NO_HINT;
+	}
+
+	/**
+	 * Notes that key opened the sector, as the newest entry. A UID shorter than 4 bytes is not remembered.
+	 */
+	void remember(const MFRC522Constants::Uid *uid, byte slot, byte key) {
+		if (uid->size < 4) {
+			return;
+		}
+		if (find(uid, slot) != NO_HINT) {		// Now the newest
+			Entry &entry = _entries[_order[0]];
+			_changed |= entry.key != key;
+			entry.key = key;
+			return;
+		}
+		if (_count < MFRC522_KEY_CACHE_SIZE) {
+			_order[_count] = _count;			// A free place
+			_count++;
+		}
+		use(_count - 1);						// The free place or the entry unused for longest
+		Entry &entry = _entries[_order[0]];
+		memcpy(entry.uid, uid->uidByte + uid->size - 4, 4);
+		entry.slot = slot;
+		entry.key = key;
+		_changed = true;
+	}
+
+	void clear() {
+		_changed |= _count > 0;
+		_count = 0;
+	}
+
+	byte count() const { return _count; }
+	bool changed() const { return _changed; }	// Entries differ from the last load() or save()
+
+	/**
+	 * Reads the entries stored by save(). An empty or foreign storage leaves the cache empty.
+	 *
+	 * @return true if entries were found.
+	 */
+	template <class Storage>
+	bool load(Storage &storage, int address) {
+		_count = 0;
+		_changed = false;
+		byte count = storage.read(address + 1);
+		if (storage.read(address) != MAGIC || count > MFRC522_KEY_CACHE_SIZE) {
+			return false;
+		}
+		byte *bytes = (byte *)_entries;
+		for (int index = 0; index < count * (int)sizeof(Entry); index++) {
+			bytes[index] = storage.read(address + 2 + index);
+		}
+		for (byte index = 0; index < count; index++) {
+			_order[index] = index;
+		}
+		_count = count;
+		return true;
+	}
+
+	/**
+	 * Stores the entries at address, STORAGE_SIZE bytes at most. Bytes that hold their value already are not
+	 * written again, an unchanged cache costs nothing.
+	 */
+	template <class Storage>
+	void save(Storage &storage, int address) {
+		if (!_changed && storage.read(address) == MAGIC) {
+			return;
+		}
+		update(storage, address, MAGIC);
+		update(storage, address + 1, _count);
+		const byte *bytes = (const byte *)_entries;
+		for (int index = 0; index < _count * (int)sizeof(Entry); index++) {
+			update(storage, address + 2 + index, bytes[index]);
+		}
+		_changed = false;
+	}
+
+private:
+	static constexpr byte MAGIC = 0xC5;		// Marks the storage as written by save()
+
+	struct Entry {
+		byte uid[4];		// The UID bytes PCD_Authenticate() sends
+		byte slot;			// The sector, bit 7 set for key B
+		byte key;			// Index in the key list of PCD_AuthenticateWithKeys()
+	};
+
+	// Makes the entry at rank the newest
+	void use(byte rank) {
+		byte place = _order[rank];
+		memmove(&_order[1], &_order[0], rank);
+		_order[0] = place;
+	}
+
+	template <class Storage>
+	static void update(Storage &storage, int address, byte value) {
+		if (storage.read(address) != value) {
+			storage.write(address, value);
+		}
+	}
+
+	Entry _entries[MFRC522_KEY_CACHE_SIZE];		// In their place in the storage
+	byte _order[MFRC522_KEY_CACHE_SIZE];		// Places in _entries, the newest first
+	byte _count;
+	bool _changed;
+};
+
+#endif
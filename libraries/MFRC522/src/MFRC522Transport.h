@@ -0,0 +1,158 @@
+/**
+ * Transports of the MFRC522 library: how MFRC522Base<Transport> reaches the registers of the chip.
+ *
+ * The transport is a template parameter, so its functions are inlined into the register access of the
+ * library and there is no virtual call on the way to the bus. A transport is a class with these members:
+ *
+ * 		void begin();										// Sets up its pins, called by PCD_Init()
+ * 		void beginTransaction();							// Acquires the bus for one or more register accesses
+ * 		void endTransaction();
+ * 		void writeRegister(byte reg, byte value);
+ * 		void writeRegister(byte reg, byte count, const byte *values);	// All bytes go to the same register
+ * 		byte readRegister(byte reg);
+ * 		void readRegister(byte reg, byte count, byte *values);			// All bytes come from the same register
+ *
+ * reg is one of the MFRC522Constants::PCD_Register enums: the register address shifted one bit left, as in the
+ * SPI address byte. The register accesses are only made between beginTransaction() and endTransaction().
+ *
+ * This file has the SPI transports, MFRC522I2CTransport.h and MFRC522UartTransport.h the others.
+ */
+#ifndef MFRC522Transport_h
+#define MFRC522Transport_h
+
+#include <Arduino.h>
+#include <SPI.h>
+
+#ifndef MFRC522_SPICLOCK
+#define MFRC522_SPICLOCK (4000000u)	// MFRC522 accept upto 10MHz, set to 4MHz.
+#endif
+
+// Drive the chip select pin through its port register instead of digitalWrite(), which on AVR takes
+// about as long as the SPI transfer of a register value. The port update is a read-modify-write with
+// interrupts off, like that of digitalWrite(), so an interrupt routine writing other pins of the same
+// port loses nothing.
+// MFRC522 uses MFRC522FastSpiTransport with this set, MFRC522SpiTransport without.
+#ifndef MFRC522_FAST_CS
+#if defined(ARDUINO_ARCH_AVR) || defined(ARDUINO_ARCH_HOST)
+#define MFRC522_FAST_CS 1
+#else
+#define MFRC522_FAST_CS 0
+#endif
+#endif
+
+/**
+ * Chip select through digitalWrite(), works on every board.
+ */
+class MFRC522DigitalChipSelect {
+public:
+	explicit MFRC522DigitalChipSelect(byte chipSelectPin) : _chipSelectPin(chipSelectPin) {}
+	void setPin(byte chipSelectPin) { _chipSelectPin = chipSelectPin; }
+	void begin() {
+		pinMode(_chipSelectPin, OUTPUT);
+		digitalWrite(_chipSelectPin, HIGH);
+	}
+	void select(bool selected) { digitalWrite(_chipSelectPin, selected ? LOW : HIGH); }
+
+protected:
+	byte _chipSelectPin;		// Arduino pin connected to MFRC522's SPI slave select input (Pin 24, NSS, active low)
+};
+
+#if MFRC522_FAST_CS
+/**
+ * Chip select directly through the output register of the pin's port.
+ */
+class MFRC522PortChipSelect : public MFRC522DigitalChipSelect {
+public:
+	explicit MFRC522PortChipSelect(byte chipSelectPin) : MFRC522DigitalChipSelect(chipSelectPin) {
+		setPin(chipSelectPin);
+	}
+	void setPin(byte chipSelectPin) {
+		_chipSelectPin = chipSelectPin;
+		_chipSelectPort = portOutputRegister(digitalPinToPort(chipSelectPin));
+		_chipSelectMask = digitalPinToBitMask(chipSelectPin);
+	}
+	void select(bool selected) {
+#if defined(ARDUINO_ARCH_AVR) || defined(ARDUINO_ARCH_HOST)
+		uint8_t oldSREG = SREG;		// An interrupt between the read and the write of the port would lose its pins
+		cli();
+#else
+		noInterrupts();
+#endif
+		if (selected) {
+			*_chipSelectPort &= ~_chipSelectMask;
+		} else {
+			*_chipSelectPort |= _chipSelectMask;
+		}
+#if defined(ARDUINO_ARCH_AVR) || defined(ARDUINO_ARCH_HOST)
+		SREG = oldSREG;
+#else
+		interrupts();
+#endif
+	}
+
+protected:
+	decltype(portOutputRegister(0)) _chipSelectPort;	// Output register of the port with _chipSelectPin
+	byte _chipSelectMask;
+};
+#endif
+
+/**
+ * The SPI interface of the datasheet, section 8.1.2. Each register access is a frame of its own:
+ * all bytes after the address byte go to the same register.
+ */
+template <class ChipSelect>
+class MFRC522SpiTransportBase {
+public:
+	MFRC522SpiTransportBase(byte chipSelectPin = SS) : _chipSelect(chipSelectPin) {}	// SS is defined in pins_arduino.h
+	void setChipSelectPin(byte chipSelectPin) { _chipSelect.setPin(chipSelectPin); }
+
+	void begin() { _chipSelect.begin(); }
+	void beginTransaction() { SPI.beginTransaction(SPISettings(MFRC522_SPICLOCK, MSBFIRST, SPI_MODE0)); }
+	void endTransaction() { SPI.endTransaction(); }
+
+	void writeRegister(byte reg, byte value) {
+		_chipSelect.select(true);
+		SPI.transfer(reg);			// MSB == 0 is for writing. LSB is not used in address. Datasheet section 8.1.2.3.
+		SPI.transfer(value);
+		_chipSelect.select(false);
+	}
+
+	void writeRegister(byte reg, byte count, const byte *values) {
+		_chipSelect.select(true);
+		SPI.transfer(reg);
+		for (byte index = 0; index < count; index++) {
+			SPI.transfer(values[index]);
+		}
+		_chipSelect.select(false);
+	}
+
+	byte readRegister(byte reg) {
+		_chipSelect.select(true);
+		SPI.transfer(0x80 | reg);			// MSB == 1 is for reading. LSB is not used in address. Datasheet section 8.1.2.3.
+		byte value = SPI.transfer(0);		// Read the value back. Send 0 to stop reading.
+		_chipSelect.select(false);
+		return value;
+	}
+
+	void readRegister(byte reg, byte count, byte *values) {
+		byte address = 0x80 | reg;
+		byte last = count - 1;				// One read is performed outside of the loop
+		_chipSelect.select(true);
+		SPI.transfer(address);				// Tell MFRC522 which address we want to read
+		for (byte index = 0; index < last; index++) {
+			values[index] = SPI.transfer(address);	// Read value and tell that we want to read the same address again.
+		}
+		values[last] = SPI.transfer(0);		// Read the final byte. Send 0 to stop reading.
+		_chipSelect.select(false);
+	}
+
+protected:
+	ChipSelect _chipSelect;
+};
+
+typedef MFRC522SpiTransportBase<MFRC522DigitalChipSelect> MFRC522SpiTransport;
+#if MFRC522_FAST_CS
+typedef MFRC522SpiTransportBase<MFRC522PortChipSelect> MFRC522FastSpiTransport;
+#endif
+
+#endif
@@ -0,0 +1,77 @@
+/**
+ * The MFRC522 on a serial port, datasheet section 8.1.4:
+ *
+ * 		#include <MFRC522UartTransport.h>
+ *
+ * 		MFRC522_UART mfrc522(MFRC522UartTransport(Serial1), RST_PIN);
+ *
+ * 		Serial1.begin(9600);		// The rate after reset, see SerialSpeedReg
+ * 		mfrc522.PCD_Init();
+ *
+ * Each register access is an address byte, bit 7 set for reading, followed by the value: the MFRC522 answers a
+ * read with the value and a write with the address byte. Including this file compiles the functions of
+ * MFRC522Base for the transport in the sketch, MFRC522.cpp only has them for SPI.
+ */
+#ifndef MFRC522UartTransport_h
+#define MFRC522UartTransport_h
+
+#include <Arduino.h>
+#include "MFRC522Impl.h"
+
+// Longest wait for a byte from the MFRC522, one byte takes about 1ms at 9600 Bd.
+#ifndef MFRC522_UART_TIMEOUT_MICROS
+#define MFRC522_UART_TIMEOUT_MICROS 5000
+#endif
+
+class MFRC522UartTransport {
+public:
+	explicit MFRC522UartTransport(Stream &serial) : _serial(&serial) {}
+
+	void begin() {}
+	void beginTransaction() {
+		while (_serial->available() > 0) {		// Drop what a timed out access left behind
+			_serial->read();
+		}
+	}
+	void endTransaction() {}
+
+	void writeRegister(byte reg, byte value) {
+		_serial->write((byte)(reg >> 1));		// MSB == 0 is for writing, the address unshifted
+		_serial->write(value);
+		receive();								// The address byte, sent back as acknowledge
+	}
+
+	void writeRegister(byte reg, byte count, const byte *values) {
+		for (byte index = 0; index < count; index++) {
+			writeRegister(reg, values[index]);
+		}
+	}
+
+	byte readRegister(byte reg) {
+		_serial->write((byte)(0x80 | (reg >> 1)));	// MSB == 1 is for reading
+		return receive();
+	}
+
+	void readRegister(byte reg, byte count, byte *values) {
+		for (byte index = 0; index < count; index++) {
+			values[index] = readRegister(reg);
+		}
+	}
+
+private:
+	byte receive() {
+		const uint32_t start = micros();
+		while (_serial->available() <= 0) {
+			if ((uint32_t)(micros() - start) > MFRC522_UART_TIMEOUT_MICROS) {
+				return 0;
+			}
+		}
+		return (byte)_serial->read();
+	}
+
+	Stream *_serial;
+};
+
+typedef MFRC522Base<MFRC522UartTransport> MFRC522_UART;
+
+#endif
@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+"""Turns the binary attendance records of the sketch back into the rows of the sheet.
+
+The sketch sends binary records when it is built with RECORD_FORMAT set to RECORD_FORMAT_BINARY
+(see Main/RecordFrame.h for the frame layout). This tool reads them from a serial port, a capture
+file or stdin and writes CSV with the columns PLX-DAQ would have filled:
+
+    Date,Time,Name,USN,reg,Branch,Mail,Section,contact[,Status,Reader]
+
+The roster CSV must be the one the sketch was built from, the frames only carry the roster index.
+Date and time come from the PC clock. The first frame anchors the reader's millis() timestamps to
+it, so records that were queued on the reader still get the time they were scanned. A timestamp
+that goes back means the reader was reset, its next frame anchors it again. The header row is only
+written to a new or empty output file, so a restarted decoder continues the same sheet.
+
+usage: frame_decode.py --roster students.csv --port /dev/ttyACM0 [--baud 115200] [-o out.csv]
+       frame_decode.py --roster students.csv capture.bin
+"""
+
+import argparse
+import csv
+import datetime
+import os
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from roster_gen import read_roster  # noqa: E402
+
+SOF = 0xA5
+STATUS = {0: "IN", 1: "OUT"}
+
+
+def crc16_ccitt(data):
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021 if crc & 0x8000 else crc << 1) & 0xFFFF
+    return crc
+
+
+class FrameDecoder:
+    """Finds the frames in a byte stream, skipping noise and text lines."""
+
+    def __init__(self):
+        self.buffer = bytearray()
+        self.errors = 0
+
+    def feed(self, data):
+        self.buffer += data
+        frames = []
+        while True:
+            start = self.buffer.find(SOF)
+            if start < 0:
+                self.buffer.clear()
+                break
+            del self.buffer[:start]
+            if len(self.buffer) < 2:
+                break
+            length = self.buffer[1]
+            if length < 13 or length > 19:
+                del self.buffer[0]
+                continue
+            end = 2 + length + 2
+            if len(self.buffer) < end:
+                break
+            frame = bytes(self.buffer[:end])
+            crc = frame[-2] | frame[-1] << 8
+            if crc16_ccitt(frame[1:-2]) != crc or frame[10] != length - 9:
+                # Not a frame after all, resynchronise on the next start byte
+                self.errors += 1
+                del self.buffer[0]
+                continue
+            del self.buffer[:end]
+            frames.append({
+                "index": frame[2] | frame[3] << 8,
+                "status": frame[4],
+                "reader": frame[5],
+                "timestamp": int.from_bytes(frame[6:10], "little"),
+                "uid": frame[11:11 + frame[10]],
+            })
+        return frames
+
+
+def read_chunks(args):
+    if args.port:
+        try:
+            import serial
+        except ImportError:
+            sys.exit("reading from a serial port needs pyserial (pip install pyserial)")
+        with serial.Serial(args.port, args.baud, timeout=0.1) as port:
+            while True:
+                data = port.read(256)
+                if data:
+                    yield data
+    else:
+        source = open(args.input, "rb") if args.input else sys.stdin.buffer
+        with source:
+            while True:
+                data = source.read(256)
+                if not data:
+                    break
+                yield data
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode binary attendance records into sheet rows.")
+    parser.add_argument("input", nargs="?", help="capture file, stdin if neither this nor --port is given")
+    parser.add_argument("--roster", required=True, help="roster CSV the sketch was built from")
+    parser.add_argument("--port", help="serial port of the reader")
+    parser.add_argument("--baud", type=int, default=115200, help="baud rate, SERIAL_BAUD of the sketch")
+    parser.add_argument("-o", "--output", help="CSV file to append to, stdout if not given")
+    parser.add_argument("--status", action="store_true", help="add the Status and Reader columns")
+    args = parser.parse_args()
+
+    roster = read_roster(args.roster)
+    new_file = not args.output or not os.path.exists(args.output) or os.path.getsize(args.output) == 0
+    out = open(args.output, "a", newline="") if args.output else sys.stdout
+    writer = csv.writer(out, lineterminator="\n")
+    header = ["Date", "Time", "Name", "USN", "reg", "Branch", "Mail", "Section", "contact"]
+    if args.status:
+        header += ["Status", "Reader"]
+    if new_file:
+        writer.writerow(header)
+
+    decoder = FrameDecoder()
+    clocks = {}  # reader -> [PC time of the anchor frame, milliseconds since it, last timestamp]
+    for chunk in read_chunks(args):
+        for frame in decoder.feed(chunk):
+            if frame["index"] >= len(roster):
+                print("reader %d: roster index %d out of range, is the roster up to date?"
+                      % (frame["reader"], frame["index"]), file=sys.stderr)
+                continue
+            uid, fields = roster[frame["index"]]
+            if uid != frame["uid"]:
+                print("reader %d: UID %s does not match roster entry %d, is the roster up to date?"
+                      % (frame["reader"], frame["uid"].hex().upper(), frame["index"]), file=sys.stderr)
+            clock = clocks.get(frame["reader"])
+            step = (frame["timestamp"] - clock[2]) & 0xFFFFFFFF if clock else 0
+            if clock is None or step >= 0x80000000:
+                # First frame of the reader, or it went back in time: the reader was reset
+                clock = clocks[frame["reader"]] = [datetime.datetime.now(), 0, frame["timestamp"]]
+            else:
+                # Forward, across a wrap of millis() as well
+                clock[1] += step
+                clock[2] = frame["timestamp"]
+            scanned = clock[0] + datetime.timedelta(milliseconds=clock[1])
+            row = [scanned.strftime("%d/%m/%Y"), scanned.strftime("%H:%M:%S")] + fields
+            if args.status:
+                row += [STATUS.get(frame["status"], frame["status"]), frame["reader"]]
+            writer.writerow(row)
+            out.flush()
+    if decoder.errors:
+        print("%d corrupted frame(s) skipped" % decoder.errors, file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,184 @@
+#!/usr/bin/env python3
+"""Builds the roster tables of the sketch from a CSV file.
+
+The CSV has a header row and one row per student:
+
+    uid,name,usn,reg,branch,mail,section,contact
+    FA:89:6C:2E,USER_NAME,USER_USN,...
+
+The UID is given in hex (4, 7 or 10 bytes, separators ':', '-' and ' ' are ignored).
+
+Two headers are written next to the sketch:
+
+  roster_data.h    counts, included by Roster.h
+  roster_tables.h  the tables in flash, included by Roster.cpp only
+
+The UIDs are sorted by length and then by value, so the sketch can look them up with a binary
+search. A student's position in this order is its roster index.
+
+The fields are stored as a struct of arrays: each field has a string pool with every distinct text
+of the field once, and an array of pool offsets indexed by roster index. Branches, sections and
+other repeated values cost two bytes per student. The offsets are 16 bit unless the pool of a field
+grows past 64 KB, then all are 32 bit.
+
+The tables must fit the flash of the board. The tool stops with their size if they take more than
+--flash-budget bytes, by default the 32256 bytes an Uno leaves for the sketch, which needs room for
+its code as well. For a board with more flash pass its size, e.g. 253952 for a Mega 2560: there the
+sketch reads the tables with far addresses (ROSTER_FAR in Roster.h), past the first 64 KB as well.
+
+usage: roster_gen.py students.csv [-o ../Main] [--flash-budget BYTES]
+"""
+
+import argparse
+import csv
+import os
+import sys
+
+UID_SIZES = (4, 7, 10)
+FIELDS = ("name", "usn", "reg", "branch", "mail", "section", "contact")
+MAX_RECORDS = 0xFFFE  # 0xFFFF is ROSTER_NOT_FOUND
+SHORT_POOL = 0x10000  # reach of 16 bit offsets
+UNO_FLASH = 32768 - 512  # less the bootloader
+
+
+def parse_uid(text, line):
+    digits = "".join(c for c in text if c not in ":- ")
+    try:
+        uid = bytes.fromhex(digits)
+    except ValueError:
+        sys.exit("line %d: UID '%s' is not hex" % (line, text))
+    if len(uid) not in UID_SIZES:
+        sys.exit("line %d: UID '%s' has %d bytes, must be 4, 7 or 10" % (line, text, len(uid)))
+    return uid
+
+
+def read_roster(path):
+    with open(path, newline="", encoding="utf-8") as f:
+        reader = csv.DictReader(f)
+        missing = [name for name in ("uid",) + FIELDS if name not in (reader.fieldnames or [])]
+        if missing:
+            sys.exit("%s: missing column(s) %s" % (path, ", ".join(missing)))
+        records = []
+        seen = {}
+        for row in reader:
+            line = reader.line_num
+            uid = parse_uid(row["uid"].strip(), line)
+            if uid in seen:
+                sys.exit("line %d: UID %s already used on line %d" % (line, uid.hex().upper(), seen[uid]))
+            seen[uid] = line
+            records.append((uid, [row[name].strip() for name in FIELDS]))
+    if not records:
+        sys.exit("%s: the roster is empty" % path)
+    if len(records) > MAX_RECORDS:
+        sys.exit("%s: %d students, at most %d fit a roster index" % (path, len(records), MAX_RECORDS))
+    records.sort(key=lambda record: (len(record[0]), record[0]))
+    return records
+
+
+def c_string(text):
+    out = []
+    for c in text.encode("utf-8"):
+        if c in (0x22, 0x5C):  # " and backslash
+            out.append("\\" + chr(c))
+        elif 0x20 <= c < 0x7F:
+            out.append(chr(c))
+        else:
+            out.append("\\%03o" % c)
+    return '"' + "".join(out) + '"'
+
+
+def banner(source):
+    return ("// Generated by tools/roster_gen.py from %s, do not edit.\n"
+            "// Run the tool again after changing the roster.\n" % os.path.basename(source))
+
+
+def write_data(path, source, records):
+    counts = {size: sum(1 for uid, _ in records if len(uid) == size) for size in UID_SIZES}
+    with open(path, "w", newline="\n") as f:
+        f.write(banner(source))
+        f.write("#ifndef ROSTER_DATA_H\n#define ROSTER_DATA_H\n\n")
+        f.write("#define ROSTER_COUNT %d\n" % len(records))
+        for size in UID_SIZES:
+            f.write("#define ROSTER_COUNT_%d %d\n" % (size, counts[size]))
+        f.write("\n#endif\n")
+
+
+def build_text(records):
+    """Returns per field the string pool and the offset of each text in it, and the offset columns."""
+    pools = [bytearray() for _ in FIELDS]
+    offsets = [{} for _ in FIELDS]
+    columns = [[] for _ in FIELDS]
+    for _, fields in records:
+        for number, value in enumerate(fields):
+            if value not in offsets[number]:
+                offsets[number][value] = len(pools[number])
+                pools[number] += value.encode("utf-8") + b"\0"
+            columns[number].append(offsets[number][value])
+    return pools, offsets, columns
+
+
+def offset_size(pools):
+    return 2 if all(len(pool) <= SHORT_POOL for pool in pools) else 4
+
+
+def check_flash(records, pools, budget):
+    uids = sum(len(uid) for uid, _ in records)
+    fields = offset_size(pools) * len(FIELDS) * len(records)
+    text = sum(len(pool) for pool in pools)
+    total = uids + fields + text
+    sizes = "%d bytes (UIDs %d, field offsets %d, text %d)" % (total, uids, fields, text)
+    if total > budget:
+        sys.exit("the roster tables take %s, more than the flash budget of %d bytes" % (sizes, budget))
+    return sizes
+
+
+def write_tables(path, source, records, pools, offsets, columns):
+    with open(path, "w", newline="\n") as f:
+        f.write(banner(source))
+        f.write("#ifndef ROSTER_TABLES_H\n#define ROSTER_TABLES_H\n\n")
+
+        f.write("// UIDs of all students, 4 byte UIDs first, then 7 and 10 byte UIDs, each group sorted\n")
+        f.write("const byte rosterUids[] ROSTER_PROGMEM = {\n")
+        for index, (uid, fields) in enumerate(records):
+            f.write("  %s, // %d %s\n" % (", ".join("0x%02X" % b for b in uid), index, fields[0]))
+        f.write("};\n\n")
+
+        for number, name in enumerate(FIELDS):
+            f.write("// Every distinct %s of the roster once, NUL terminated\n" % name)
+            f.write("const char rosterText%s[] ROSTER_PROGMEM =\n" % name.capitalize())
+            for value, offset in offsets[number].items():
+                f.write("  %s \"\\0\" // %d\n" % (c_string(value), offset))
+            f.write(";\n\n")
+
+        size = offset_size(pools)
+        f.write("#define ROSTER_OFFSET_SIZE %d\n\n" % size)
+        f.write("// Offset into the rosterText pool of the field for each field (%s) and student\n"
+                % ", ".join(FIELDS))
+        f.write("const uint%d_t rosterFields[%d][%d] ROSTER_PROGMEM = {\n" % (8 * size, len(FIELDS), len(records)))
+        for number, column in enumerate(columns):
+            f.write("  { // %s\n" % FIELDS[number])
+            for start in range(0, len(column), 16):
+                f.write("    %s,\n" % ", ".join(str(offset) for offset in column[start:start + 16]))
+            f.write("  },\n")
+        f.write("};\n\n#endif\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Build the roster tables of the sketch from a CSV file.")
+    parser.add_argument("csv", help="roster, one student per row")
+    parser.add_argument("-o", "--output", default=os.path.join(os.path.dirname(__file__), "..", "Main"),
+                        help="sketch folder to write roster_data.h and roster_tables.h to")
+    parser.add_argument("--flash-budget", type=int, default=UNO_FLASH, metavar="BYTES",
+                        help="most flash the tables may take (default %d, an Uno)" % UNO_FLASH)
+    args = parser.parse_args()
+
+    records = read_roster(args.csv)
+    pools, offsets, columns = build_text(records)
+    sizes = check_flash(records, pools, args.flash_budget)
+    write_data(os.path.join(args.output, "roster_data.h"), args.csv, records)
+    write_tables(os.path.join(args.output, "roster_tables.h"), args.csv, records, pools, offsets, columns)
+    print("%d students written to %s, %s of flash" % (len(records), os.path.normpath(args.output), sizes))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+"""Writes a roster of made-up students for load tests of the host build.
+
+The roster has the columns roster_gen.py reads. UIDs are random but repeatable for a given seed:
+about 70 % have 4 bytes, 25 % 7 bytes and 5 % 10 bytes, like a mixed set of MIFARE Classic,
+Ultralight/NTAG and ISO 14443-4 cards.
+
+usage: roster_sample.py 500 -o students.csv [--seed 1]
+"""
+
+import argparse
+import csv
+import random
+
+BRANCHES = ("CSE", "ISE", "ECE", "EEE", "MECH", "CIVIL")
+SECTIONS = ("A", "B", "C", "D")
+
+
+def sample_uid(rng):
+    draw = rng.random()
+    size = 4 if draw < 0.70 else 7 if draw < 0.95 else 10
+    uid = bytearray(rng.getrandbits(8) for _ in range(size))
+    if size == 4:
+        # 0x88 is the cascade tag, 0x08 a random ID, neither starts a unique 4 byte UID
+        while uid[0] in (0x08, 0x88):
+            uid[0] = rng.getrandbits(8)
+    else:
+        uid[0] = 0x04  # NXP manufacturer code
+        # The last cascade level must not start with the cascade tag either
+        last = 3 if size == 7 else 6
+        while uid[last] == 0x88:
+            uid[last] = rng.getrandbits(8)
+    return bytes(uid)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Write a roster of made-up students.")
+    parser.add_argument("count", type=int, help="number of students")
+    parser.add_argument("-o", "--output", required=True, help="CSV file to write")
+    parser.add_argument("--seed", type=int, default=1, help="random seed, the same seed gives the same roster")
+    args = parser.parse_args()
+
+    rng = random.Random(args.seed)
+    seen = set()
+    with open(args.output, "w", newline="", encoding="utf-8") as f:
+        writer = csv.writer(f, lineterminator="\n")
+        writer.writerow(("uid", "name", "usn", "reg", "branch", "mail", "section", "contact"))
+        number = 0
+        while number < args.count:
+            uid = sample_uid(rng)
+            if uid in seen:
+                continue
+            seen.add(uid)
+            number += 1
+            branch = BRANCHES[rng.randrange(len(BRANCHES))]
+            writer.writerow((
+                ":".join("%02X" % b for b in uid),
+                "STUDENT %04d" % number,
+                "1XX21%s%03d" % (branch[:2], number % 1000),
+                "R%06d" % number,
+                branch,
+                "student%04d@example.edu" % number,
+                SECTIONS[rng.randrange(len(SECTIONS))],
+                "9%09d" % rng.randrange(10 ** 9),
+            ))
+    print("%d students written to %s" % (args.count, args.output))
+
+
+if __name__ == "__main__":
+    main()